@@ -0,0 +1,1684 @@
+// Zen of Networked Physics
+// Copyright (c) Glenn Fiedler 2004
+// http://www.gaffer.org/articles
+
+// Headless physics benchmark.
+//
+// Runs the simulation without a display or OpenGL context and reports timings
+// as JSON on stdout so that runs can be compared automatically. This is a separate
+// program from NetworkedPhysics.cpp, build it on its own from this directory:
+//
+//     g++ -O2 -DNDEBUG -pthread -o benchmark Benchmark.cpp
+//
+// Add -DSSE, -DDETERMINISTIC or -DFIXED_POINT to benchmark those builds.
+// DETERMINISTIC builds (also build with -ffp-contract=off) and FIXED_POINT
+// builds finish with a determinism check: a fixed input log is played through
+// the scene and the hash of every cube must match the one in this file on every
+// machine and compiler, otherwise the program exits with status 1.
+//
+// usage: benchmark [steps]
+
+#define HEADLESS
+
+#pragma warning( disable : 4127 )  // conditional expression is constant
+#pragma warning( disable : 4100 )  // unreferenced formal parameter
+#pragma warning( disable : 4244 )  // double to float
+#pragma warning( disable : 4996 )  // stupid deprecated warnings
+
+const float timestep = 0.01f;
+
+#include "Mathematics.h"
+#include "Vector.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "Transform.h"
+#include "Fixed.h"
+
+using namespace Mathematics;
+
+#include <vector>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <queue>
+#include <deque>
+#include <list>
+#include <stdio.h>
+#include <stdlib.h>
+
+// high resolution timer in seconds
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+double timer()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+}
+
+#else
+
+#include <time.h>
+#include <sched.h>
+
+double timer()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 0.000000001;
+}
+
+#endif
+
+#include "Plane.h"
+#include "Heightfield.h"
+#include "Broadphase.h"
+#include "Entities.h"
+#include "Islands.h"
+#include "Workers.h"
+#include "RingBuffer.h"
+#include "World.h"
+#include "Cube.h"
+#include "CubeBatch.h"
+#include "Solver.h"
+#include "Scene.h"
+#include "Move.h"
+#include "History.h"
+#include "Client.h"
+#include "Server.h"
+
+/// Scripted input at time t.
+/// Jumps every three seconds and alternates left and forward movement
+/// so the cube keeps tumbling, sliding and landing on the ramp.
+
+Cube::Input script(unsigned int t)
+{
+    Cube::Input input;
+    input.left = (t/500) % 2 == 1;
+    input.right = false;
+    input.forward = (t/700) % 2 == 1;
+    input.back = false;
+    input.jump = t % 300 < 10;
+    return input;
+}
+
+/// Give up the rest of the time slice, for threads waiting on each other with a single processor.
+
+void yield()
+{
+    #ifdef _WIN32
+    Sleep(0);
+    #else
+    sched_yield();
+    #endif
+}
+
+/// Producer thread of the lock free ring buffer benchmark.
+
+struct Producer
+{
+    LockFreeRingBuffer<unsigned int> *buffer;
+    unsigned int count;
+};
+
+/// Add the numbers from zero to count-1 to the buffer, waiting whenever it is full.
+
+void produce(void *data, int)
+{
+    Producer &producer = *(Producer*) data;
+
+    for (unsigned int i=0; i<producer.count; i++)
+    {
+        while (!producer.buffer->add(i))
+            yield();
+    }
+}
+
+/// Record the reference trajectory for measuring integrator drift: the cube position
+/// after each step of RK4 with each step split into ten substeps, which is close
+/// enough to the exact solution to show the error of every integrator at the full step.
+/// @param planes the scene collision planes.
+/// @param steps the number of steps to record.
+/// @param reference receives the position after each step.
+
+void referenceTrajectory(const std::vector<Plane> &planes, unsigned int steps, std::vector<Vector> &reference)
+{
+    const int substeps = 10;
+
+    Cube cube;
+    cube.canSleep = false;
+    cube.integrator = Cube::RK4;
+
+    reference.resize(steps);
+
+    for (unsigned int t=0; t<steps; t++)
+    {
+        for (int i=0; i<substeps; i++)
+            cube.update(script(t), planes, timestep / substeps);
+
+        reference[t] = cube.state().position;
+    }
+}
+
+/// Measure how far a cube type with a given integrator drifts from a reference trajectory.
+/// @returns the largest distance from the reference position after any step, in meters.
+
+template <class CubeType> float drift(CubeBase::Integrator integrator, const std::vector<Plane> &planes, const std::vector<Vector> &reference)
+{
+    CubeType cube;
+    cube.canSleep = false;
+    cube.integrator = integrator;
+
+    float maximum = 0;
+
+    for (unsigned int t=0; t<reference.size(); t++)
+    {
+        cube.update(script(t), planes, timestep);
+        maximum = Mathematics::maximum(maximum, (cube.state().position - reference[t]).length());
+    }
+
+    return maximum;
+}
+
+/// Benchmark a cube type with a given integrator.
+/// @param name the name to report.
+/// @param integrator the integrator to use.
+/// @param planes the scene collision planes.
+/// @param steps the number of steps to run.
+/// @param last true if this is the last entry in the json array.
+/// @param reference if not null, also report the drift from this reference trajectory, see referenceTrajectory.
+
+template <class CubeType> void benchmarkCube(const char name[], CubeBase::Integrator integrator, const std::vector<Plane> &planes, unsigned int steps, bool last, const std::vector<Vector> *reference = 0)
+{
+    CubeType cube;
+    cube.canSleep = false;
+    cube.integrator = integrator;
+
+    double evaluations = 0;
+
+    const double start = timer();
+
+    for (unsigned int t=0; t<steps; t++)
+    {
+        cube.update(script(t), planes, timestep);
+        evaluations += cube.statistics.evaluations;
+    }
+
+    const double seconds = timer() - start;
+
+    printf("    { \"name\": \"%s\", \"ns_per_step\": %.1f, \"evaluations_per_step\": %.2f, \"ns_per_evaluation\": %.1f, \"evaluations_per_second\": %.0f",
+           name, seconds * 1000000000.0 / steps, evaluations / steps, seconds * 1000000000.0 / evaluations, evaluations / seconds);
+
+    if (reference)
+        printf(", \"drift_steps\": %u, \"max_drift_m\": %.6f", (unsigned int) reference->size(), drift<CubeType>(integrator, planes, *reference));
+
+    printf(" }%s\n", last ? "" : ",");
+}
+
+/// Report the build options.
+
+void reportBuild()
+{
+    #ifdef SSE
+    const bool sse = true;
+    #else
+    const bool sse = false;
+    #endif
+
+    #ifdef DETERMINISTIC
+    const bool deterministic = true;
+    #else
+    const bool deterministic = false;
+    #endif
+
+    #ifdef FIXED_POINT
+    const bool fixedPoint = true;
+    #else
+    const bool fixedPoint = false;
+    #endif
+
+    printf("  \"build\": { \"sse\": %s, \"deterministic\": %s, \"fixed_point\": %s },\n",
+           sse ? "true" : "false", deterministic ? "true" : "false", fixedPoint ? "true" : "false");
+}
+
+/// Benchmark the integrators on the player cube.
+///
+/// Integrators. drift is measured over the first second: after that the cube is
+/// bouncing and tumbling on the planes, which is chaotic enough that any difference,
+/// even between RK4 and its own reference, grows to the size of the scene.
+
+void benchmarkIntegrators(const std::vector<Plane> &planes, unsigned int steps)
+{
+    std::vector<Vector> reference;
+    referenceTrajectory(planes, steps<100 ? steps : 100, reference);
+
+    printf("  \"integrators\": [\n");
+    benchmarkCube<Cube>("RK4", Cube::RK4, planes, steps, false, &reference);
+    benchmarkCube<Cube>("SemiImplicitEuler", Cube::SemiImplicitEuler, planes, steps, false, &reference);
+    benchmarkCube<Cube>("VelocityVerlet", Cube::VelocityVerlet, planes, steps, false, &reference);
+    benchmarkCube<Cube>("Midpoint", Cube::Midpoint, planes, steps, false, &reference);
+    benchmarkCube<Cube>("Implicit", Cube::Implicit, planes, steps, false, &reference);
+    benchmarkCube<Cube>("Adaptive", Cube::Adaptive, planes, steps, true, &reference);
+    printf("  ],\n");
+}
+
+/// Find how deep the corners of a cube are inside the scene planes.
+/// @returns the largest penetration of any corner into any plane, in meters.
+
+float penetration(const Cube &cube, const std::vector<Plane> &planes)
+{
+    Cube::Corners corners;
+    Cube::calculateCorners(cube.properties, cube.secondary(), corners);
+
+    float maximum = 0;
+
+    for (unsigned int i=0; i<planes.size(); i++)
+    {
+        float depth[8];
+        Cube::penetrationsScalar(corners, planes[i], depth);
+        for (int j=0; j<8; j++)
+            maximum = Mathematics::maximum(maximum, depth[j]);
+    }
+
+    return maximum;
+}
+
+/// Run the player cube with an integrator at a given rate and compare it with a reference.
+/// The input script is sampled at the time of each step, so every rate sees the same input.
+/// @param name the name to report.
+/// @param integrator the integrator to use.
+/// @param rate the number of steps per second.
+/// @param planes the scene collision planes.
+/// @param reference the position after each step of RK4 at 100Hz.
+/// @param last true if this is the last entry in the json array.
+
+void benchmarkTimestep(const char name[], CubeBase::Integrator integrator, int rate, const std::vector<Plane> &planes, const std::vector<Vector> &reference, bool last)
+{
+    const float dt = 1.0f / rate;
+    const int steps = (int) reference.size() * rate / 100;
+
+    Cube cube;
+    cube.canSleep = false;
+    cube.integrator = integrator;
+
+    float drift = 0;
+    float deepest = 0;
+    float lowest = cube.state().position.y;
+
+    for (int i=0; i<steps; i++)
+    {
+        cube.update(script(i * 100 / rate), planes, dt);
+
+        const int t = (i+1) * 100 / rate - 1;
+
+        if (( (i+1) * 100 ) % rate == 0 && t < 100)
+            drift = Mathematics::maximum(drift, (cube.state().position - reference[t]).length());
+
+        if (t >= 100)
+            deepest = Mathematics::maximum(deepest, penetration(cube, planes));
+
+        lowest = Mathematics::minimum(lowest, cube.state().position.y);
+    }
+
+    Cube resting;
+    resting.canSleep = false;
+    resting.integrator = integrator;
+
+    Cube::State state = resting.state();
+    state.position = Vector(0,0.6f,0);
+    resting.snap(state);
+
+    Cube::Input none;
+    none.left = none.right = none.forward = none.back = none.jump = false;
+
+    for (int i=0; i<10*rate; i++)
+        resting.update(none, planes, dt);
+
+    printf("    { \"name\": \"%s\", \"hz\": %d, \"max_drift_m\": %.4f, \"max_penetration_m\": %.4f, \"lowest_height_m\": %.4f, \"resting_penetration_m\": %.5f }%s\n",
+           name, rate, drift, deepest, lowest, penetration(resting, planes), last ? "" : ",");
+}
+
+/// Compare RK4 and the implicit integrator at 60Hz and 30Hz with RK4 at 100Hz.
+///
+/// The cube is run for ten seconds of the input script. Drift is measured over the
+/// first second where the steps line up with the reference (every 0.05 seconds at 60Hz,
+/// 0.1 at 30Hz). Penetration is measured after the first second because the cube starts
+/// out overlapping the front plane, the lowest height shows how far the center sinks on
+/// landing, and the resting penetration is that of a cube settled on the floor without input.
+
+void benchmarkTimesteps(const std::vector<Plane> &planes)
+{
+    std::vector<Vector> reference(1000);
+
+    Cube cube;
+    cube.canSleep = false;
+
+    for (unsigned int t=0; t<reference.size(); t++)
+    {
+        cube.update(script(t), planes, timestep);
+        reference[t] = cube.state().position;
+    }
+
+    printf("  \"timesteps\": [\n");
+    benchmarkTimestep("RK4", Cube::RK4, 100, planes, reference, false);
+    benchmarkTimestep("RK4", Cube::RK4, 60, planes, reference, false);
+    benchmarkTimestep("RK4", Cube::RK4, 30, planes, reference, false);
+    benchmarkTimestep("Implicit", Cube::Implicit, 100, planes, reference, false);
+    benchmarkTimestep("Implicit", Cube::Implicit, 60, planes, reference, false);
+    benchmarkTimestep("Implicit", Cube::Implicit, 30, planes, reference, true);
+    printf("  ],\n");
+}
+
+/// Benchmark the force pipelines of the cube types.
+
+void benchmarkPipelines(const std::vector<Plane> &planes, unsigned int steps)
+{
+    printf("  \"pipelines\": [\n");
+    benchmarkCube<Cube>("Cube", Cube::RK4, planes, steps, false);
+    benchmarkCube<PropCube>("PropCube", Cube::RK4, planes, steps, false);
+    benchmarkCube<ProjectileCube>("ProjectileCube", Cube::RK4, planes, steps, true);
+    printf("  ],\n");
+}
+
+/// Benchmark a batch of cubes against the same cubes updated one at a time.
+/// The cubes repeat a 16x16 wall of positions, each repeat with a different
+/// orientation. Cubes in a batch do not collide with each other, so overlapping is fine.
+/// @param planes the scene collision planes.
+/// @param count the number of cubes.
+/// @param steps the number of steps to run.
+/// @param last true if this is the last entry in the json array.
+
+void benchmarkBatch(const std::vector<Plane> &planes, int count, unsigned int steps, bool last)
+{
+    Vector axis(1,2,3);
+    axis.normalize();
+
+    std::vector<Cube> cubes(count);
+    CubeBatch batch;
+
+    for (int i=0; i<count; i++)
+    {
+        Cube::State state = cubes[i].state();
+        state.position = Vector((float) (i%16) - 7.5f, 1.0f + (float) ((i/16)%16), -2.0f);
+        state.orientation = Quaternion(0.01f * (i/256), axis);
+        cubes[i].canSleep = false;
+        cubes[i].snap(state);
+        batch.add(state, cubes[i].properties);
+    }
+
+    Cube::Input input = script(1);
+
+    for (int i=0; i<count; i++)
+        batch.input(i) = input;
+
+    double start = timer();
+    for (unsigned int t=0; t<steps; t++)
+        for (int i=0; i<count; i++)
+            cubes[i].update(input, planes, timestep);
+    const double individual = timer() - start;
+
+    start = timer();
+    for (unsigned int t=0; t<steps; t++)
+        batch.update(planes, timestep);
+    const double batched = timer() - start;
+
+    float maximum = 0;
+    for (int i=0; i<count; i++)
+        maximum = Mathematics::maximum(maximum, (batch.state(i).position - cubes[i].state().position).length());
+
+    printf("    { \"cubes\": %d, \"steps\": %u, \"cube_ns_per_body_step\": %.1f, \"batch_ns_per_body_step\": %.1f, \"max_position_difference\": %g }%s\n",
+           count, steps, individual * 1000000000.0 / ((double) steps * count), batched * 1000000000.0 / ((double) steps * count), maximum, last ? "" : ",");
+}
+
+/// Benchmark batches from a few hundred cubes up to the tens of thousands a server
+/// steps per tick, where the memory layout matters most.
+///
+/// Batch integration of many cubes against individual cube updates
+
+void benchmarkBatches(const std::vector<Plane> &planes, unsigned int steps)
+{
+    const unsigned int batchSteps = steps / 100;
+
+    printf("  \"batch\": [\n");
+    benchmarkBatch(planes, 256, batchSteps, false);
+    benchmarkBatch(planes, 4096, batchSteps, false);
+    benchmarkBatch(planes, 32768, batchSteps, true);
+    printf("  ],\n");
+}
+
+#ifdef SSE
+
+/// Find the largest difference between the elements of two transforms.
+
+float difference(const Transform &a, const Transform &b)
+{
+    const float elements[] =
+    {
+        a.m11 - b.m11, a.m12 - b.m12, a.m13 - b.m13,
+        a.m21 - b.m21, a.m22 - b.m22, a.m23 - b.m23,
+        a.m31 - b.m31, a.m32 - b.m32, a.m33 - b.m33
+    };
+
+    float maximum = (a.translation - b.translation).length();
+    for (int i=0; i<9; i++)
+        maximum = Mathematics::maximum(maximum, fabsf(elements[i]));
+
+    return maximum;
+}
+
+/// Benchmark the SSE kernels against the scalar code they replace.
+///
+/// The results must be the same bits, and the SSE version has to be faster to
+/// be worth having.
+
+void benchmarkSSE(const std::vector<Plane> &planes, unsigned int steps)
+{
+    const int count = 64;
+    const unsigned int repeat = steps / 10;
+
+    Vector axis(1,2,3);
+    axis.normalize();
+
+    Cube::Corners corners[count];
+    Cube::State states[count];
+    Cube::Properties properties;
+    properties.set(1, 1);
+
+    for (int i=0; i<count; i++)
+    {
+        Cube cube;
+        Cube::State state = cube.state();
+        state.position = Vector((float) (i%8) - 4.0f, 0.1f * (float) (i%5), (float) (i/8) - 4.0f);
+        state.orientation = Quaternion(0.1f * i, axis);
+        state.momentum = Vector(0.5f * (i%3), -0.25f * i, 1.0f);
+        state.angularMomentum = Vector(0.2f * (i%7), 0.3f, -0.1f * i);
+        cube.snap(state);
+        Cube::calculateCorners(cube.properties, cube.secondary(), corners[i]);
+        states[i] = state;
+    }
+
+    int mismatches = 0;
+    float maximum = 0;
+
+    for (int i=0; i<count; i++)
+    {
+        for (unsigned int p=0; p<planes.size(); p++)
+        {
+            float scalar[8];
+            float sse[8];
+            if (Cube::penetrationsScalar(corners[i], planes[p], scalar)!=Cube::penetrationsSSE(corners[i], planes[p], sse))
+                mismatches++;
+            for (int j=0; j<8; j++)
+                maximum = Mathematics::maximum(maximum, fabsf(scalar[j] - sse[j]));
+        }
+    }
+
+    float penetration[8];
+
+    int scalarMasks = 0;
+    double start = timer();
+    for (unsigned int r=0; r<repeat; r++)
+        for (int i=0; i<count; i++)
+            for (unsigned int p=0; p<planes.size(); p++)
+                scalarMasks += Cube::penetrationsScalar(corners[i], planes[p], penetration);
+    const double scalar = timer() - start;
+
+    int sseMasks = 0;
+    start = timer();
+    for (unsigned int r=0; r<repeat; r++)
+        for (int i=0; i<count; i++)
+            for (unsigned int p=0; p<planes.size(); p++)
+                sseMasks += Cube::penetrationsSSE(corners[i], planes[p], penetration);
+    const double sse = timer() - start;
+
+    if (scalarMasks!=sseMasks)
+        mismatches++;
+
+    const double tests = (double) repeat * count * planes.size();
+
+    printf("  \"sse\": { \"penetrations\": { \"scalar_ns\": %.2f, \"sse_ns\": %.2f, \"mismatches\": %d, \"max_difference\": %g },\n",
+           scalar * 1000000000.0 / tests, sse * 1000000000.0 / tests, mismatches, maximum);
+
+    // secondary state: spin quaternion product, rotation matrix and inverse transform
+
+    int recalculateMismatches = 0;
+    float recalculateMaximum = 0;
+
+    for (int i=0; i<count; i++)
+    {
+        Cube::Secondary a, b;
+        a.calculateScalar(states[i], properties);
+        b.calculateSSE(states[i], properties);
+
+        const float differences[] =
+        {
+            (a.spin - b.spin).length(),
+            (a.velocity - b.velocity).length(),
+            (a.angularVelocity - b.angularVelocity).length(),
+            difference(a.bodyToWorld, b.bodyToWorld),
+            difference(a.worldToBody, b.worldToBody)
+        };
+
+        for (int j=0; j<5; j++)
+        {
+            if (differences[j]!=0)
+                recalculateMismatches++;
+            recalculateMaximum = Mathematics::maximum(recalculateMaximum, differences[j]);
+        }
+    }
+
+    Cube::Secondary secondary;
+    float scalarCheck = 0;
+    float sseCheck = 0;
+
+    start = timer();
+    for (unsigned int r=0; r<repeat; r++)
+        for (int i=0; i<count; i++)
+        {
+            secondary.calculateScalar(states[i], properties);
+            scalarCheck += secondary.spin.w + secondary.worldToBody.translation.x;
+        }
+    const double scalarRecalculate = timer() - start;
+
+    start = timer();
+    for (unsigned int r=0; r<repeat; r++)
+        for (int i=0; i<count; i++)
+        {
+            secondary.calculateSSE(states[i], properties);
+            sseCheck += secondary.spin.w + secondary.worldToBody.translation.x;
+        }
+    const double sseRecalculate = timer() - start;
+
+    if (scalarCheck!=sseCheck)
+        recalculateMismatches++;
+
+    const double recalculations = (double) repeat * count;
+
+    printf("             \"recalculate\": { \"scalar_ns\": %.2f, \"sse_ns\": %.2f, \"mismatches\": %d, \"max_difference\": %g } },\n",
+           scalarRecalculate * 1000000000.0 / recalculations, sseRecalculate * 1000000000.0 / recalculations, recalculateMismatches, recalculateMaximum);
+}
+
+#endif
+
+/// Benchmark the scene update with only the player cube.
+
+void benchmarkScene(unsigned int steps)
+{
+    Scene scene;
+    scene.initialize();
+
+    const double start = timer();
+
+    for (unsigned int t=0; t<steps; t++)
+    {
+        scene.input(scene.player) = script(t);
+        scene.update(t);
+    }
+
+    const double seconds = timer() - start;
+
+    printf("  \"scene\": { \"ns_per_step\": %.1f, \"sleeping\": %s },\n", seconds * 1000000000.0 / steps, scene.cube(scene.player).sleeping() ? "true" : "false");
+}
+
+/// Benchmark scenes with many bodies, and the broadphase on its own.
+///
+/// Many bodies: the player cube plus props in a loose grid a few layers deep,
+/// dropped so that they land on each other and tumble. also times the broadphase
+/// alone on randomly jittering boxes to check that it scales close to linearly.
+
+void benchmarkBodies(unsigned int steps)
+{
+    printf("  \"bodies\": [\n");
+
+    for (int k=0; k<2; k++)
+    {
+        const int count = k ? 192 : 48;
+        const unsigned int bodySteps = steps / 100;
+
+        Scene scene;
+        scene.initialize();
+
+        for (int i=0; i<count; i++)
+        {
+            Cube::State state = scene.cube(scene.player).state();
+            state.position = Vector(-2.75f + (i%6) * 1.1f, 1.0f + (i/48) * 1.5f, -6.0f + ((i/6)%8) * 1.1f);
+            state.orientation = Quaternion(1, 0.1f * (i%3), 0.1f * (i%5), 0.1f * (i%7));
+            state.orientation.normalize();
+            scene.add(state);
+        }
+
+        const double start = timer();
+
+        for (unsigned int t=0; t<bodySteps; t++)
+        {
+            scene.input(scene.player) = script(t);
+            scene.update(t);
+        }
+
+        const double seconds = timer() - start;
+
+        printf("    { \"bodies\": %d, \"steps\": %u, \"ns_per_step\": %.1f, \"ns_per_body_step\": %.1f },\n",
+               count + 1, bodySteps, seconds * 1000000000.0 / bodySteps, seconds * 1000000000.0 / (bodySteps * (count + 1)));
+    }
+
+    for (int k=0; k<2; k++)
+    {
+        const int count = k ? 4096 : 1024;
+        const unsigned int updates = 50;
+        const float size = (float) pow(count * 8.0, 1.0 / 3.0);
+
+        Broadphase broadphase;
+        std::vector<Vector> centers(count);
+
+        srand(1);
+
+        for (int i=0; i<count; i++)
+        {
+            centers[i] = Vector(size * rand() / RAND_MAX, size * rand() / RAND_MAX, size * rand() / RAND_MAX);
+            broadphase.add(centers[i] - Vector(0.5f,0.5f,0.5f), centers[i] + Vector(0.5f,0.5f,0.5f));
+        }
+
+        // the added boxes are sorted into the axes when the broadphase is first used, keep that out of the timing
+
+        std::vector<Broadphase::Pair> pairs;
+        broadphase.pairs(pairs);
+
+        const unsigned int swaps = broadphase.swaps();
+        const double start = timer();
+
+        for (unsigned int t=0; t<updates; t++)
+        {
+            for (int i=0; i<count; i++)
+            {
+                centers[i] += Vector(0.02f * rand() / RAND_MAX - 0.01f, 0.02f * rand() / RAND_MAX - 0.01f, 0.02f * rand() / RAND_MAX - 0.01f);
+                broadphase.update(i, centers[i] - Vector(0.5f,0.5f,0.5f), centers[i] + Vector(0.5f,0.5f,0.5f));
+            }
+            broadphase.pairs(pairs);
+        }
+
+        const double seconds = timer() - start;
+
+        printf("    { \"broadphase_boxes\": %d, \"pairs\": %d, \"ns_per_box_update\": %.1f, \"swaps_per_box_update\": %.2f }%s\n",
+               count, (int) pairs.size(), seconds * 1000000000.0 / (updates * count), (double) (broadphase.swaps() - swaps) / (updates * count), k ? "" : ",");
+    }
+
+    printf("  ],\n");
+}
+
+/// Benchmark the contact solver on a stack of props.
+///
+/// Contact solver: a stack of props at a 30Hz tick rate, with and without warm starting.
+/// the stack is standing if the top prop ends up within 0.1m of where it started.
+
+void benchmarkSolver()
+{
+    printf("  \"solver\": [\n");
+
+    for (int k=0; k<4; k++)
+    {
+        const int height = 5;
+        const float dt = 1.0f / 30.0f;
+        const unsigned int stackSteps = 600;
+
+        Scene scene;
+        scene.initialize();
+        scene.contactMode = Scene::SolverContacts;
+        scene.solver.iterations = k & 1 ? 8 : 4;
+        scene.solver.warmStarting = k < 2;
+
+        for (int i=0; i<height; i++)
+        {
+            Cube::State state = scene.cube(scene.player).state();
+            state.position = Vector(3, 0.5f + i, 0);
+            scene.add(state);
+        }
+
+        const Vector start = scene.cubes[height].state().position;
+
+        int points = 0;
+        int warmStarted = 0;
+
+        const double begin = timer();
+
+        for (unsigned int t=0; t<stackSteps; t++)
+        {
+            scene.update(t, dt);
+            points += scene.solver.statistics.points;
+            warmStarted += scene.solver.statistics.warmStarted;
+        }
+
+        const double seconds = timer() - begin;
+
+        const bool standing = (scene.cubes[height].state().position - start).length() < 0.1f;
+
+        printf("    { \"height\": %d, \"hz\": 30, \"iterations\": %d, \"warm_starting\": %s, \"ns_per_step\": %.1f, \"points_per_step\": %.1f, \"warm_started_per_step\": %.1f, \"standing\": %s }%s\n",
+               height, scene.solver.iterations, scene.solver.warmStarting ? "true" : "false", seconds * 1000000000.0 / stackSteps,
+               (double) points / stackSteps, (double) warmStarted / stackSteps, standing ? "true" : "false", k<3 ? "," : "");
+    }
+
+    printf("  ],\n");
+}
+
+/// Benchmark island solving on one thread and on worker threads.
+///
+/// Islands: a grid of separate stacks solved on the calling thread only, then on
+/// a worker thread per extra processor. props are kept awake so every island is
+/// solved every step. islands are independent so both runs end in the same state.
+
+void benchmarkIslands()
+{
+    printf("  \"islands\": [\n");
+
+    const int grid = 8;
+    const int height = 3;
+    const unsigned int islandSteps = 300;
+
+    const int threads[] = { 0, Workers::processors() - 1 };
+
+    unsigned int islandHash[2];
+
+    for (int k=0; k<2; k++)
+    {
+        Scene scene;
+        scene.initialize();
+        scene.contactMode = Scene::SolverContacts;
+        scene.workers.start(threads[k]);
+
+        for (int x=0; x<grid; x++)
+        {
+            for (int z=0; z<grid; z++)
+            {
+                for (int y=0; y<height; y++)
+                {
+                    Cube::State state = scene.cube(scene.player).state();
+                    state.position = Vector(2.0f * (x - grid/2), 0.5f + y, 2.0f * (z - grid/2) + 10);
+                    scene.add(state);
+                    scene.cubes.back().canSleep = false;
+                }
+            }
+        }
+
+        const double begin = timer();
+
+        for (unsigned int t=0; t<islandSteps; t++)
+            scene.update(t);
+
+        const double seconds = timer() - begin;
+
+        islandHash[k] = 0;
+        for (unsigned int i=0; i<scene.cubes.size(); i++)
+            islandHash[k] = islandHash[k] * 31 + scene.cubes[i].state().hash();
+
+        printf("    { \"bodies\": %d, \"threads\": %d, \"ns_per_step\": %.1f%s }%s\n",
+               (int) scene.cubes.size(), threads[k], seconds * 1000000000.0 / islandSteps,
+               k==1 ? (islandHash[0]==islandHash[1] ? ", \"same_result\": true" : ", \"same_result\": false") : "", k<1 ? "," : "");
+    }
+
+    printf("  ],\n");
+}
+
+/// Benchmark adding, saving, restoring and removing props.
+///
+/// Entities: a large grid of props added, saved and restored, then half of them removed by handle in scattered order.
+/// the broadphase sorts the added props into its axes in one pass when it is first used, which here is the first remove.
+
+void benchmarkEntities()
+{
+    const int grid = 128;
+    const int count = grid * grid;
+
+    Scene scene;
+    scene.initialize();
+    scene.planes.clear();
+
+    std::vector<Entities::Handle> handles;
+    handles.reserve(count);
+
+    double start = timer();
+
+    for (int x=0; x<grid; x++)
+    {
+        for (int z=0; z<grid; z++)
+        {
+            Cube::State state = scene.cube(scene.player).state();
+            state.position = Vector(2.0f * x + 4, 0.5f, 2.0f * z);
+            handles.push_back(scene.add(state));
+        }
+    }
+
+    const double addSeconds = timer() - start;
+
+    Scene::Snapshot snapshot;
+
+    start = timer();
+    scene.snapshot(snapshot);
+    const double snapshotSeconds = timer() - start;
+
+    start = timer();
+    scene.restore(snapshot);
+    const double restoreSeconds = timer() - start;
+
+    start = timer();
+
+    for (int i=0; i<count/2; i++)
+        scene.remove(handles[(i * 7919) % count]);
+
+    const double removeSeconds = timer() - start;
+
+    int stale = 0;
+    for (int i=0; i<count/2; i++)
+        stale += scene.prop(handles[(i * 7919) % count])==0;
+
+    printf("  \"entities\": { \"count\": %d, \"ns_per_add\": %.1f, \"ns_per_remove\": %.1f, \"snapshot_ms\": %.3f, \"restore_ms\": %.3f, \"removed_handles_stale\": %s },\n",
+           count, addSeconds * 1000000000.0 / count, removeSeconds * 1000000000.0 / (count/2), snapshotSeconds * 1000.0, restoreSeconds * 1000.0,
+           stale==count/2 ? "true" : "false");
+}
+
+/// Benchmark the static world against scanning the same number of planes.
+///
+/// Static world: the floor plane replaced by a triangle mesh floor with boxes scattered
+/// over it. the plane scan entry gives the player cube the same number of surfaces as
+/// planes instead (placed far away so they never touch), which is what it costs to
+/// scan every surface of a level at every integration step.
+
+void benchmarkWorld(const std::vector<Plane> &planes, unsigned int steps)
+{
+    const int grid = 40;
+    const int boxCount = 100;
+    const float size = 40.0f;
+
+    Scene scene;
+    scene.initialize();
+    scene.planes.pop_back();
+
+    std::vector<Vector> vertices;
+    std::vector<int> indices;
+
+    for (int z=0; z<=grid; z++)
+        for (int x=0; x<=grid; x++)
+            vertices.push_back(Vector(size * x / grid - size/2, 0, size * z / grid - size/2));
+
+    for (int z=0; z<grid; z++)
+    {
+        for (int x=0; x<grid; x++)
+        {
+            const int a = z * (grid+1) + x;
+            const int b = a + 1;
+            const int c = a + grid + 1;
+            const int d = c + 1;
+            const int quad[] = { a, c, b, b, c, d };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    scene.world.addMesh(&vertices[0], &indices[0], (int) indices.size() / 3);
+
+    srand(2);
+
+    for (int i=0; i<boxCount; i++)
+    {
+        const Vector center(size * rand() / RAND_MAX - size/2, 0.25f, size * rand() / RAND_MAX - size/2);
+        if (center.length()<3)
+            continue;
+        scene.world.addBox(center, Vector(0.5f, 0.25f, 0.5f));
+    }
+
+    const double buildStart = timer();
+    scene.world.build();
+    const double buildSeconds = timer() - buildStart;
+
+    // queries around random points near the floor
+
+    const int queries = 100000;
+    std::vector<Plane> queryPlanes;
+    std::vector<int> querySurfaces;
+    int found = 0;
+
+    double start = timer();
+
+    for (int i=0; i<queries; i++)
+    {
+        queryPlanes.clear();
+        querySurfaces.clear();
+        const Vector center(size * (i%317) / 317 - size/2, 0.5f, size * (i%293) / 293 - size/2);
+        scene.world.query(center, 1.0f, queryPlanes, querySurfaces);
+        found += (int) queryPlanes.size();
+    }
+
+    const double querySeconds = timer() - start;
+
+    // scene steps on the world
+
+    const unsigned int worldSteps = steps / 10;
+
+    start = timer();
+
+    for (unsigned int t=0; t<worldSteps; t++)
+    {
+        scene.input(scene.player) = script(t);
+        scene.update(t);
+    }
+
+    const double sceneSeconds = timer() - start;
+
+    // the same number of surfaces scanned as planes
+
+    std::vector<Plane> scanPlanes = planes;
+    for (int i=0; i<scene.world.surfaces(); i++)
+        scanPlanes.push_back(Plane(Vector(0,0,1), -100.0f - i));
+
+    Cube cube;
+    cube.canSleep = false;
+
+    start = timer();
+
+    for (unsigned int t=0; t<worldSteps; t++)
+        cube.update(script(t), scanPlanes, timestep);
+
+    const double scanSeconds = timer() - start;
+
+    printf("  \"world\": { \"surfaces\": %d, \"nodes\": %d, \"build_ms\": %.2f, \"ns_per_query\": %.1f, \"planes_per_query\": %.2f, \"ns_per_step\": %.1f, \"plane_scan_ns_per_step\": %.1f },\n",
+           scene.world.surfaces(), scene.world.size(), buildSeconds * 1000.0, querySeconds * 1000000000.0 / queries, (double) found / queries,
+           sceneSeconds * 1000000000.0 / worldSteps, scanSeconds * 1000000000.0 / worldSteps);
+}
+
+/// Benchmark the heightfield terrain.
+///
+/// Terrain: the floor plane replaced by rolling hills in a heightfield of 4x4 tiles.
+/// queries look up the triangles under the eight corners of a cube.
+
+void benchmarkTerrain(unsigned int steps)
+{
+    const int tiles = 4;
+    const int cells = 64;
+    const float cellSize = 0.5f;
+    const float heightScale = 0.001f;
+    const Vector origin(-64, -1, -64);
+
+    Scene scene;
+    scene.initialize();
+    scene.planes.pop_back();
+    scene.terrain.initialize(origin, tiles, tiles, cells, cellSize, heightScale);
+
+    std::vector<unsigned short> heights(scene.terrain.tileSamples());
+
+    for (int tz=0; tz<tiles; tz++)
+    {
+        for (int tx=0; tx<tiles; tx++)
+        {
+            for (int z=0; z<=cells; z++)
+            {
+                for (int x=0; x<=cells; x++)
+                {
+                    const float wx = origin.x + (tx*cells + x) * cellSize;
+                    const float wz = origin.z + (tz*cells + z) * cellSize;
+                    const float height = 0.3f * Mathematics::sin(wx * 0.3f) * Mathematics::cos(wz * 0.25f) + 0.2f * Mathematics::sin(wz * 0.5f);
+                    heights[z*(cells+1) + x] = (unsigned short) ((height - origin.y) / heightScale);
+                }
+            }
+
+            scene.terrain.setTile(tx, tz, &heights[0]);
+        }
+    }
+
+    const int queries = 100000;
+    std::vector<Plane> queryPlanes;
+    std::vector<int> queryTriangles;
+    int found = 0;
+
+    double start = timer();
+
+    for (int i=0; i<queries; i++)
+    {
+        queryPlanes.clear();
+        queryTriangles.clear();
+
+        const Vector center(60.0f * (i%317) / 317 - 30, 0.5f, 60.0f * (i%293) / 293 - 30);
+
+        Vector corners[8];
+        for (int j=0; j<8; j++)
+            corners[j] = center + Vector(j&1 ? 0.5f : -0.5f, j&2 ? 0.5f : -0.5f, j&4 ? 0.5f : -0.5f);
+
+        scene.terrain.query(corners, 8, 1.0f, queryPlanes, queryTriangles);
+        found += (int) queryPlanes.size();
+    }
+
+    const double querySeconds = timer() - start;
+
+    const unsigned int terrainSteps = steps / 10;
+
+    start = timer();
+
+    for (unsigned int t=0; t<terrainSteps; t++)
+    {
+        scene.input(scene.player) = script(t);
+        scene.update(t);
+    }
+
+    const double sceneSeconds = timer() - start;
+
+    printf("  \"terrain\": { \"samples\": %d, \"bytes_per_sample\": %d, \"ns_per_cube_query\": %.1f, \"planes_per_cube_query\": %.2f, \"ns_per_step\": %.1f },\n",
+           tiles * tiles * scene.terrain.tileSamples(), (int) sizeof(unsigned short), querySeconds * 1000000000.0 / queries, (double) found / queries,
+           sceneSeconds * 1000000000.0 / terrainSteps);
+}
+
+/// Benchmark continuous collision.
+///
+/// Continuous collision: cubes fired at a thin wall at increasing timesteps, with and without sweeping.
+
+void benchmarkContinuous()
+{
+    printf("  \"continuous\": [\n");
+
+    const float timesteps[] = { 0.01f, 0.02f, 1.0f / 30, 1.0f / 15 };
+    const int count = sizeof(timesteps) / sizeof(timesteps[0]);
+    const int shots = 24;
+    const float wall = 3.0f;
+
+    for (int i=0; i<count; i++)
+    {
+        const float dt = timesteps[i];
+        const unsigned int shotSteps = (unsigned int) (1.0f / dt);
+
+        int tunneled[2] = { 0, 0 };
+        double seconds[2] = { 0, 0 };
+
+        for (int continuous=0; continuous<2; continuous++)
+        {
+            for (int shot=0; shot<shots; shot++)
+            {
+                Scene scene;
+                scene.initialize();
+                scene.planes.clear();
+                scene.planes.push_back(Plane(Vector(0,1,0), 0));
+                scene.continuous = continuous!=0;
+                scene.world.addBox(Vector(wall, 1, 0), Vector(0.05f, 2, 3));
+                scene.world.build();
+
+                Cube::State state = scene.cube(scene.player).state();
+                state.position = Vector(0, 0.5f + 0.05f * shot, 0);
+                state.momentum = Vector(10.0f + 2.0f * shot, 0, 0) * scene.cube(scene.player).properties.mass;
+                state.angularMomentum = Vector(0,0,0);
+                scene.cube(scene.player).snap(state);
+
+                bool through = false;
+
+                double start = timer();
+
+                for (unsigned int t=0; t<shotSteps; t++)
+                {
+                    scene.update(t, dt);
+                    through = through || scene.cube(scene.player).state().position.x>wall;
+                }
+
+                seconds[continuous] += timer() - start;
+                tunneled[continuous] += through;
+            }
+        }
+
+        printf("    { \"timestep\": %.4f, \"shots\": %d, \"tunneled\": %d, \"tunneled_continuous\": %d, \"ns_per_step\": %.1f, \"continuous_ns_per_step\": %.1f }%s\n",
+               dt, shots, tunneled[0], tunneled[1], seconds[0] * 1000000000.0 / (shots * shotSteps), seconds[1] * 1000000000.0 / (shots * shotSteps), i<count-1 ? "," : "");
+    }
+
+    printf("  ],\n");
+}
+
+/// Benchmark client side correction.
+///
+/// Client side correction against a server running the same inputs with latency.
+/// corrections that match the client history cost only the comparison. the nudged
+/// corrections are moved slightly off the history: with the default tolerance they
+/// are skipped, and the forced run sets the tolerance to zero so every one rewinds and replays.
+
+void benchmarkReplay(unsigned int steps)
+{
+    const unsigned int latency = 10;
+
+    double seconds[3];
+    History::Counters counters[3];
+    unsigned int corrections = 0;
+
+    for (int run=0; run<3; run++)
+    {
+        const bool nudged = run>0;
+        const bool forced = run==2;
+
+        Client client;
+        Server server;
+        client.initialize();
+        server.initialize();
+
+        if (forced)
+        {
+            client.history.tolerance.position = 0;
+            client.history.tolerance.orientation = 0;
+            client.history.tolerance.momentum = 0;
+            client.history.tolerance.angularMomentum = 0;
+        }
+
+        std::vector<Cube::State> states(steps);
+        std::vector<Cube::Input> inputs(steps);
+
+        seconds[run] = 0;
+        corrections = 0;
+
+        for (unsigned int t=0; t<steps; t++)
+        {
+            client.input(client.player) = script(t);
+            client.update(t);
+
+            server.update(t, client.input(client.player), std::vector<Move>());
+            states[t] = server.cube(server.player).state();
+            inputs[t] = server.input(server.player);
+
+            if (t>=latency)
+            {
+                Cube::State state = states[t-latency];
+                if (nudged)
+                    state.position.y += 0.001f;
+
+                const double start = timer();
+                client.synchronize(t-latency, state, inputs[t-latency]);
+                seconds[run] += timer() - start;
+
+                corrections++;
+            }
+        }
+
+        counters[run] = client.history.counters;
+    }
+
+    printf("  \"replay\": { \"latency\": %u, \"corrections\": %u, \"ns_per_correction\": %.1f, \"nudged_ns_per_correction\": %.1f, \"nudged_replayed\": %u, \"forced_ns_per_correction\": %.1f, \"forced_replayed\": %u, \"forced_ns_per_replayed_step\": %.1f },\n",
+           latency, corrections, seconds[0] * 1000000000.0 / corrections, seconds[1] * 1000000000.0 / corrections, counters[1].replayed,
+           seconds[2] * 1000000000.0 / corrections, counters[2].replayed, seconds[2] * 1000000000.0 / (counters[2].replayedSteps ? counters[2].replayedSteps : 1));
+}
+
+/// Benchmark coalescing corrections that arrive in bursts.
+///
+/// Corrections arriving bunched up, several per frame as after network jitter. each
+/// one is nudged off the history the opposite way to the last so that it replays.
+/// applying every correction as it arrives replays once per packet, coalescing them
+/// replays once per frame from the newest.
+
+void benchmarkCoalescing(unsigned int steps)
+{
+    const unsigned int latency = 10;
+    const unsigned int burst = 5;
+
+    double seconds[2];
+    unsigned int replayed[2];
+    unsigned int frames = 0;
+
+    for (int coalescing=0; coalescing<2; coalescing++)
+    {
+        Client client;
+        Server server;
+        client.initialize();
+        server.initialize();
+
+        client.history.tolerance.position = 0;
+        client.history.tolerance.orientation = 0;
+        client.history.tolerance.momentum = 0;
+        client.history.tolerance.angularMomentum = 0;
+
+        std::vector<Cube::State> states(steps);
+        std::vector<Cube::Input> inputs(steps);
+
+        seconds[coalescing] = 0;
+        frames = 0;
+
+        for (unsigned int t=0; t<steps; t++)
+        {
+            client.input(client.player) = script(t);
+            client.update(t);
+
+            server.update(t, client.input(client.player), std::vector<Move>());
+            states[t] = server.cube(server.player).state();
+            inputs[t] = server.input(server.player);
+
+            if (t<latency+burst || (t+1)%burst!=0)
+                continue;
+
+            const double start = timer();
+
+            for (unsigned int i=t+1-burst; i<=t; i++)
+            {
+                Cube::State state = states[i-latency];
+                state.position.y += i%2 ? 0.001f : -0.001f;
+
+                if (coalescing)
+                    client.receive(i-latency, state, inputs[i-latency]);
+                else
+                    client.synchronize(i-latency, state, inputs[i-latency]);
+            }
+
+            if (coalescing)
+                client.correct();
+
+            seconds[coalescing] += timer() - start;
+            frames++;
+        }
+
+        replayed[coalescing] = client.history.counters.replayed;
+    }
+
+    printf("  \"coalescing\": { \"corrections_per_frame\": %u, \"frames\": %u, \"replayed\": %u, \"ns_per_frame\": %.1f, \"coalesced_replayed\": %u, \"coalesced_ns_per_frame\": %.1f },\n",
+           burst, frames, replayed[0], seconds[0] * 1000000000.0 / frames, replayed[1], seconds[1] * 1000000000.0 / frames);
+}
+
+/// Benchmark replay spread over frames.
+///
+/// Replay spread over frames: corrections 200 steps in the past, as with the two
+/// second latency option, forced off the history every half second. the frame
+/// time is the correction work done each step, which spikes when a correction
+/// replays all at once and is bounded by the budget otherwise. the most steps
+/// replayed in a frame is the bound itself, the 99th percentile frame time is
+/// what it costs, the single worst frame is mostly scheduler noise.
+
+void benchmarkBudgetedReplay(unsigned int steps)
+{
+    const unsigned int latency = 200;
+    const int budgets[] = { 0, 20 };
+
+    printf("  \"budgeted_replay\": [\n");
+
+    for (int k=0; k<2; k++)
+    {
+        Client client;
+        Server server;
+        client.initialize();
+        server.initialize();
+        client.replayBudget = budgets[k];
+        client.shareLevel();
+
+        std::vector<Cube::State> states(steps);
+        std::vector<Cube::Input> inputs(steps);
+        std::vector<double> frames(steps);
+
+        double total = 0;
+        unsigned int mostSteps = 0;
+
+        for (unsigned int t=0; t<steps; t++)
+        {
+            client.input(client.player) = script(t);
+            client.update(t);
+
+            server.update(t, client.input(client.player), std::vector<Move>());
+            states[t] = server.cube(server.player).state();
+            inputs[t] = server.input(server.player);
+
+            const unsigned int replayedSteps = client.history.counters.replayedSteps;
+            const double start = timer();
+
+            if (t>=latency && t%50==0)
+            {
+                Cube::State state = states[t-latency];
+                state.position.x += 0.05f;
+                client.receive(t-latency, state, inputs[t-latency]);
+            }
+
+            client.correct();
+
+            frames[t] = timer() - start;
+            total += frames[t];
+
+            if (client.history.counters.replayedSteps - replayedSteps > mostSteps)
+                mostSteps = client.history.counters.replayedSteps - replayedSteps;
+        }
+
+        std::sort(frames.begin(), frames.end());
+
+        printf("    { \"budget\": %d, \"replayed\": %u, \"max_steps_per_frame\": %u, \"mean_frame_us\": %.2f, \"p99_frame_us\": %.2f }%s\n",
+               budgets[k], client.history.counters.replayed, mostSteps, total * 1000000.0 / steps, frames[steps * 99 / 100] * 1000000.0, k<1 ? "," : "");
+    }
+
+    printf("  ],\n");
+}
+
+/// Benchmark replay on the replay thread.
+///
+/// The same corrections replayed on the replay thread. the frame time is the work
+/// left on the main thread: setting up the replay scene with the player cube and
+/// the props near its path, and switching to the result.
+/// with a single processor the thread competes with the main thread for time, and
+/// corrections that arrive while it is busy wait and are coalesced.
+
+void benchmarkThreadedReplay(unsigned int steps)
+{
+    const unsigned int latency = 200;
+
+    Client client;
+    Server server;
+    client.initialize();
+    server.initialize();
+    client.startReplayThread();
+
+    std::vector<Cube::State> states(steps);
+    std::vector<Cube::Input> inputs(steps);
+    std::vector<double> frames(steps);
+
+    double total = 0;
+
+    for (unsigned int t=0; t<steps; t++)
+    {
+        client.input(client.player) = script(t);
+        client.update(t);
+
+        server.update(t, client.input(client.player), std::vector<Move>());
+        states[t] = server.cube(server.player).state();
+        inputs[t] = server.input(server.player);
+
+        const double start = timer();
+
+        if (t>=latency && t%50==0)
+        {
+            Cube::State state = states[t-latency];
+            state.position.x += 0.05f;
+            client.receive(t-latency, state, inputs[t-latency]);
+        }
+
+        client.correct();
+
+        frames[t] = timer() - start;
+        total += frames[t];
+    }
+
+    client.stopReplayThread();
+
+    std::sort(frames.begin(), frames.end());
+
+    printf("  \"threaded_replay\": { \"processors\": %d, \"replayed\": %u, \"mean_frame_us\": %.2f, \"p99_frame_us\": %.2f },\n",
+           Workers::processors(), client.history.counters.replayed, total * 1000000.0 / steps, frames[steps * 99 / 100] * 1000000.0);
+}
+
+/// Benchmark the ring buffers against standard containers.
+///
+/// Ring buffers against standard containers: events queued with a steady backlog,
+/// as in the connection latency queues which were a std::queue, moves added to a
+/// full history that drops its oldest, and numbers streamed from one thread to
+/// another. sum only keeps the compiler from optimizing the loops away.
+
+void benchmarkRingBuffers(unsigned int steps)
+{
+    const unsigned int count = steps * 10;
+    const unsigned int backlog = 20;
+
+    size_t sum = 0;
+
+    double start = timer();
+    {
+        std::queue<void*> queue;
+        for (unsigned int i=0; i<count; i++)
+        {
+            queue.push((void*) (size_t) i);
+            if (queue.size()>backlog)
+            {
+                sum += (size_t) queue.front();
+                queue.pop();
+            }
+        }
+    }
+    const double queueSeconds = timer() - start;
+
+    start = timer();
+    {
+        std::list<void*> list;
+        for (unsigned int i=0; i<count; i++)
+        {
+            list.push_back((void*) (size_t) i);
+            if (list.size()>backlog)
+            {
+                sum += (size_t) list.front();
+                list.pop_front();
+            }
+        }
+    }
+    const double listSeconds = timer() - start;
+
+    start = timer();
+    {
+        RingBuffer<void*> ring;
+        for (unsigned int i=0; i<count; i++)
+        {
+            ring.add((void*) (size_t) i);
+            if (ring.size()>backlog)
+            {
+                sum += (size_t) ring.oldest();
+                ring.remove();
+            }
+        }
+    }
+    const double ringSeconds = timer() - start;
+
+    // history of moves
+
+    const unsigned int historySize = 1024;
+
+    Move move;
+    move.input = script(0);
+    move.state = Cube().state();
+
+    start = timer();
+    {
+        std::deque<Move> moves;
+        for (unsigned int i=0; i<count; i++)
+        {
+            move.time = i;
+            if (moves.size()==historySize)
+                moves.pop_front();
+            moves.push_back(move);
+            sum += moves.front().time;
+        }
+    }
+    const double dequeSeconds = timer() - start;
+
+    start = timer();
+    {
+        RingBuffer<Move> moves(historySize, RingBuffer<Move>::DropOldest);
+        for (unsigned int i=0; i<count; i++)
+        {
+            move.time = i;
+            moves.add(move);
+            sum += moves.oldest().time;
+        }
+    }
+    const double historySeconds = timer() - start;
+
+    // one thread to another
+
+    LockFreeRingBuffer<unsigned int> buffer(1024);
+
+    Producer producer;
+    producer.buffer = &buffer;
+    producer.count = count;
+
+    Background thread;
+    thread.start();
+
+    start = timer();
+
+    thread.begin(produce, &producer);
+
+    for (unsigned int i=0; i<count; i++)
+    {
+        unsigned int value;
+        while (!buffer.remove(value))
+            yield();
+        sum += value;
+    }
+
+    const double threadSeconds = timer() - start;
+
+    while (!thread.finished())
+        yield();
+
+    printf("  \"ring_buffer\": { \"items\": %u, \"queue_ns_per_item\": %.2f, \"list_ns_per_item\": %.2f, \"ring_ns_per_item\": %.2f, \"deque_history_ns_per_move\": %.2f, \"ring_history_ns_per_move\": %.2f, \"lock_free_ns_per_item\": %.2f, \"processors\": %d, \"sum\": %u },\n",
+           count, queueSeconds * 1000000000.0 / count, listSeconds * 1000000000.0 / count, ringSeconds * 1000000000.0 / count,
+           dequeSeconds * 1000000000.0 / count, historySeconds * 1000000000.0 / count, threadSeconds * 1000000000.0 / count,
+           Workers::processors(), (unsigned int) sum);
+}
+
+/// One entry of the recorded input log: the input held for a number of ticks.
+
+struct Recording
+{
+    unsigned int ticks;
+    bool left, right, forward, back, jump;
+};
+
+/// Input log of the determinism check: forty seconds of moving, jumping and resting.
+
+const Recording recording[] =
+{
+    { 150, false, false, false, false, false },
+    {   6, false, false, false, false,  true },
+    { 180, false,  true, false, false, false },
+    {  40, false,  true,  true, false, false },
+    {   8, false, false,  true, false,  true },
+    { 220, false, false,  true, false, false },
+    { 300, false, false, false, false, false },
+    { 120,  true, false, false, false, false },
+    {   5,  true, false, false, false,  true },
+    { 140,  true, false, false,  true, false },
+    {  90, false, false, false,  true, false },
+    {   7, false, false, false, false,  true },
+    { 260, false, false, false, false, false },
+    {  60, false,  true, false, false, false },
+    {  10, false,  true, false, false,  true },
+    { 200, false,  true,  true, false, false },
+    { 150, false, false, false, false, false },
+    {   4, false, false, false, false,  true },
+    {  80,  true, false,  true, false, false },
+    { 400, false, false, false, false, false },
+    {  70, false, false, false,  true, false },
+    {   6, false, false, false,  true,  true },
+    { 194, false, false, false, false, false },
+    {  12,  true, false, false, false, false },
+    { 288, false, false, false, false, false },
+    { 1000, false, false, false, false, false }
+};
+
+/// Hash of the cubes at the end of the determinism check. DETERMINISTIC and
+/// FIXED_POINT builds must reproduce it exactly with any compiler, optimization
+/// level and machine. Update it only for a change that is meant to change the
+/// simulation, and say so in the commit.
+
+#ifdef FIXED_POINT
+const unsigned int expectedHash = 0x5df7e5d7;
+#else
+const unsigned int expectedHash = 0x63288ba5;
+#endif
+
+/// Check that the simulation is deterministic.
+///
+/// Plays the recorded input log through Scene::update on the player cube with
+/// a stack of props next to it, which takes the islands and penalty contacts
+/// between cubes along, then hashes the state of every cube. The number of steps
+/// is fixed by the log, not by the steps of the benchmark. In DETERMINISTIC and
+/// FIXED_POINT builds the hash must be expectedHash, other builds only report it.
+/// @returns false if the hash does not match in a build that checks it.
+
+bool checkDeterminism()
+{
+    Scene scene;
+    scene.initialize();
+
+    Cube::State state = scene.cube(scene.player).state();
+    state.momentum = Vector(0,0,0);
+
+    for (int i=0; i<6; i++)
+    {
+        state.position = Vector(3.0f, 0.6f + 1.1f * i, -2.0f);
+        scene.add(state);
+    }
+
+    unsigned int t = 0;
+
+    for (unsigned int i=0; i<sizeof(recording)/sizeof(recording[0]); i++)
+    {
+        Cube::Input &input = scene.input(scene.player);
+        input.left = recording[i].left;
+        input.right = recording[i].right;
+        input.forward = recording[i].forward;
+        input.back = recording[i].back;
+        input.jump = recording[i].jump;
+
+        for (unsigned int j=0; j<recording[i].ticks; j++)
+            scene.update(t++);
+    }
+
+    unsigned int hash = 2166136261u;
+    for (unsigned int i=0; i<scene.cubes.size(); i++)
+        hash = ( hash ^ scene.cubes[i].state().hash() ) * 16777619u;
+
+    #if defined(DETERMINISTIC) || defined(FIXED_POINT)
+    const bool checked = true;
+    #else
+    const bool checked = false;
+    #endif
+
+    const bool match = hash==expectedHash;
+
+    printf("  \"determinism\": { \"steps\": %u, \"cubes\": %d, \"hash\": \"%08x\", \"expected\": \"%08x\", \"checked\": %s, \"match\": %s }\n",
+           t, (int) scene.cubes.size(), hash, expectedHash, checked ? "true" : "false", match ? "true" : "false");
+
+    if (checked && !match)
+        fprintf(stderr, "determinism check failed: hash %08x, expected %08x\n", hash, expectedHash);
+
+    return match || !checked;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int steps = 100000;
+    if (argc>1)
+        steps = atoi(argv[1]);
+    if (steps<1000)
+        steps = 1000;
+
+    Scene world;
+    world.initialize();
+    const std::vector<Plane> &planes = world.planes;
+
+    printf("{\n");
+
+    reportBuild();
+
+    printf("  \"steps\": %u,\n", steps);
+
+    benchmarkIntegrators(planes, steps);
+    benchmarkTimesteps(planes);
+    benchmarkPipelines(planes, steps);
+    benchmarkBatches(planes, steps);
+
+    #ifdef SSE
+    benchmarkSSE(planes, steps);
+    #endif
+
+    benchmarkScene(steps);
+
+    benchmarkBodies(steps);
+    benchmarkSolver();
+    benchmarkIslands();
+    benchmarkEntities();
+    benchmarkWorld(planes, steps);
+    benchmarkTerrain(steps);
+    benchmarkContinuous();
+    benchmarkReplay(steps);
+    benchmarkCoalescing(steps);
+    benchmarkBudgetedReplay(steps);
+    benchmarkThreadedReplay(steps);
+    benchmarkRingBuffers(steps);
+
+    const bool deterministic = checkDeterminism();
+
+    printf("}\n");
+
+    return deterministic ? 0 : 1;
+}
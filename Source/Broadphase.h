@@ -0,0 +1,476 @@
+/// Sweep and prune broadphase.
+///
+/// Keeps the axis aligned bounding box of each body as a pair of min/max
+/// endpoints on each of the three axes, with each axis kept sorted by
+/// insertion sort. Bodies only move a little each step so the lists are
+/// nearly sorted already and each update costs close to O(n) plus the number
+/// of endpoints that swap. Whenever a min endpoint moves past a max endpoint
+/// the two boxes may have started overlapping and are tested on all three
+/// axes, whenever a max endpoint moves past a min endpoint they have stopped
+/// overlapping. The set of overlapping pairs is maintained incrementally from
+/// these swaps, so no pair is ever tested unless its boxes cross on some axis.
+/// The exception is adding bodies: their endpoints are merged into each axis
+/// in one pass the next time the broadphase is used, and their pairs found by
+/// one sweep along the x axis, instead of sorting each body in from infinity.
+/// Removed bodies leave their endpoints behind to be compacted out in the same
+/// pass, and each body keeps a list of the bodies it overlaps, so removing a
+/// body only visits its own pairs.
+
+class Broadphase
+{
+public:
+
+    /// Overlapping pair of body ids, a is always less than b.
+
+    struct Pair
+    {
+        int a;
+        int b;
+    };
+
+    /// Add a body with the given bounding box.
+    /// The body is only put into the sorted axes the next time the broadphase is
+    /// updated or queried, together with any other bodies added before then, see flush.
+    /// @returns the id of the body, ids are allocated consecutively from zero.
+
+    int add(const Vector &min, const Vector &max)
+    {
+        const int id = (int) boxes.size();
+
+        const float minimum[] = { min.x, min.y, min.z };
+        const float maximum[] = { max.x, max.y, max.z };
+
+        Box box;
+        for (int axis=0; axis<3; axis++)
+        {
+            box.min[axis] = minimum[axis];
+            box.max[axis] = maximum[axis];
+            box.index[axis][0] = -1;
+            box.index[axis][1] = -1;
+        }
+
+        boxes.push_back(box);
+        neighbours.push_back(std::vector<int>());
+
+        return id;
+    }
+
+    /// Move the bounding box of a body.
+
+    void update(int id, const Vector &min, const Vector &max)
+    {
+        assert(id>=0 && id<(int)boxes.size());
+
+        flush();
+
+        Box &box = boxes[id];
+
+        const float minimum[] = { min.x, min.y, min.z };
+        const float maximum[] = { max.x, max.y, max.z };
+
+        for (int axis=0; axis<3; axis++)
+        {
+            box.min[axis] = minimum[axis];
+            box.max[axis] = maximum[axis];
+            endpoints[axis][box.index[axis][0]].value = minimum[axis];
+            endpoints[axis][box.index[axis][1]].value = maximum[axis];
+        }
+
+        for (int axis=0; axis<3; axis++)
+        {
+            sortDown(axis, box.index[axis][0]);
+            sortDown(axis, box.index[axis][1]);
+            sortUp(axis, box.index[axis][1]);
+            sortUp(axis, box.index[axis][0]);
+        }
+    }
+
+    /// Remove a body.
+    /// The last body takes the id of the removed body so that ids stay consecutive.
+    /// The endpoints of the removed body are left in the axes marked as removed
+    /// until the next flush, so removing many bodies in a row costs one pass.
+
+    void remove(int id)
+    {
+        assert(id>=0 && id<(int)boxes.size());
+
+        if (inserted<(int)boxes.size())
+            flush();
+
+        const int last = (int) boxes.size() - 1;
+
+        // drop the pairs of the removed body
+
+        while (!neighbours[id].empty())
+            removePair(id, neighbours[id].back());
+
+        // mark the endpoints of the removed body for flush to take out
+
+        for (int axis=0; axis<3; axis++)
+        {
+            endpoints[axis][boxes[id].index[axis][0]].data = Removed;
+            endpoints[axis][boxes[id].index[axis][1]].data = Removed;
+        }
+
+        removed++;
+
+        // move the last body into the id, renumbering its pairs
+
+        if (id!=last)
+        {
+            boxes[id] = boxes[last];
+
+            for (int axis=0; axis<3; axis++)
+            {
+                endpoints[axis][boxes[id].index[axis][0]].data = id << 1;
+                endpoints[axis][boxes[id].index[axis][1]].data = (id << 1) | 1;
+            }
+
+            neighbours[id].swap(neighbours[last]);
+
+            for (unsigned int i=0; i<neighbours[id].size(); i++)
+            {
+                const int other = neighbours[id][i];
+
+                overlaps.erase(key(last, other));
+                overlaps.insert(key(id, other));
+
+                std::vector<int> &list = neighbours[other];
+                *std::find(list.begin(), list.end(), last) = id;
+            }
+        }
+
+        boxes.pop_back();
+        neighbours.pop_back();
+
+        inserted = (int) boxes.size();
+    }
+
+    /// Number of bodies in the broadphase.
+
+    int bodies() const
+    {
+        return (int) boxes.size();
+    }
+
+    /// Get the current set of overlapping pairs.
+    /// Pairs are in order of a then b, so iterating them is deterministic.
+
+    void pairs(std::vector<Pair> &output)
+    {
+        flush();
+
+        output.clear();
+        for (std::set<unsigned long long>::const_iterator i = overlaps.begin(); i!=overlaps.end(); ++i)
+        {
+            Pair pair;
+            pair.a = (int) (*i >> 32);
+            pair.b = (int) (*i & 0xFFFFFFFF);
+            output.push_back(pair);
+        }
+    }
+
+    /// Get the bodies overlapping a body, in no particular order.
+
+    const std::vector<int>& overlapping(int id)
+    {
+        assert(id>=0 && id<(int)boxes.size());
+
+        if (inserted<(int)boxes.size())
+            flush();
+
+        return neighbours[id];
+    }
+
+    /// Find the bodies whose bounding boxes overlap a box.
+    /// The boxes are as of the last add or update of each body.
+    /// @param ids receives the ids in increasing order.
+
+    void query(const Vector &min, const Vector &max, std::vector<int> &ids) const
+    {
+        Box box;
+        box.min[0] = min.x;
+        box.min[1] = min.y;
+        box.min[2] = min.z;
+        box.max[0] = max.x;
+        box.max[1] = max.y;
+        box.max[2] = max.z;
+
+        ids.clear();
+        for (int i=0; i<(int)boxes.size(); i++)
+        {
+            if (overlap(boxes[i], box))
+                ids.push_back(i);
+        }
+    }
+
+    /// Number of swaps performed by updates so far.
+    /// Useful for checking that temporal coherence is being exploited.
+
+    unsigned int swaps() const
+    {
+        return swapCount;
+    }
+
+    Broadphase()
+    {
+        inserted = 0;
+        removed = 0;
+        swapCount = 0;
+    }
+
+private:
+
+    /// An endpoint on one axis. data is the body id shifted left one, with the low bit set for max endpoints.
+
+    struct Endpoint
+    {
+        float value;
+        int data;
+    };
+
+    enum { Removed = -1 };                      ///< endpoint data of a removed body until the next flush.
+
+    /// Bounding box of a body and the indices of its endpoints on each axis.
+
+    struct Box
+    {
+        float min[3];
+        float max[3];
+        int index[3][2];
+    };
+
+    /// Test if two boxes overlap on all axes.
+
+    bool overlap(const Box &a, const Box &b) const
+    {
+        return a.min[0]<b.max[0] && b.min[0]<a.max[0] &&
+               a.min[1]<b.max[1] && b.min[1]<a.max[1] &&
+               a.min[2]<b.max[2] && b.min[2]<a.max[2];
+    }
+
+    /// Pair key, the lower id in the high 32 bits.
+
+    static unsigned long long key(int a, int b)
+    {
+        assert(a!=b);
+        return a<b ? ((unsigned long long) a << 32) | (unsigned int) b : ((unsigned long long) b << 32) | (unsigned int) a;
+    }
+
+    /// Record a new overlapping pair.
+
+    void addPair(int a, int b)
+    {
+        if (overlaps.insert(key(a, b)).second)
+        {
+            neighbours[a].push_back(b);
+            neighbours[b].push_back(a);
+        }
+    }
+
+    /// Forget an overlapping pair.
+
+    void removePair(int a, int b)
+    {
+        if (!overlaps.erase(key(a, b)))
+            return;
+
+        unlink(a, b);
+        unlink(b, a);
+    }
+
+    /// Take a body out of the neighbour list of another.
+
+    void unlink(int id, int other)
+    {
+        std::vector<int> &list = neighbours[id];
+        *std::find(list.begin(), list.end(), other) = list.back();
+        list.pop_back();
+    }
+
+    /// Apply the adds and removes since the last call to the sorted axes, and find the pairs of the added bodies.
+    ///
+    /// The endpoints of removed bodies are compacted out of each axis and the new
+    /// endpoints sorted and merged in, all in one pass, with new endpoints going after
+    /// any that compare equal just as sorting them in one at a time would leave them.
+    /// The new pairs are then found by a sweep along the merged x axis that keeps the
+    /// boxes open at each point, split into old and new bodies: a new box is tested
+    /// against every open box and an old box only against the open new boxes, as pairs
+    /// of old bodies are known already.
+
+    void flush()
+    {
+        const int count = (int) boxes.size();
+
+        if (inserted==count && removed==0)
+            return;
+
+        for (int axis=0; axis<3; axis++)
+        {
+            std::vector<Endpoint> &list = endpoints[axis];
+
+            if (removed)
+            {
+                int kept = 0;
+                for (unsigned int i=0; i<list.size(); i++)
+                {
+                    if (list[i].data!=Removed)
+                        list[kept++] = list[i];
+                }
+                list.resize(kept);
+            }
+
+            if (inserted==count)
+            {
+                for (int i=0; i<(int)list.size(); i++)
+                    boxes[list[i].data >> 1].index[axis][list[i].data & 1] = i;
+                continue;
+            }
+
+            std::vector<Endpoint> added;
+            added.reserve((count - inserted) * 2);
+
+            for (int id=inserted; id<count; id++)
+            {
+                const Endpoint lower = { boxes[id].min[axis], id << 1 };
+                const Endpoint upper = { boxes[id].max[axis], (id << 1) | 1 };
+                added.push_back(lower);
+                added.push_back(upper);
+            }
+
+            std::stable_sort(added.begin(), added.end(), less);
+
+            std::vector<Endpoint> merged(list.size() + added.size());
+            std::merge(list.begin(), list.end(), added.begin(), added.end(), merged.begin(), less);
+            list.swap(merged);
+
+            for (int i=0; i<(int)list.size(); i++)
+                boxes[list[i].data >> 1].index[axis][list[i].data & 1] = i;
+        }
+
+        removed = 0;
+
+        if (inserted==count)
+            return;
+
+        std::vector<int> open[2];
+        std::vector<int> position(count);
+
+        const std::vector<Endpoint> &list = endpoints[0];
+
+        for (unsigned int i=0; i<list.size(); i++)
+        {
+            const int id = list[i].data >> 1;
+            const int fresh = id>=inserted ? 1 : 0;
+
+            if (list[i].data & 1)
+            {
+                std::vector<int> &bodies = open[fresh];
+                const int moved = bodies.back();
+                bodies[position[id]] = moved;
+                position[moved] = position[id];
+                bodies.pop_back();
+                continue;
+            }
+
+            for (int k=1-fresh; k<2; k++)
+            {
+                for (unsigned int j=0; j<open[k].size(); j++)
+                {
+                    if (overlap(boxes[open[k][j]], boxes[id]))
+                        addPair(open[k][j], id);
+                }
+            }
+
+            position[id] = (int) open[fresh].size();
+            open[fresh].push_back(id);
+        }
+
+        inserted = count;
+    }
+
+    /// Swap endpoint i with endpoint i+1 on an axis, the endpoint at i+1 is moving down.
+    /// Updates the pair set when a min endpoint passes a max endpoint or vice versa.
+
+    void swap(int axis, int i)
+    {
+        std::vector<Endpoint> &list = endpoints[axis];
+
+        Endpoint &lower = list[i];
+        Endpoint &upper = list[i+1];
+
+        const int lowerId = lower.data >> 1;
+        const int upperId = upper.data >> 1;
+
+        const bool lowerMax = (lower.data & 1)!=0;
+        const bool upperMax = (upper.data & 1)!=0;
+
+        if (lowerId!=upperId)
+        {
+            if (!upperMax && lowerMax)
+            {
+                // min of upper body moving below max of lower body: may start overlapping
+
+                if (overlap(boxes[lowerId], boxes[upperId]))
+                    addPair(lowerId, upperId);
+            }
+            else if (upperMax && !lowerMax)
+            {
+                // max of upper body moving below min of lower body: stopped overlapping
+
+                removePair(lowerId, upperId);
+            }
+        }
+
+        boxes[lowerId].index[axis][lower.data & 1] = i + 1;
+        boxes[upperId].index[axis][upper.data & 1] = i;
+
+        const Endpoint temp = lower;
+        lower = upper;
+        upper = temp;
+
+        swapCount++;
+    }
+
+    /// Endpoint ordering. Max endpoints sort before min endpoints of equal value,
+    /// so that boxes which only touch are not overlapping in the sorted order,
+    /// consistent with the strict test in overlap.
+
+    static bool less(const Endpoint &a, const Endpoint &b)
+    {
+        return a.value<b.value || (a.value==b.value && (a.data & 1) && !(b.data & 1));
+    }
+
+    /// Move endpoint at index i down the axis until it is in order.
+
+    void sortDown(int axis, int i)
+    {
+        std::vector<Endpoint> &list = endpoints[axis];
+        while (i>0 && less(list[i], list[i-1]))
+        {
+            swap(axis, i-1);
+            i--;
+        }
+    }
+
+    /// Move endpoint at index i up the axis until it is in order.
+
+    void sortUp(int axis, int i)
+    {
+        std::vector<Endpoint> &list = endpoints[axis];
+        const int last = (int) list.size() - 1;
+        while (i<last && less(list[i+1], list[i]))
+        {
+            swap(axis, i);
+            i++;
+        }
+    }
+
+    std::vector<Box> boxes;                     ///< bounding box of each body indexed by id.
+    std::vector<Endpoint> endpoints[3];         ///< sorted endpoints on each axis.
+    std::set<unsigned long long> overlaps;      ///< keys of all overlapping pairs.
+    std::vector< std::vector<int> > neighbours; ///< bodies overlapping each body, indexed by id.
+    int inserted;                               ///< number of bodies in the sorted axes, the bodies after them were added since, see flush.
+    int removed;                                ///< number of bodies removed since the last flush.
+    unsigned int swapCount;                     ///< total number of endpoint swaps.
+};
@@ -1,51 +1,340 @@
-/// Client.
-/// Represents the local scene on the client.
-/// The client is complex because it implements client side prediction
-/// and correction, eg. 'correction in the past' via the history buffer.
-/// Otherwise this is a simple scene driven from the keyboard input of the
-/// player.
-/// Press F1 to toggle visualization of the client cube.
-
-struct Client : public Scene
-{
-    /// default constructor.
-
-    Client()
-    {
-        log("client.log");
-
-        smoothed.r = 0.8f;
-        smoothed.g = 0.4f;
-        smoothed.b = 0.3f;
-    }
-
-    void update(unsigned int t)
-    {
-        // add to history
-
-        Move move;
-        move.time = t;
-        move.input = input;
-        move.state = cube.state();
-
-        history.add(move);
-
-        // update scene
-
-        Scene::update(t);
-    }
-
-    /// synchronize client with server
-
-    void synchronize(unsigned int t, const Cube::State &state, const Cube::Input &input)
-    {
-        Cube::State original = cube.state();
-
-        history.correction(*this, t, state, input);
-
-        if (original.compare(cube.state()))
-            smooth();
-    }
-
-    History history;        ///< client side history of moves
-};
+/// Client.
+/// Represents the local scene on the client.
+/// The client is complex because it implements client side prediction
+/// and correction, eg. 'correction in the past' via the history buffer.
+/// Otherwise this is a simple scene driven from the keyboard input of the
+/// player.
+/// Press F1 to toggle visualization of the client cube.
+
+struct Client : public Scene
+{
+    /// default constructor.
+
+    Client()
+    {
+        log("client.log");
+
+        smoothed(player).r = 0.8f;
+        smoothed(player).g = 0.4f;
+        smoothed(player).b = 0.3f;
+
+        pending = false;
+        pendingTime = 0;
+        correctedTime = 0;
+        coalesced = 0;
+
+        replayBudget = 0;
+        replayMargin = 2.0f;
+        replayActive = false;
+    }
+
+    void update(unsigned int t)
+    {
+        // add to history
+
+        Move move;
+        move.time = t;
+        move.input = input(player);
+        move.state = cube(player).state();
+
+        history.add(move);
+
+        // update scene
+
+        Scene::update(t);
+    }
+
+    /// synchronize client with server.
+    /// with a replay budget the correction is replayed over the next frames, and with
+    /// the replay thread started it is replayed on the thread, see correct.
+
+    void synchronize(unsigned int t, const Cube::State &state, const Cube::Input &input)
+    {
+        if (replayThread.running())
+        {
+            // a correction arriving during a threaded replay waits for it to finish
+
+            if (replayThread.busy())
+            {
+                receive(t, state, input);
+                return;
+            }
+
+            correctedTime = t;
+
+            replayActive = false;
+
+            beginReplay(t, state, input);
+
+            return;
+        }
+
+        correctedTime = t;
+
+        if (replayBudget>0)
+        {
+            // a newer correction replaces any replay in progress
+
+            replayActive = false;
+
+            if (rewindReplay(t, state, input))
+                continueReplay();
+
+            return;
+        }
+
+        Cube::State original = cube(player).state();
+
+        history.correction(*this, t, state, input);
+
+        if (original.compare(cube(player).state()))
+            smooth();
+    }
+
+    /// Receive a correction from the server without applying it yet.
+    /// Only the newest correction received is kept, see correct. Corrections
+    /// older than one already kept or applied are stale and discarded.
+
+    void receive(unsigned int t, const Cube::State &state, const Cube::Input &input)
+    {
+        if ((pending && t<=pendingTime) || t<correctedTime)
+        {
+            coalesced++;
+            return;
+        }
+
+        if (pending)
+            coalesced++;
+
+        pending = true;
+        pendingTime = t;
+        pendingState = state;
+        pendingInput = input;
+    }
+
+    /// Apply the newest correction received since the last call, if any.
+    /// Call once per frame: when packets arrive bunched up the client rewinds
+    /// and replays once from the newest server state instead of once per packet.
+    /// While a budgeted replay is in progress this continues it instead, and
+    /// corrections received meanwhile wait until it has finished. The same goes
+    /// for a threaded replay, except that this only checks whether the thread has
+    /// finished and never waits for it.
+
+    void correct()
+    {
+        if (replayThread.busy())
+        {
+            if (!replayThread.finished())
+                return;
+
+            finishReplay();
+        }
+
+        if (replayActive)
+        {
+            continueReplay();
+            return;
+        }
+
+        if (!pending)
+            return;
+
+        pending = false;
+
+        synchronize(pendingTime, pendingState, pendingInput);
+    }
+
+    History history;        ///< client side history of moves
+
+    unsigned int coalesced; ///< corrections received that were discarded for a newer one without being applied.
+
+    int replayBudget;       ///< most steps a correction replays per frame, zero to replay each correction all at once (default). must be more than the steps per frame for a replay to catch up. call shareLevel after setting it.
+
+    float replayMargin;     ///< how far a cube replayed over several frames or on the replay thread may stray from its predicted path and still collide with the props, see rewindReplay.
+
+    /// Returns true if a correction is being replayed over several frames or on the replay thread.
+
+    bool replayInProgress() const
+    {
+        return replayActive || replayThread.busy();
+    }
+
+    /// Give the scene that corrections replay on over several frames or on the replay
+    /// thread the level of this scene: it shares the world and takes a copy of the terrain
+    /// now, so call this again after changing the world or the terrain.
+
+    void shareLevel()
+    {
+        replay.scene.world.share(world);
+        replay.scene.terrain = terrain;
+    }
+
+    /// Replay corrections on a background thread so that the main loop never waits for them.
+    /// The thread replays on its own scene, see shareLevel, which is called here.
+    /// The replay does not see props added or moved after the correction is received.
+
+    void startReplayThread()
+    {
+        stopReplayThread();
+
+        shareLevel();
+
+        replayThread.start();
+    }
+
+    /// Stop the replay thread, finishing any replay in progress first.
+    /// Corrections are replayed on the main thread again afterwards.
+
+    void stopReplayThread()
+    {
+        replayThread.stop();
+
+        if (replayThread.finished())
+            finishReplay();
+    }
+
+private:
+
+    /// A correction replayed over several frames or on the replay thread, on a scene of its own.
+    /// The thread owns it while a threaded replay is running.
+
+    struct Replay
+    {
+        Scene scene;                            ///< scene the replay runs on, see rewindReplay.
+        std::vector<Entities::Handle> props;    ///< handles of the props copied into the replay scene.
+        std::vector<Move> moves;                ///< moves to replay when the correction was received, the replay thread stores their corrected states in place.
+        unsigned int steps;                     ///< scene updates done by a threaded replay.
+    };
+
+    /// Check a correction and, if it is significant, set the replay scene up to replay it.
+    /// The replay scene gets the player cube rewound to the correction and the props near
+    /// the path of the moves to replay, see Scene::prepareReplay, so nothing else of this
+    /// scene is copied. The props are found within replayMargin of the predicted path.
+    /// @returns true if the correction must be replayed.
+
+    bool rewindReplay(unsigned int t, const Cube::State &state, const Cube::Input &input)
+    {
+        if (!history.check(t, state))
+            return false;
+
+        history.replayMoves(replay.moves);
+
+        Vector min = state.position;
+        Vector max = state.position;
+
+        for (unsigned int i=0; i<replay.moves.size(); i++)
+        {
+            const Vector &position = replay.moves[i].state.position;
+            min = Vector(Mathematics::minimum(min.x, position.x), Mathematics::minimum(min.y, position.y), Mathematics::minimum(min.z, position.z));
+            max = Vector(Mathematics::maximum(max.x, position.x), Mathematics::maximum(max.y, position.y), Mathematics::maximum(max.z, position.z));
+        }
+
+        const float margin = cube(player).properties.size * 0.87f + contactMargin + replayMargin;
+        min -= Vector(margin, margin, margin);
+        max += Vector(margin, margin, margin);
+
+        Scene &scene = replay.scene;
+
+        scene.prepareReplay(*this, min, max, replay.props);
+
+        scene.time = t;
+        scene.input(scene.player) = input;
+        scene.cube(scene.player).snap(state);
+
+        return true;
+    }
+
+    /// Continue a budgeted replay.
+    /// This scene keeps predicting with the old timeline until the replay catches
+    /// up, then its cube switches over to the replayed cube and smoothing covers the jump.
+
+    void continueReplay()
+    {
+        if (!history.replay(replay.scene, replayBudget))
+        {
+            replayActive = true;
+            return;
+        }
+
+        replayActive = false;
+
+        const Cube::State original = cube(player).state();
+
+        cube(player) = replay.scene.cube(replay.scene.player);
+        acceptReplay(replay.scene, replay.props);
+
+        if (original.compare(cube(player).state()))
+            smooth();
+    }
+
+    /// Start replaying a correction on the replay thread, if it is significant.
+    /// Only the replay scene is set up here, see rewindReplay, the thread does the rest.
+
+    void beginReplay(unsigned int t, const Cube::State &state, const Cube::Input &input)
+    {
+        if (!rewindReplay(t, state, input))
+            return;
+
+        replay.steps = 0;
+
+        replayThread.begin(replayThreadJob, &replay);
+    }
+
+    /// Replay thread job: replay the moves on the rewound replay scene,
+    /// as History::replay does, up to the time of the last move.
+
+    static void replayThreadJob(void *data, int)
+    {
+        Replay &job = *(Replay*) data;
+
+        Scene &scene = job.scene;
+
+        scene.replaying = true;
+
+        for (unsigned int i=0; i<job.moves.size(); i++)
+        {
+            while (scene.time<job.moves[i].time)
+            {
+                scene.update(scene.time);
+                job.steps++;
+            }
+
+            scene.input(scene.player) = job.moves[i].input;
+            job.moves[i].state = scene.cube(scene.player).state();
+        }
+
+        scene.replaying = false;
+    }
+
+    /// Finish a threaded replay once the thread is done with it.
+    /// The replay scene first replays the few moves added while the thread was running,
+    /// as a budgeted replay does when it catches up, then the cube switches over to the
+    /// replayed cube and smoothing covers the jump.
+
+    void finishReplay()
+    {
+        history.replayed(replay.moves);
+        history.counters.replayedSteps += replay.steps;
+
+        history.replay(replay.scene, 0);
+
+        const Cube::State original = cube(player).state();
+
+        cube(player) = replay.scene.cube(replay.scene.player);
+        acceptReplay(replay.scene, replay.props);
+
+        if (original.compare(cube(player).state()))
+            smooth();
+    }
+
+    Replay replay;                  ///< a budgeted replay in progress between frames, or the correction being replayed on the replay thread.
+    bool replayActive;              ///< true if a budgeted replay is in progress.
+
+    bool pending;                   ///< true if a correction has been received but not applied.
+    unsigned int pendingTime;       ///< time of the pending correction.
+    Cube::State pendingState;       ///< server state of the pending correction.
+    Cube::Input pendingInput;       ///< server input of the pending correction.
+    unsigned int correctedTime;     ///< time of the last correction applied.
+
+    Background replayThread;        ///< thread replaying corrections, not started by default. declared last so it stops before the replay is destroyed.
+};
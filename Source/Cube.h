@@ -1,653 +1,2507 @@
-/// A cube with self contained physics simulation.
-///
-/// This class is responsible for maintaining and integrating its
-/// physics state using an RK4 integrator. The nature of the
-/// integrator requires that we structure this class in such a
-/// way that all forces can be calculated from the current physics
-/// state at any time. See Cube::integrate for details.
-
-class Cube
-{
-public:
-
-    /// Cube color
-
-    float r,g,b,a;
-
-    /// Input data.
-
-    struct Input
-    {
-        bool left;
-        bool right;
-        bool forward;
-        bool back;
-        bool jump;
-    };
-
-    /// Physics state.
-    
-    struct State
-    {
-        /// primary physics state
-
-        Vector position;                ///< the position of the cube center of mass in world coordinates (meters).
-        Vector momentum;                ///< the momentum of the cube in kilogram meters per second.
-        Quaternion orientation;         ///< the orientation of the cube represented by a unit quaternion.
-        Vector angularMomentum;         ///< angular momentum vector.
-
-        // secondary state
-
-        Vector velocity;                ///< velocity in meters per second (calculated from momentum).
-        Quaternion spin;                ///< quaternion rate of change in orientation.
-        Vector angularVelocity;         ///< angular velocity (calculated from angularMomentum).
-        Matrix bodyToWorld;             ///< body to world coordinates matrix.
-        Matrix worldToBody;             ///< world to body coordinates matrix.
-
-        /// constant state
-
-        float size;                     ///< length of the cube sides in meters.
-        float mass;                     ///< mass of the cube in kilograms.
-        float inverseMass;              ///< inverse of the mass used to convert momentum to velocity.
-        float inertiaTensor;            ///< inertia tensor of the cube (i have simplified it to a single value due to the mass properties a cube).
-        float inverseInertiaTensor;     ///< inverse inertia tensor used to convert angular momentum to angular velocity.
-
-        /// Recalculate secondary state values from primary values.
-
-        void recalculate()
-        {
-            assert(position==position);
-            assert(momentum==momentum);
-            assert(orientation==orientation);
-            assert(angularMomentum==angularMomentum);
-
-            velocity = momentum * inverseMass;
-            angularVelocity = angularMomentum * inverseInertiaTensor;
-            orientation.normalize();
-            spin = 0.5 * Quaternion(0, angularVelocity.x, angularVelocity.y, angularVelocity.z) * orientation;
-            Matrix translation;
-            translation.translate(position);
-            bodyToWorld = translation * orientation.matrix();
-            worldToBody = bodyToWorld.inverse();
-        }
-
-        /// equality operator (primary quantities only)
-
-        bool operator==(const State &other) const
-        {
-            return position==other.position && orientation==other.orientation && 
-                momentum==other.momentum && angularMomentum==other.angularMomentum;
-        }
-
-        /// inequality operator (primary quantities only)
-
-        bool operator!=(const State &other) const
-        {
-            return !(*this==other);
-        }
-
-        /// compare with another physics state for "significant" differences.
-        /// used for detecting position or orientation snaps which need smoothing.
-
-        bool compare(const State &other) const
-        {
-            const float threshold = 0.1f * 0.1f;
-
-            return (other.position-position).lengthSquared()>threshold || 
-                (other.orientation-orientation).norm()>threshold;
-        }
-    };
-
-    /// Default constructor.
-	
-	Cube()
-	{
-		current.size = 1;
-		current.mass = 1;
-		current.inverseMass = 1.0f / current.mass;
-		current.position = Vector(0,40,0);
-		current.momentum = Vector(0,0,0);
-		current.orientation.identity();
-		current.angularMomentum = Vector(0,0,0);
-		current.inertiaTensor = current.mass * current.size * current.size * 1.0f / 6.0f;
-		current.inverseInertiaTensor = 1.0f / current.inertiaTensor;
-		current.recalculate();
-		
-		previous = current;
-
-        r = g = b = a = 1;
-	}
-
-    /// Update physics state.
-    /// @param input the current input data.
-    /// @param planes the set of world collision planes to collide against.
-    /// @param dt delta time to advance ahead in seconds.
-
-    void update(const Input &input, const std::vector<Plane> &planes, float dt)
-    {
-        previous = current;
-        integrate(input, planes, current, dt);
-    }
-
-    /// Smooth physics state towards target.
-
-    void smooth(const State &target, float tightness)
-    {
-        previous = current;
-        current = target;
-        current.position = previous.position + (target.position-previous.position) * tightness;
-        current.orientation = slerp(previous.orientation, target.orientation, tightness);
-        current.recalculate();
-    }
-
-    /// Render cube at interpolated state.
-    /// Calculates interpolated state then renders cube at the interpolated 
-	/// position and orientation using OpenGL.
-	/// @param alpha interpolation alpha in [0,1]
-
-    void render(const Vector &light, float alpha = 1.0f)
-	{	
-		glPushMatrix();
-
-		State state = interpolate(previous, current, alpha);
-		
-		glTranslatef(state.position.x, state.position.y, state.position.z); 
-		
-		float angle;
-		Mathematics::Vector axis;		
-		state.orientation.angleAxis(angle, axis);
-		glRotatef(angle/Mathematics::pi*180, axis.x, axis.y, axis.z);
-		
-        // render cube
-
-        GLfloat color[] = { r, g, b, a };
-
-		glMaterialfv(GL_FRONT, GL_AMBIENT, color);
-		glMaterialfv(GL_FRONT, GL_DIFFUSE, color);
-		
-		glEnable(GL_LIGHTING);
-		
-        if (a!=1.0f)
-        {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        }
-
-        glDepthFunc(GL_ALWAYS);
-
-        const float s = state.size * 0.5f;
-
-        glBegin(GL_QUADS);
-		
-			glNormal3f(0,0,+1);
-			glVertex3f(-s,-s,+s);
-			glVertex3f(+s,-s,+s);
-			glVertex3f(+s,+s,+s);
-			glVertex3f(-s,+s,+s);
-
-			glNormal3f(0,0,-1);
-			glVertex3f(-s,-s,-s);
-			glVertex3f(-s,+s,-s);
-			glVertex3f(+s,+s,-s);
-			glVertex3f(+s,-s,-s);
-			
-			glNormal3f(0,+1,0);
-			glVertex3f(-s,+s,-s);
-			glVertex3f(-s,+s,+s);
-			glVertex3f(+s,+s,+s);
-			glVertex3f(+s,+s,-s);
-			
-			glNormal3f(0,-1,0);
-			glVertex3f(-s,-s,-s);
-			glVertex3f(+s,-s,-s);
-			glVertex3f(+s,-s,+s);
-			glVertex3f(-s,-s,+s);
-
-			glNormal3f(+1,0,0);
-			glVertex3f(+s,-s,-s);
-			glVertex3f(+s,+s,-s);
-			glVertex3f(+s,+s,+s);
-			glVertex3f(+s,-s,+s);
-			
-			glNormal3f(-1,0,0);
-			glVertex3f(-s,-s,-s);
-			glVertex3f(-s,-s,+s);
-			glVertex3f(-s,+s,+s);
-			glVertex3f(-s,+s,-s);
-			
-		glEnd();
-
-        glDepthFunc(GL_LEQUAL);
-
-        glDisable(GL_BLEND);
-		glDisable(GL_LIGHTING);
-
-        // render shadow volume
-
-        if (a==1.0f)
-        {
-            // enter state for rendering shadow volumes to stencil
-
-            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-            glDepthMask(GL_FALSE);
-            
-            glEnable(GL_STENCIL_TEST);
-
-            Vector bodySpaceLight = state.worldToBody * light;
-
-            // render front faces
-
-            glStencilFunc(GL_ALWAYS, 0x0, 0xff);
-            glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
-
-            renderShadowVolume(state, bodySpaceLight);
-
-            // render shadow volume back faces
-
-            glCullFace(GL_FRONT);
-            glStencilFunc(GL_ALWAYS, 0x0, 0xff);
-            glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
-            
-            renderShadowVolume(state, bodySpaceLight);
-
-            // restore normal rendering state
-
-            glCullFace(GL_BACK);
-            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-            glDepthMask(GL_TRUE);
-
-            glDisable(GL_STENCIL_TEST);
-        }
-
-		glPopMatrix();
-	}
-
-    void snap(const State &state)
-    {
-        current = state;
-        previous = state;
-    }
-
-    const State &state() const
-    {
-        return current;
-    }
-	
-private:
-
-    /// render shadow volume
-
-    static void renderShadowVolume(const State &state, const Vector &light)
-    {
-        glBegin(GL_QUADS);
-
-        const float s = state.size * 0.5f;
-
-        silhouette(light, Vector(-s,+s,-s), Vector(+s,+s,-s));
-        silhouette(light, Vector(+s,+s,-s), Vector(+s,+s,+s));
-        silhouette(light, Vector(+s,+s,+s), Vector(-s,+s,+s));
-        silhouette(light, Vector(-s,+s,+s), Vector(-s,+s,-s));
-
-        silhouette(light, Vector(-s,-s,-s), Vector(+s,-s,-s));
-        silhouette(light, Vector(+s,-s,-s), Vector(+s,-s,+s));
-        silhouette(light, Vector(+s,-s,+s), Vector(-s,-s,+s));
-        silhouette(light, Vector(-s,-s,+s), Vector(-s,-s,-s));
-
-        silhouette(light, Vector(-s,+s,-s), Vector(-s,-s,-s));
-        silhouette(light, Vector(+s,+s,-s), Vector(+s,-s,-s));
-        silhouette(light, Vector(+s,+s,+s), Vector(+s,-s,+s));
-        silhouette(light, Vector(-s,+s,+s), Vector(-s,-s,+s));
-
-        glEnd();
-    }
-
-    /// test and render edge a-b if its a silhouette edge relative to light
-
-    static void silhouette(const Vector &light, Vector a, Vector b)
-    {
-        // determine edge normals
-
-        Vector midpoint = (a + b) * 0.5f;
-        
-        Vector leftNormal;
-
-        if (midpoint.x!=0)
-            leftNormal = Vector(midpoint.x, 0, 0);
-        else
-            leftNormal = Vector(0, midpoint.y, 0);
-
-        Vector rightNormal = midpoint - leftNormal;
-
-        // check if silhouette edge
-
-        const Vector differenceA = a - light;
-
-        const float leftDot = leftNormal.dot(differenceA);
-        const float rightDot = rightNormal.dot(differenceA);
-
-        if ((leftDot<0 && rightDot>0) || (leftDot>0 && rightDot<0))
-        {
-            // extrude quad
-
-            const Vector differenceB = b - light;
-
-            Vector _a = a + differenceA * 100;
-            Vector _b = b + differenceB * 100;
-
-            // ensure correct winding order for silhouette edge
-
-            const Vector cross = (b - a).cross(differenceA);
-            
-            if (cross.dot(a)<0)
-            {
-                Vector t = a;
-                a = b;
-                b = t;
-
-                t = _a;
-                _a = _b;
-                _b = t;
-            }
-
-            // render extruded quad
-
-            glVertex3f(a.x, a.y, a.z); 
-            glVertex3f(b.x, b.y, b.z);
-            glVertex3f(_b.x, _b.y, _b.z);
-            glVertex3f(_a.x, _a.y, _a.z); 
-        }
-    }
-
-    /// Interpolate between two physics states.
-	
-	static State interpolate(const State &a, const State &b, float alpha)
-	{
-		State state = b;
-		state.position = a.position*(1-alpha) + b.position*alpha;
-		state.momentum = a.momentum*(1-alpha) + b.momentum*alpha;
-		state.orientation = slerp(a.orientation, b.orientation, alpha);
-		state.angularMomentum = a.angularMomentum*(1-alpha) + b.angularMomentum*alpha;
-		state.recalculate();
-		return state;
-	}
-
-	State previous;		///< previous physics state.
-    State current;		///< current physics state.
-
-    /// Derivative values for primary state.
-    /// This structure stores all derivative values for primary state in Cube::State.
-    /// For example velocity is the derivative of position, force is the derivative
-    /// of momentum etc. Storing all derivatives in this structure makes it easy
-    /// to implement the RK4 integrator cleanly because it needs to calculate the
-    /// and store derivative values at several points each timestep.
-
-	struct Derivative
-	{
-		Vector velocity;                ///< velocity is the derivative of position.
-		Vector force;                   ///< force in the derivative of momentum.
-		Quaternion spin;                ///< spin is the derivative of the orientation quaternion.
-		Vector torque;                  ///< torque is the derivative of angular momentum.
-	};	
-
-    /// Evaluate all derivative values for the physics state at time t.
-    /// @param input the current input data.
-    /// @param planes the set of all collision planes in the scene.
-    /// @param state the physics state of the cube.
-
-	static Derivative evaluate(const Input &input, const std::vector<Plane> &planes, const State &state)
-	{
-		Derivative output;
-		output.velocity = state.velocity;
-		output.spin = state.spin;
-		forces(input, planes, state, output.force, output.torque);
-		return output;
-	}
-	
-    /// Evaluate derivative values for the physics state at future time t+dt 
-    /// using the specified set of derivatives to advance dt seconds from the 
-    /// specified physics state.
-    /// @param input the current input data.
-    /// @param planes the set of all collision planes in the scene.
-    /// @param state the physics state of the cube at the start of the timestep.
-    /// @param dt the time in seconds to advance forward.
-    /// @param derivative the set of derivative values to use to advance forward in time from state.
-
-	static Derivative evaluate(const Input &input, const std::vector<Plane> &planes, State state, float dt, const Derivative &derivative)
-	{
-		state.position += derivative.velocity * dt;
-		state.momentum += derivative.force * dt;
-		state.orientation += derivative.spin * dt;
-		state.angularMomentum += derivative.torque * dt;
-		state.recalculate();
-		
-		Derivative output;
-		output.velocity = state.velocity;
-		output.spin = state.spin;
-		forces(input, planes, state, output.force, output.torque);
-		return output;
-	}
-
-    /// Integrate physics state forward by dt seconds.
-    /// Uses an RK4 integrator to accurately numerically integrate with error O(5).
-    /// This involves evaluating derivatives at multiple points in the timestep
-    /// using the Cube::evaluate method then updating the primary state values as 
-    /// a weighted sum of these values then finally recalculating secondary state.
-
-	static void integrate(const Input &input, const std::vector<Plane> &planes, State &state, float dt)
-	{
-		Derivative a = evaluate(input, planes, state);
-		Derivative b = evaluate(input, planes, state, dt*0.5f, a);
-		Derivative c = evaluate(input, planes, state, dt*0.5f, b);
-		Derivative d = evaluate(input, planes, state, dt, c);
-		
-		state.position += 1.0f/6.0f * dt * (a.velocity + 2.0f*(b.velocity + c.velocity) + d.velocity);
-		state.momentum += 1.0f/6.0f * dt * (a.force + 2.0f*(b.force + c.force) + d.force);
-		state.orientation += 1.0f/6.0f * dt * (a.spin + 2.0f*(b.spin + c.spin) + d.spin);
-		state.angularMomentum += 1.0f/6.0f * dt * (a.torque + 2.0f*(b.torque + c.torque) + d.torque);
-		state.recalculate();
-	}	
-
-    /// Calculate force and torque for physics state at time t.
-    /// Due to the way that the RK4 integrator works we need to calculate
-    /// force implicitly from state rather than explictly applying forces
-    /// to the rigid body once per update. This is because the RK4 achieves
-    /// its accuracy by detecting curvature in derivative values over the 
-    /// timestep so we need our force values to supply the curvature.
-
-	static void forces(const Input &input, const std::vector<Plane> &planes, const State &state, Vector &force, Vector &torque)
-	{
-		force.zero();
-		torque.zero();
-		
-		gravity(force);
-        damping(state, force, torque);
-        collision(planes, state, force, torque);
-        control(input, state, force, torque);
-
-        assert(force==force);
-        assert(torque==torque);
-	}
-
-    /// Calculate gravity force.
-    /// @param force the force accumulator.
-
-	static void gravity(Vector &force)
-	{
-		force.y -= 9.8f;
-	}
-	
-    /// Calculate a simple linear and angular damping force.
-    /// This roughly simulates energy loss due to heat dissipation
-    /// or air resistance or whatever you like.
-    /// @param state the current cube physics state.
-    /// @param force the force accumulator.
-    /// @param torque the torque accumulator.
-
-	static void damping(const State &state, Vector &force, Vector &torque)
-	{
-		const float linear = 0.001f;
-		const float angular = 0.001f;
-		
-		force -= linear * state.velocity;
-		torque -= angular * state.angularVelocity;
-	}
-
-    /// Calculate collision response force and torque.
-    ///
-    /// This is a very basic collision response implemented at the force
-    /// level by simply checking each vertex of the cube against each plane
-    /// in the scene. For each cube vertex that is inside a plane a set of
-    /// penalty forces and friction forces are applied to simulate collision
-    /// response. See Cube::collisionForPoint for details.
-    ///
-    /// @param planes the set of collision planes in the scene.
-    /// @param state the current cube physics state.
-    /// @param force the force accumulator.
-    /// @param torque the torque accumulator.
-
-    static void collision(const std::vector<Plane> &planes, const State &state, Vector &force, Vector &torque)
-	{
-		Vector a = state.bodyToWorld * (Vector(-1,-1,-1) * state.size * 0.5);
-		Vector b = state.bodyToWorld * (Vector(+1,-1,-1) * state.size * 0.5);
-		Vector c = state.bodyToWorld * (Vector(+1,+1,-1) * state.size * 0.5);
-		Vector d = state.bodyToWorld * (Vector(-1,+1,-1) * state.size * 0.5);
-		Vector e = state.bodyToWorld * (Vector(-1,-1,+1) * state.size * 0.5);
-		Vector f = state.bodyToWorld * (Vector(+1,-1,+1) * state.size * 0.5);
-		Vector g = state.bodyToWorld * (Vector(+1,+1,+1) * state.size * 0.5);
-		Vector h = state.bodyToWorld * (Vector(-1,+1,+1) * state.size * 0.5);
-		
-		for (unsigned int i=0; i<planes.size(); i++)
-		{
-			collisionForPoint(state, force, torque, a, planes[i]);
-			collisionForPoint(state, force, torque, b, planes[i]);
-			collisionForPoint(state, force, torque, c, planes[i]);
-			collisionForPoint(state, force, torque, d, planes[i]);
-			collisionForPoint(state, force, torque, e, planes[i]);
-			collisionForPoint(state, force, torque, f, planes[i]);
-			collisionForPoint(state, force, torque, g, planes[i]);
-			collisionForPoint(state, force, torque, h, planes[i]);
-		}
-	}
-	
-    /// Calculate collision response force and torque for a point against a plane.
-    ///
-    /// If the point is inside the plane then a penalty force is applied to push
-    /// the point out. A damping force is also applied to make the collision inelastic
-    /// otherwise the cube would bounce off plane without losing any energy.
-    ///
-    /// Velocity constraint forces are also applied when the point is inside the plane
-    /// and the point is moving further into the plane. This tightens up the collision
-    /// response from what would be achieved using penetration depth penalty forces
-    /// alone giving a more realistic result.
-    ///
-    /// An approximation of tangential friction force is also applied. This is not
-    /// true coulomb friction which would be proportional to the normal force between
-    /// the two objects, instead it is more of a rolling type friction proportional
-    /// to the tangential velocity between the two surfaces. This gives basically
-    /// correct effects.
-    ///
-    /// Finally please note that this collision response is very basic. The correct
-    /// way to implement this would be to develop a solver which could simultaneously
-    /// satisify a number of constaints. The tradeoff made here is that we allow some
-    /// softness in the collision response to make the calculations easier. This
-    /// small amount of give during collision lets us calculate collision response
-    /// easily without needing a complicated solver and without the jitter that you
-    /// normally see in an impulse based collision response.
-    ///
-    /// @param state the current cube physics state.
-    /// @param force the force accumulator.
-    /// @param torque the torque accumulator.
-    /// @param point the point to check for collision.
-    /// @param plane the collision plane.
-
-    static void collisionForPoint(const State &state, Vector &force, Vector &torque, const Vector &point, const Plane &plane)
-	{
-		const float c = 10;
-		const float k = 100;
-		const float b = 5;
-		const float f = 3;
-		
-		const float penetration = plane.constant - point.dot(plane.normal);
-		
-		if (penetration>0)
-		{
-			Vector velocity = state.angularVelocity.cross(point-state.position) + state.velocity;
-            assert(velocity==velocity);
-
-			const float relativeSpeed = - plane.normal.dot(velocity);
-            assert(relativeSpeed==relativeSpeed);
-			
-			if (relativeSpeed>0)
-			{
-				Vector collisionForce = plane.normal * (relativeSpeed * c);
-                assert(collisionForce==collisionForce);
-				force += collisionForce;
-				torque += (point-state.position).cross(collisionForce);
-            }
-			
-            Vector tangentialVelocity = velocity + (plane.normal * relativeSpeed);
-            Vector frictionForce = - tangentialVelocity * f;
-            assert(frictionForce==frictionForce);
-            force += frictionForce;
-            torque += (point-state.position).cross(frictionForce);
-
-            Vector penaltyForce = plane.normal * (penetration * k);
-            assert(penaltyForce==penaltyForce);
-			force += penaltyForce;
-			torque += (point-state.position).cross(penaltyForce);
-			
-			Vector dampingForce = plane.normal * (relativeSpeed * penetration * b);
-            assert(dampingForce==dampingForce);
-			force += dampingForce;
-			torque += (point-state.position).cross(dampingForce);
-		}
-	}
-
-    /// Control forces
-
-    static void control(const Input &input, const State &state, Vector &force, Vector &torque)
-    {
-        const float f = 50.0f;
-
-        if (input.left)
-            force.x -= f;
-
-        if (input.right)
-            force.x += f;
-
-        if (input.forward)
-            force.z -= f;
-
-        if (input.back)
-            force.z += f;
-
-        if (input.jump && state.velocity.y>=-0.1f)
-        {
-            const float j = 20;
-            const float k = 5;
-
-            const float difference = j - state.velocity.y;
-
-            Vector a = state.bodyToWorld * (Vector(-1,-1,-1) * state.size * 0.5);
-            Vector b = state.bodyToWorld * (Vector(+1,-1,-1) * state.size * 0.5);
-            Vector c = state.bodyToWorld * (Vector(+1,+1,-1) * state.size * 0.5);
-            Vector d = state.bodyToWorld * (Vector(-1,+1,-1) * state.size * 0.5);
-            Vector e = state.bodyToWorld * (Vector(-1,-1,+1) * state.size * 0.5);
-            Vector f = state.bodyToWorld * (Vector(+1,-1,+1) * state.size * 0.5);
-            Vector g = state.bodyToWorld * (Vector(+1,+1,+1) * state.size * 0.5);
-            Vector h = state.bodyToWorld * (Vector(-1,+1,+1) * state.size * 0.5);
-
-            float lowest = a.y;
-            if (b.y<lowest) lowest = b.y;
-            if (c.y<lowest) lowest = c.y;
-            if (d.y<lowest) lowest = d.y;
-            if (e.y<lowest) lowest = e.y;
-            if (f.y<lowest) lowest = f.y;
-            if (g.y<lowest) lowest = g.y;
-            if (h.y<lowest) lowest = h.y;
-
-            if (difference>0 && lowest<0.05f)
-                force.y += difference * k;
-        }
-    }
-};
+/// Cube types and force calculations.
+///
+/// Everything about a cube that does not depend on which force terms
+/// act on it: input, mass properties, physics state, and the individual
+/// force calculations that the force terms are built from. Cube types
+/// with different force terms all share these types, so their states
+/// can be stored in the same history and sent over the same network.
+
+class CubeBase
+{
+public:
+
+    /// Input data.
+
+    struct Input
+    {
+        bool left;
+        bool right;
+        bool forward;
+        bool back;
+        bool jump;
+    };
+
+    /// Mass properties.
+    /// These are constant for the lifetime of the cube so they are kept
+    /// out of the physics state stored in history and sent over the network.
+
+    struct Properties
+    {
+        float size;                     ///< length of the cube sides in meters.
+        float mass;                     ///< mass of the cube in kilograms.
+        float inverseMass;              ///< inverse of the mass used to convert momentum to velocity.
+        float inertiaTensor;            ///< inertia tensor of the cube (i have simplified it to a single value due to the mass properties a cube).
+        float inverseInertiaTensor;     ///< inverse inertia tensor used to convert angular momentum to angular velocity.
+
+        /// Set mass properties for a cube of given size and mass.
+
+        void set(float size, float mass)
+        {
+            this->size = size;
+            this->mass = mass;
+            inverseMass = 1.0f / mass;
+            inertiaTensor = mass * size * size * 1.0f / 6.0f;
+            inverseInertiaTensor = 1.0f / inertiaTensor;
+        }
+    };
+
+    /// Physics state.
+    /// Primary quantities only. This is what gets stored in the history
+    /// buffer and sent across the network, so keep it small. Everything that
+    /// can be derived from it lives in Cube::Secondary.
+    
+    struct State
+    {
+        Vector position;                ///< the position of the cube center of mass in world coordinates (meters).
+        Vector momentum;                ///< the momentum of the cube in kilogram meters per second.
+        Quaternion orientation;         ///< the orientation of the cube represented by a unit quaternion.
+        Vector angularMomentum;         ///< angular momentum vector.
+
+        /// equality operator (primary quantities only).
+        /// in deterministic mode both ends of the connection compute identical bits,
+        /// so any difference at all is a real misprediction and the comparison is exact.
+
+        bool operator==(const State &other) const
+        {
+            #ifdef DETERMINISTIC
+            float a[13], b[13];
+            values(a);
+            other.values(b);
+            for (int i=0; i<13; i++)
+                if (Mathematics::bits(a[i])!=Mathematics::bits(b[i]))
+                    return false;
+            return true;
+            #else
+            return position==other.position && orientation==other.orientation && 
+                momentum==other.momentum && angularMomentum==other.angularMomentum;
+            #endif
+        }
+
+        /// inequality operator (primary quantities only)
+
+        bool operator!=(const State &other) const
+        {
+            return !(*this==other);
+        }
+
+        /// compare with another physics state for "significant" differences.
+        /// used for detecting position or orientation snaps which need smoothing.
+
+        bool compare(const State &other) const
+        {
+            const float threshold = 0.1f * 0.1f;
+
+            return (other.position-position).lengthSquared()>threshold || 
+                (other.orientation-orientation).norm()>threshold;
+        }
+
+        /// hash the bits of the primary quantities (fnv-1a).
+        /// two states with the same hash are, for all practical purposes, bit identical,
+        /// which makes it cheap to check that two builds simulate exactly the same thing.
+
+        unsigned int hash() const
+        {
+            float value[13];
+            values(value);
+            unsigned int hash = 2166136261u;
+            for (int i=0; i<13; i++)
+            {
+                unsigned int bits = Mathematics::bits(value[i]);
+                for (int j=0; j<4; j++)
+                {
+                    hash ^= bits & 0xFF;
+                    hash *= 16777619u;
+                    bits >>= 8;
+                }
+            }
+            return hash;
+        }
+
+        /// copy the primary quantities into an array of floats.
+
+        void values(float value[13]) const
+        {
+            value[0] = position.x;
+            value[1] = position.y;
+            value[2] = position.z;
+            value[3] = orientation.w;
+            value[4] = orientation.x;
+            value[5] = orientation.y;
+            value[6] = orientation.z;
+            value[7] = momentum.x;
+            value[8] = momentum.y;
+            value[9] = momentum.z;
+            value[10] = angularMomentum.x;
+            value[11] = angularMomentum.y;
+            value[12] = angularMomentum.z;
+        }
+    };
+
+    /// Secondary physics state.
+    /// Values derived from the primary physics state and mass properties.
+    /// Only calculated when something needs them: by the integrator at each
+    /// stage, and lazily for the current state via Cube::secondary().
+
+    struct Secondary
+    {
+        Vector velocity;                ///< velocity in meters per second (calculated from momentum).
+        Quaternion spin;                ///< quaternion rate of change in orientation.
+        Vector angularVelocity;         ///< angular velocity (calculated from angularMomentum).
+        Transform bodyToWorld;          ///< body to world coordinates transform.
+        Transform worldToBody;          ///< world to body coordinates transform.
+
+        /// Calculate secondary state values from primary values.
+        /// The orientation of the primary state must already be normalized.
+
+        void calculate(const State &state, const Properties &properties)
+        {
+            #ifdef SSE
+            calculateSSE(state, properties);
+            #else
+            calculateScalar(state, properties);
+            #endif
+        }
+
+        /// Scalar version of calculate.
+        /// Built in SSE builds too so that the benchmark can check the SSE version against it.
+
+        void calculateScalar(const State &state, const Properties &properties)
+        {
+            assert(state.position==state.position);
+            assert(state.momentum==state.momentum);
+            assert(state.orientation==state.orientation);
+            assert(state.angularMomentum==state.angularMomentum);
+
+            velocity = state.momentum * properties.inverseMass;
+            angularVelocity = state.angularMomentum * properties.inverseInertiaTensor;
+            spin = 0.5 * Quaternion(0, angularVelocity.x, angularVelocity.y, angularVelocity.z) * state.orientation;
+            bodyToWorld = Transform(state.orientation, state.position);
+            bodyToWorld.inverse(worldToBody);
+        }
+
+        #ifdef SSE
+
+        /// SSE version of calculate.
+        /// The spin quaternion product, the rotation matrix and the inverse transform
+        /// are each worked out in registers with the same multiplies and adds in the
+        /// same order as the scalar version, so the results are identical.
+
+        void calculateSSE(const State &state, const Properties &properties)
+        {
+            assert(state.position==state.position);
+            assert(state.momentum==state.momentum);
+            assert(state.orientation==state.orientation);
+            assert(state.angularMomentum==state.angularMomentum);
+
+            velocity = state.momentum * properties.inverseMass;
+            angularVelocity = state.angularMomentum * properties.inverseInertiaTensor;
+
+            const __m128 q = _mm_setr_ps(state.orientation.w, state.orientation.x, state.orientation.y, state.orientation.z);
+            const __m128 sign = _mm_set1_ps(-0.0f);
+
+            // spin = (0,angularVelocity/2) * orientation, one column of the product at a time (lanes w,x,y,z)
+
+            __m128 product = _mm_mul_ps(_mm_setzero_ps(), q);
+            product = _mm_add_ps(product, _mm_mul_ps(_mm_set1_ps(0.5f * angularVelocity.x), _mm_xor_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(2,3,0,1)), _mm_setr_ps(-0.0f, 0, -0.0f, 0))));
+            product = _mm_add_ps(product, _mm_mul_ps(_mm_set1_ps(0.5f * angularVelocity.y), _mm_xor_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(1,0,3,2)), _mm_setr_ps(-0.0f, 0, 0, -0.0f))));
+            product = _mm_add_ps(product, _mm_mul_ps(_mm_set1_ps(0.5f * angularVelocity.z), _mm_xor_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(0,1,2,3)), _mm_setr_ps(-0.0f, -0.0f, 0, 0))));
+
+            ALIGN16 float result[4];
+            _mm_store_ps(result, product);
+            spin = Quaternion(result[0], result[1], result[2], result[3]);
+
+            // rotation matrix, see Transform::Transform. lanes 0,1,2 of each register are
+            // the diagonal (m11,m22,m33), the sums (m21,m13,m32) and the differences (m12,m31,m23)
+
+            const __m128 twice = _mm_add_ps(q, q);
+            const __m128 cross = _mm_mul_ps(_mm_shuffle_ps(twice, twice, _MM_SHUFFLE(0,3,3,2)), _mm_shuffle_ps(q, q, _MM_SHUFFLE(0,2,1,1)));
+            const __m128 real = _mm_mul_ps(_mm_shuffle_ps(twice, twice, _MM_SHUFFLE(0,1,2,3)), _mm_shuffle_ps(q, q, _MM_SHUFFLE(0,0,0,0)));
+            const __m128 square = _mm_mul_ps(twice, q);
+            const __m128 first = _mm_shuffle_ps(square, square, _MM_SHUFFLE(0,1,1,2));
+            const __m128 second = _mm_shuffle_ps(square, square, _MM_SHUFFLE(0,2,3,3));
+            const __m128 diagonal = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(first, second));
+            const __m128 sum = _mm_add_ps(cross, real);
+            const __m128 difference = _mm_sub_ps(cross, real);
+
+            __m128 row1 = _mm_shuffle_ps(diagonal, difference, _MM_SHUFFLE(0,0,0,0));
+            row1 = _mm_shuffle_ps(row1, sum, _MM_SHUFFLE(1,1,2,0));
+            __m128 row2 = _mm_shuffle_ps(sum, diagonal, _MM_SHUFFLE(1,1,0,0));
+            row2 = _mm_shuffle_ps(row2, difference, _MM_SHUFFLE(2,2,2,0));
+            __m128 row3 = _mm_shuffle_ps(difference, sum, _MM_SHUFFLE(2,2,1,1));
+            row3 = _mm_shuffle_ps(row3, diagonal, _MM_SHUFFLE(2,2,2,0));
+
+            // inverse translation is -(m11,m12,m13)*x - (m21,m22,m23)*y - (m31,m32,m33)*z
+
+            __m128 translation = _mm_add_ps(_mm_mul_ps(row1, _mm_set1_ps(state.position.x)), _mm_mul_ps(row2, _mm_set1_ps(state.position.y)));
+            translation = _mm_xor_ps(_mm_add_ps(translation, _mm_mul_ps(row3, _mm_set1_ps(state.position.z))), sign);
+
+            ALIGN16 float rows[16];
+            _mm_store_ps(rows, row1);
+            _mm_store_ps(rows+4, row2);
+            _mm_store_ps(rows+8, row3);
+            _mm_store_ps(rows+12, translation);
+
+            bodyToWorld.m11 = rows[0];  bodyToWorld.m12 = rows[1];  bodyToWorld.m13 = rows[2];
+            bodyToWorld.m21 = rows[4];  bodyToWorld.m22 = rows[5];  bodyToWorld.m23 = rows[6];
+            bodyToWorld.m31 = rows[8];  bodyToWorld.m32 = rows[9];  bodyToWorld.m33 = rows[10];
+            bodyToWorld.translation = state.position;
+
+            worldToBody.m11 = rows[0];  worldToBody.m12 = rows[4];  worldToBody.m13 = rows[8];
+            worldToBody.m21 = rows[1];  worldToBody.m22 = rows[5];  worldToBody.m23 = rows[9];
+            worldToBody.m31 = rows[2];  worldToBody.m32 = rows[6];  worldToBody.m33 = rows[10];
+            worldToBody.translation = Vector(rows[12], rows[13], rows[14]);
+        }
+
+        #endif
+    };
+
+    /// Contact statistics for the most recent update.
+
+    struct Statistics
+    {
+        int evaluations;                ///< number of derivative evaluations (integrator stages) performed.
+        int substeps;                   ///< number of sub-steps taken (always one except for the adaptive integrator).
+        int contacts[4];                ///< number of corner contacts found in each of the first four integrator stages.
+        int lastContacts;               ///< number of corner contacts found in the last integrator stage.
+        double stageTime[4];            ///< time spent in each RK4 stage in seconds (PROFILING builds only).
+
+        void clear()
+        {
+            evaluations = 0;
+            substeps = 0;
+            lastContacts = 0;
+            for (int i=0; i<4; i++)
+            {
+                contacts[i] = 0;
+                stageTime[i] = 0;
+            }
+        }
+    };
+
+    /// Integrator selection.
+    /// Cheaper integrators trade accuracy for fewer force evaluations per
+    /// step, which is fine for remote proxies and objects far from the player.
+
+    enum Integrator
+    {
+        RK4,                            ///< fourth order runge-kutta, four evaluations per step (default).
+        SemiImplicitEuler,              ///< semi-implicit euler, one evaluation per step.
+        VelocityVerlet,                 ///< velocity verlet, two evaluations per step.
+        Midpoint,                       ///< midpoint method, two evaluations per step.
+        Implicit,                       ///< semi-implicit with implicit contact springs, one evaluation per step, stable at large timesteps.
+        Adaptive                        ///< adaptive dormand-prince sub-stepping, six evaluations per sub-step.
+    };
+
+    /// The eight corners of the cube in world space.
+    /// Stored as separate x,y,z arrays so that all eight corners can be tested
+    /// against a plane with two SSE operations instead of eight dot products.
+    /// The corners are in the order a through h used by the rest of this class.
+
+    struct Corners
+    {
+        ALIGN16 float x[8];
+        ALIGN16 float y[8];
+        ALIGN16 float z[8];
+
+        Vector point(int i) const
+        {
+            return Vector(x[i], y[i], z[i]);
+        }
+    };
+
+    /// Transform the cube corners into world space.
+    /// @param properties the cube mass properties.
+    /// @param secondary the current cube secondary state.
+    /// @param corners the corner array to fill.
+
+    static void calculateCorners(const Properties &properties, const Secondary &secondary, Corners &corners)
+    {
+        static const float signs[8][3] = 
+        {
+            { -1,-1,-1 }, { +1,-1,-1 }, { +1,+1,-1 }, { -1,+1,-1 },
+            { -1,-1,+1 }, { +1,-1,+1 }, { +1,+1,+1 }, { -1,+1,+1 }
+        };
+
+        const float s = properties.size * 0.5f;
+
+        for (int i=0; i<8; i++)
+        {
+            const Vector point = secondary.bodyToWorld * (Vector(signs[i][0], signs[i][1], signs[i][2]) * s);
+            corners.x[i] = point.x;
+            corners.y[i] = point.y;
+            corners.z[i] = point.z;
+        }
+    }
+
+    /// Calculate penetration depth of all eight corners against a plane.
+    /// @param corners the cube corners in world space.
+    /// @param plane the collision plane.
+    /// @param penetration receives the penetration depth of each corner (positive when inside the plane).
+    /// @returns a bit mask with bit i set if corner i is inside the plane.
+
+    static int penetrations(const Corners &corners, const Plane &plane, float penetration[8])
+    {
+        #ifdef SSE
+        return penetrationsSSE(corners, plane, penetration);
+        #else
+        return penetrationsScalar(corners, plane, penetration);
+        #endif
+    }
+
+    /// Scalar version of penetrations.
+    /// Built in SSE builds too so that the benchmark can check the SSE version against it.
+
+    static int penetrationsScalar(const Corners &corners, const Plane &plane, float penetration[8])
+    {
+        int mask = 0;
+
+        for (int i=0; i<8; i++)
+        {
+            penetration[i] = plane.constant - (corners.x[i] * plane.normal.x + corners.y[i] * plane.normal.y + corners.z[i] * plane.normal.z);
+            if (penetration[i]>0)
+                mask |= 1 << i;
+        }
+
+        return mask;
+    }
+
+    #ifdef SSE
+
+    /// SSE version of penetrations, four corners at a time.
+
+    static int penetrationsSSE(const Corners &corners, const Plane &plane, float penetration[8])
+    {
+        int mask = 0;
+
+        const __m128 nx = _mm_set1_ps(plane.normal.x);
+        const __m128 ny = _mm_set1_ps(plane.normal.y);
+        const __m128 nz = _mm_set1_ps(plane.normal.z);
+        const __m128 constant = _mm_set1_ps(plane.constant);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (int i=0; i<8; i+=4)
+        {
+            __m128 d = _mm_mul_ps(_mm_load_ps(corners.x+i), nx);
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_load_ps(corners.y+i), ny));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_load_ps(corners.z+i), nz));
+            const __m128 p = _mm_sub_ps(constant, d);
+            _mm_storeu_ps(penetration+i, p);
+            mask |= _mm_movemask_ps(_mm_cmpgt_ps(p, zero)) << i;
+        }
+
+        return mask;
+    }
+
+    #endif
+
+    /// Calculate gravity force.
+    /// @param force the force accumulator.
+
+	static void gravity(Vector &force)
+	{
+		force.y -= 9.8f;
+	}
+	
+    /// Calculate a simple linear and angular damping force.
+    /// This roughly simulates energy loss due to heat dissipation
+    /// or air resistance or whatever you like.
+    /// @param secondary the current cube secondary state.
+    /// @param force the force accumulator.
+    /// @param torque the torque accumulator.
+
+	static void damping(const Secondary &secondary, Vector &force, Vector &torque)
+	{
+		const float linear = 0.001f;
+		const float angular = 0.001f;
+		
+		force -= linear * secondary.velocity;
+		torque -= angular * secondary.angularVelocity;
+	}
+
+    /// Calculate collision response force and torque.
+    ///
+    /// This is a very basic collision response implemented at the force
+    /// level by simply checking each vertex of the cube against each plane
+    /// in the scene. For each cube vertex that is inside a plane a set of
+    /// penalty forces and friction forces are applied to simulate collision
+    /// response. See Cube::collisionForPoint for details.
+    ///
+    /// Planes further from the cube center than its bounding sphere radius
+    /// are rejected before any corners are tested. Levels with many surfaces
+    /// keep them in a World or a Heightfield instead, and the scene passes in
+    /// only the planes of the surfaces near the cube.
+    ///
+    /// @param planes the set of collision planes in the scene.
+    /// @param properties the cube mass properties.
+    /// @param state the current cube physics state.
+    /// @param secondary the current cube secondary state.
+    /// @param corners the cube corners in world space.
+    /// @param force the force accumulator.
+    /// @param torque the torque accumulator.
+    /// @returns the number of corner contacts.
+
+    static int collision(const std::vector<Plane> &planes, const Properties &properties, const State &state, const Secondary &secondary, const Corners &corners, Vector &force, Vector &torque)
+	{
+        const float radius = properties.size * 0.87f;       // slightly more than half the cube diagonal
+
+        int contacts = 0;
+
+		for (unsigned int i=0; i<planes.size(); i++)
+		{
+            const Plane &plane = planes[i];
+
+            if (state.position.dot(plane.normal) - plane.constant > radius)
+                continue;
+
+            float penetration[8];
+
+            const int mask = penetrations(corners, plane, penetration);
+
+            if (!mask)
+                continue;
+
+            for (int j=0; j<8; j++)
+            {
+                if (mask & (1<<j))
+                {
+                    collisionForPoint(state, secondary, force, torque, corners.point(j), plane, penetration[j]);
+                    contacts++;
+                }
+            }
+		}
+
+        return contacts;
+	}
+	
+    /// Calculate collision response force and torque for a point against a plane.
+    ///
+    /// If the point is inside the plane then a penalty force is applied to push
+    /// the point out. A damping force is also applied to make the collision inelastic
+    /// otherwise the cube would bounce off plane without losing any energy.
+    ///
+    /// Velocity constraint forces are also applied when the point is inside the plane
+    /// and the point is moving further into the plane. This tightens up the collision
+    /// response from what would be achieved using penetration depth penalty forces
+    /// alone giving a more realistic result.
+    ///
+    /// An approximation of tangential friction force is also applied. This is not
+    /// true coulomb friction which would be proportional to the normal force between
+    /// the two objects, instead it is more of a rolling type friction proportional
+    /// to the tangential velocity between the two surfaces. This gives basically
+    /// correct effects.
+    ///
+    /// Finally please note that this collision response is very basic. The correct
+    /// way to implement this would be to develop a solver which could simultaneously
+    /// satisify a number of constaints. The tradeoff made here is that we allow some
+    /// softness in the collision response to make the calculations easier. This
+    /// small amount of give during collision lets us calculate collision response
+    /// easily without needing a complicated solver and without the jitter that you
+    /// normally see in an impulse based collision response. Scenes that need stiffer
+    /// contact, such as stacks of props at low tick rates, can use that solver instead,
+    /// see Solver and Scene::contactMode.
+    ///
+    /// @param state the current cube physics state.
+    /// @param secondary the current cube secondary state.
+    /// @param force the force accumulator.
+    /// @param torque the torque accumulator.
+    /// @param point the point inside the plane.
+    /// @param plane the collision plane.
+    /// @param penetration the penetration depth of the point, must be positive.
+
+    static void collisionForPoint(const State &state, const Secondary &secondary, Vector &force, Vector &torque, const Vector &point, const Plane &plane, float penetration)
+	{
+		const float c = 10;
+		const float k = 100;
+		const float b = 5;
+		const float f = 3;
+		
+		assert(penetration>0);
+
+		Vector velocity = secondary.angularVelocity.cross(point-state.position) + secondary.velocity - plane.velocity;
+        assert(velocity==velocity);
+
+		const float relativeSpeed = - plane.normal.dot(velocity);
+        assert(relativeSpeed==relativeSpeed);
+		
+		if (relativeSpeed>0)
+		{
+			Vector collisionForce = plane.normal * (relativeSpeed * c);
+            assert(collisionForce==collisionForce);
+			force += collisionForce;
+			torque += (point-state.position).cross(collisionForce);
+        }
+		
+        Vector tangentialVelocity = velocity + (plane.normal * relativeSpeed);
+        Vector frictionForce = - tangentialVelocity * f;
+        assert(frictionForce==frictionForce);
+        force += frictionForce;
+        torque += (point-state.position).cross(frictionForce);
+
+        Vector penaltyForce = plane.normal * (penetration * k);
+        assert(penaltyForce==penaltyForce);
+		force += penaltyForce;
+		torque += (point-state.position).cross(penaltyForce);
+		
+		Vector dampingForce = plane.normal * (relativeSpeed * penetration * b);
+        assert(dampingForce==dampingForce);
+		force += dampingForce;
+		torque += (point-state.position).cross(dampingForce);
+	}
+
+    /// Control forces
+
+    static void control(const Input &input, const Secondary &secondary, const Corners &corners, Vector &force, Vector &torque)
+    {
+        const float f = 50.0f;
+
+        if (input.left)
+            force.x -= f;
+
+        if (input.right)
+            force.x += f;
+
+        if (input.forward)
+            force.z -= f;
+
+        if (input.back)
+            force.z += f;
+
+        if (input.jump && secondary.velocity.y>=-0.1f)
+        {
+            const float j = 20;
+            const float k = 5;
+
+            const float difference = j - secondary.velocity.y;
+
+            float lowest = corners.y[0];
+            for (int i=1; i<8; i++)
+                if (corners.y[i]<lowest) 
+                    lowest = corners.y[i];
+
+            if (difference>0 && lowest<0.05f)
+                force.y += difference * k;
+        }
+    }
+
+    /// Oriented box narrowphase between two cubes.
+    ///
+    /// Tests the fifteen separating axes of two oriented boxes (three face
+    /// normals from each box and the nine edge cross products). If the boxes
+    /// are closer than the margin along every axis they are in contact, and
+    /// the axis of least penetration becomes the contact normal. Face axes are
+    /// preferred over edge axes unless an edge axis is clearly better, which
+    /// keeps resting contact stable.
+    ///
+    /// The contact is returned as a pair of moving planes, one for each cube:
+    /// the supporting plane of the other cube along the contact normal, moving
+    /// with the velocity of the other cube's surface. Adding these planes to the
+    /// collision planes of each cube for one step lets the existing penalty force
+    /// model (see collision and collisionForPoint) resolve cube to cube contact
+    /// exactly as it resolves contact against the world.
+    ///
+    /// @param properties the mass properties of each cube.
+    /// @param state the physics state of each cube.
+    /// @param secondary the secondary state of each cube.
+    /// @param margin distance at which contact planes are generated before the cubes touch.
+    /// @param planeA receives the contact plane for cube a.
+    /// @param planeB receives the contact plane for cube b.
+    /// @returns true if the cubes are in contact.
+
+    static bool contact(const Properties &propertiesA, const State &stateA, const Secondary &secondaryA,
+                        const Properties &propertiesB, const State &stateB, const Secondary &secondaryB,
+                        float margin, Plane &planeA, Plane &planeB)
+    {
+        const Transform &a = secondaryA.bodyToWorld;
+        const Transform &b = secondaryB.bodyToWorld;
+
+        const Vector axesA[3] = { Vector(a.m11, a.m21, a.m31), Vector(a.m12, a.m22, a.m32), Vector(a.m13, a.m23, a.m33) };
+        const Vector axesB[3] = { Vector(b.m11, b.m21, b.m31), Vector(b.m12, b.m22, b.m32), Vector(b.m13, b.m23, b.m33) };
+
+        const float extentA = propertiesA.size * 0.5f;
+        const float extentB = propertiesB.size * 0.5f;
+
+        const Vector difference = stateA.position - stateB.position;
+
+        Vector faceNormal;
+        float faceOverlap = FLT_MAX;
+        Vector edgeNormal;
+        float edgeOverlap = FLT_MAX;
+
+        for (int i=0; i<15; i++)
+        {
+            Vector axis;
+
+            if (i<3)
+                axis = axesA[i];
+            else if (i<6)
+                axis = axesB[i-3];
+            else
+            {
+                axis = axesA[(i-6)/3].cross(axesB[(i-6)%3]);
+                const float lengthSquared = axis.lengthSquared();
+                if (lengthSquared<0.000001f)
+                    continue;                   // parallel edges, already covered by the face axes
+                axis *= 1.0f / Mathematics::sqrt(lengthSquared);
+            }
+
+            const float radiusA = extentA * (Mathematics::abs(axis.dot(axesA[0])) + Mathematics::abs(axis.dot(axesA[1])) + Mathematics::abs(axis.dot(axesA[2])));
+            const float radiusB = extentB * (Mathematics::abs(axis.dot(axesB[0])) + Mathematics::abs(axis.dot(axesB[1])) + Mathematics::abs(axis.dot(axesB[2])));
+            const float distance = axis.dot(difference);
+            const float overlap = radiusA + radiusB - Mathematics::abs(distance);
+
+            if (overlap<-margin)
+                return false;
+
+            // orient the normal from b towards a
+
+            if (distance<0)
+                axis = -axis;
+
+            if (i<6)
+            {
+                if (overlap<faceOverlap)
+                {
+                    faceOverlap = overlap;
+                    faceNormal = axis;
+                }
+            }
+            else if (overlap<edgeOverlap)
+            {
+                edgeOverlap = overlap;
+                edgeNormal = axis;
+            }
+        }
+
+        const Vector normal = edgeOverlap < faceOverlap * 0.95f - 0.01f ? edgeNormal : faceNormal;
+
+        const float supportA = extentA * (Mathematics::abs(normal.dot(axesA[0])) + Mathematics::abs(normal.dot(axesA[1])) + Mathematics::abs(normal.dot(axesA[2])));
+        const float supportB = extentB * (Mathematics::abs(normal.dot(axesB[0])) + Mathematics::abs(normal.dot(axesB[1])) + Mathematics::abs(normal.dot(axesB[2])));
+
+        planeA.normal = normal;
+        planeA.constant = normal.dot(stateB.position) + supportB;
+        planeA.velocity = secondaryB.velocity + secondaryB.angularVelocity.cross(normal * supportB);
+
+        planeB.normal = -normal;
+        planeB.constant = -normal.dot(stateA.position) + supportA;
+        planeB.velocity = secondaryA.velocity + secondaryA.angularVelocity.cross(-normal * supportA);
+
+        return true;
+    }
+
+    #ifdef FIXED_POINT
+
+    /// Fixed point versions of the physics state and force calculations.
+    ///
+    /// In FIXED_POINT builds the RK4 integrator converts the state to Q16.16 
+    /// fixed point, integrates it entirely with integer arithmetic and converts
+    /// the result back, so that every machine calculates exactly the same bits.
+    /// The floating point State is still what is stored in history and sent
+    /// over the network, so Scene, History and Connection are unchanged.
+    /// The force calculations below mirror their floating point versions above.
+
+    /// Fixed point mass properties.
+
+    struct FixedProperties
+    {
+        Fixed size;
+        Fixed inverseMass;
+        Fixed inverseInertiaTensor;
+
+        explicit FixedProperties(const Properties &properties)
+        {
+            size = Fixed(properties.size);
+            inverseMass = Fixed(properties.inverseMass);
+            inverseInertiaTensor = Fixed(properties.inverseInertiaTensor);
+        }
+    };
+
+    /// Fixed point physics state (primary quantities only).
+
+    struct FixedState
+    {
+        FixedVector position;
+        FixedVector momentum;
+        FixedQuaternion orientation;
+        FixedVector angularMomentum;
+
+        FixedState() {}
+
+        /// convert from floating point state.
+
+        explicit FixedState(const State &state)
+        {
+            position = FixedVector(state.position);
+            momentum = FixedVector(state.momentum);
+            orientation = FixedQuaternion(state.orientation);
+            angularMomentum = FixedVector(state.angularMomentum);
+        }
+
+        /// convert to floating point state.
+
+        void get(State &state) const
+        {
+            state.position = position.toVector();
+            state.momentum = momentum.toVector();
+            state.orientation = orientation.toQuaternion();
+            state.angularMomentum = angularMomentum.toVector();
+        }
+
+        /// hash of the fixed point bits (fnv-1a).
+
+        unsigned int hash() const
+        {
+            const int value[] = { position.x.raw, position.y.raw, position.z.raw,
+                                  orientation.w.raw, orientation.x.raw, orientation.y.raw, orientation.z.raw,
+                                  momentum.x.raw, momentum.y.raw, momentum.z.raw,
+                                  angularMomentum.x.raw, angularMomentum.y.raw, angularMomentum.z.raw };
+            unsigned int hash = 2166136261u;
+            for (int i=0; i<13; i++)
+            {
+                unsigned int bits = (unsigned int) value[i];
+                for (int j=0; j<4; j++)
+                {
+                    hash ^= bits & 0xFF;
+                    hash *= 16777619u;
+                    bits >>= 8;
+                }
+            }
+            return hash;
+        }
+    };
+
+    /// Fixed point secondary state.
+
+    struct FixedSecondary
+    {
+        FixedVector velocity;
+        FixedQuaternion spin;
+        FixedVector angularVelocity;
+        Fixed m[3][3];                  ///< body to world rotation matrix, see Transform.
+
+        /// Calculate secondary state values from primary values.
+        /// The orientation must already be normalized.
+
+        void calculate(const FixedState &state, const FixedProperties &properties)
+        {
+            velocity = state.momentum * properties.inverseMass;
+            angularVelocity = state.angularMomentum * properties.inverseInertiaTensor;
+            spin = FixedQuaternion(Fixed::bits(0), angularVelocity.x, angularVelocity.y, angularVelocity.z) * state.orientation * Fixed::bits(32768);
+
+            const FixedQuaternion &q = state.orientation;
+            const Fixed two = Fixed::bits(131072);
+            const Fixed one = Fixed::bits(65536);
+            const Fixed tx = two*q.x;
+            const Fixed ty = two*q.y;
+            const Fixed tz = two*q.z;
+            const Fixed twx = tx*q.w;
+            const Fixed twy = ty*q.w;
+            const Fixed twz = tz*q.w;
+            const Fixed txx = tx*q.x;
+            const Fixed txy = ty*q.x;
+            const Fixed txz = tz*q.x;
+            const Fixed tyy = ty*q.y;
+            const Fixed tyz = tz*q.y;
+            const Fixed tzz = tz*q.z;
+
+            m[0][0] = one-(tyy+tzz);
+            m[0][1] = txy-twz;
+            m[0][2] = txz+twy;
+            m[1][0] = txy+twz;
+            m[1][1] = one-(txx+tzz);
+            m[1][2] = tyz-twx;
+            m[2][0] = txz-twy;
+            m[2][1] = tyz+twx;
+            m[2][2] = one-(txx+tyy);
+        }
+    };
+
+    /// The eight corners of the cube in world space, fixed point.
+
+    struct FixedCorners
+    {
+        FixedVector point[8];
+    };
+
+    /// Transform the cube corners into world space in fixed point.
+
+    static void calculateCorners(const FixedProperties &properties, const FixedState &state, const FixedSecondary &secondary, FixedCorners &corners)
+    {
+        static const int signs[8][3] = 
+        {
+            { -1,-1,-1 }, { +1,-1,-1 }, { +1,+1,-1 }, { -1,+1,-1 },
+            { -1,-1,+1 }, { +1,-1,+1 }, { +1,+1,+1 }, { -1,+1,+1 }
+        };
+
+        const Fixed s = Fixed::bits(properties.size.raw / 2);
+
+        for (int i=0; i<8; i++)
+        {
+            const Fixed x = signs[i][0]>0 ? s : -s;
+            const Fixed y = signs[i][1]>0 ? s : -s;
+            const Fixed z = signs[i][2]>0 ? s : -s;
+            corners.point[i] = FixedVector(secondary.m[0][0]*x + secondary.m[0][1]*y + secondary.m[0][2]*z,
+                                           secondary.m[1][0]*x + secondary.m[1][1]*y + secondary.m[1][2]*z,
+                                           secondary.m[2][0]*x + secondary.m[2][1]*y + secondary.m[2][2]*z) + state.position;
+        }
+    }
+
+    /// Calculate gravity force in fixed point.
+
+    static void gravity(FixedVector &force)
+    {
+        static const Fixed g(9.8f);
+        force.y -= g;
+    }
+
+    /// Calculate damping force and torque in fixed point.
+
+    static void damping(const FixedSecondary &secondary, FixedVector &force, FixedVector &torque)
+    {
+        static const Fixed linear(0.001f);
+        static const Fixed angular(0.001f);
+
+        force -= secondary.velocity * linear;
+        torque -= secondary.angularVelocity * angular;
+    }
+
+    /// Calculate collision response force and torque in fixed point.
+    /// See the floating point version for details.
+
+    static int collision(const std::vector<Plane> &planes, const FixedProperties &properties, const FixedState &state, const FixedSecondary &secondary, const FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        static const Fixed scale(0.87f);
+        const Fixed radius = properties.size * scale;
+
+        int contacts = 0;
+
+        for (unsigned int i=0; i<planes.size(); i++)
+        {
+            const FixedVector normal(planes[i].normal);
+            const Fixed constant(planes[i].constant);
+            const FixedVector surface(planes[i].velocity);
+
+            if (state.position.dot(normal) - constant > radius)
+                continue;
+
+            for (int j=0; j<8; j++)
+            {
+                const Fixed penetration = constant - corners.point[j].dot(normal);
+                if (penetration.raw>0)
+                {
+                    collisionForPoint(state, secondary, force, torque, corners.point[j], normal, surface, penetration);
+                    contacts++;
+                }
+            }
+        }
+
+        return contacts;
+    }
+
+    /// Calculate collision response force and torque for a point against a plane in fixed point.
+
+    static void collisionForPoint(const FixedState &state, const FixedSecondary &secondary, FixedVector &force, FixedVector &torque, const FixedVector &point, const FixedVector &normal, const FixedVector &surface, Fixed penetration)
+    {
+        static const Fixed c(10.0f);
+        static const Fixed k(100.0f);
+        static const Fixed b(5.0f);
+        static const Fixed f(3.0f);
+
+        const FixedVector r = point - state.position;
+        const FixedVector velocity = secondary.angularVelocity.cross(r) + secondary.velocity - surface;
+        const Fixed relativeSpeed = -normal.dot(velocity);
+
+        if (relativeSpeed.raw>0)
+        {
+            const FixedVector collisionForce = normal * (relativeSpeed * c);
+            force += collisionForce;
+            torque += r.cross(collisionForce);
+        }
+
+        const FixedVector frictionForce = -(velocity + normal * relativeSpeed) * f;
+        force += frictionForce;
+        torque += r.cross(frictionForce);
+
+        const FixedVector penaltyForce = normal * (penetration * k);
+        force += penaltyForce;
+        torque += r.cross(penaltyForce);
+
+        const FixedVector dampingForce = normal * (relativeSpeed * penetration * b);
+        force += dampingForce;
+        torque += r.cross(dampingForce);
+    }
+
+    /// Control forces in fixed point.
+
+    static void control(const Input &input, const FixedSecondary &secondary, const FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        static const Fixed f(50.0f);
+
+        if (input.left)
+            force.x -= f;
+
+        if (input.right)
+            force.x += f;
+
+        if (input.forward)
+            force.z -= f;
+
+        if (input.back)
+            force.z += f;
+
+        static const Fixed threshold(-0.1f);
+
+        if (input.jump && secondary.velocity.y>=threshold)
+        {
+            static const Fixed j(20.0f);
+            static const Fixed k(5.0f);
+            static const Fixed ground(0.05f);
+
+            const Fixed difference = j - secondary.velocity.y;
+
+            Fixed lowest = corners.point[0].y;
+            for (int i=1; i<8; i++)
+                if (corners.point[i].y<lowest) 
+                    lowest = corners.point[i].y;
+
+            if (difference.raw>0 && lowest<ground)
+                force.y += difference * k;
+        }
+    }
+
+    #endif
+};
+
+/// Constant gravity force term.
+///
+/// Each force term adds one kind of force to the accumulated force and torque
+/// of a cube, and describes itself to ForcePipeline with two flags: whether 
+/// it needs the cube corners in world space, and whether it is a contact term
+/// (which the implicit integrator resolves separately). All terms share the 
+/// same apply signature so they can be composed at compile time.
+
+struct Gravity
+{
+    enum { corners = 0, contacts = 0 };
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        CubeBase::gravity(force);
+        return 0;
+    }
+
+    #ifdef FIXED_POINT
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::FixedProperties &properties, const CubeBase::FixedState &state, const CubeBase::FixedSecondary &secondary, const CubeBase::FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        CubeBase::gravity(force);
+        return 0;
+    }
+
+    #endif
+};
+
+/// Linear and angular damping force term.
+
+struct Damping
+{
+    enum { corners = 0, contacts = 0 };
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        CubeBase::damping(secondary, force, torque);
+        return 0;
+    }
+
+    #ifdef FIXED_POINT
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::FixedProperties &properties, const CubeBase::FixedState &state, const CubeBase::FixedSecondary &secondary, const CubeBase::FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        CubeBase::damping(secondary, force, torque);
+        return 0;
+    }
+
+    #endif
+};
+
+/// Penalty contact force term against the scene collision planes.
+
+struct PlaneContacts
+{
+    enum { corners = 1, contacts = 1 };
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        return CubeBase::collision(planes, properties, state, secondary, corners, force, torque);
+    }
+
+    #ifdef FIXED_POINT
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::FixedProperties &properties, const CubeBase::FixedState &state, const CubeBase::FixedSecondary &secondary, const CubeBase::FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        return CubeBase::collision(planes, properties, state, secondary, corners, force, torque);
+    }
+
+    #endif
+};
+
+/// Player control force term driven by input.
+
+struct PlayerControl
+{
+    enum { corners = 1, contacts = 0 };
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        CubeBase::control(input, secondary, corners, force, torque);
+        return 0;
+    }
+
+    #ifdef FIXED_POINT
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::FixedProperties &properties, const CubeBase::FixedState &state, const CubeBase::FixedSecondary &secondary, const CubeBase::FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        CubeBase::control(input, secondary, corners, force, torque);
+        return 0;
+    }
+
+    #endif
+};
+
+/// Empty force term used to fill unused pipeline slots.
+
+struct NoForce
+{
+    enum { corners = 0, contacts = 0 };
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        return 0;
+    }
+
+    #ifdef FIXED_POINT
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::FixedProperties &properties, const CubeBase::FixedState &state, const CubeBase::FixedSecondary &secondary, const CubeBase::FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        return 0;
+    }
+
+    #endif
+};
+
+/// Compile time force pipeline.
+/// Applies up to four force terms in order. Everything is resolved at
+/// compile time so only the listed terms are inlined into the integrator,
+/// and the cube corners are only calculated if some term needs them.
+
+template <class A, class B = NoForce, class C = NoForce, class D = NoForce> struct ForcePipeline
+{
+    enum 
+    { 
+        corners = A::corners || B::corners || C::corners || D::corners,
+        contacts = A::contacts || B::contacts || C::contacts || D::contacts
+    };
+
+    /// Apply all force terms.
+    /// @returns the number of corner contacts found.
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        int count = A::apply(input, planes, properties, state, secondary, corners, force, torque);
+        count += B::apply(input, planes, properties, state, secondary, corners, force, torque);
+        count += C::apply(input, planes, properties, state, secondary, corners, force, torque);
+        count += D::apply(input, planes, properties, state, secondary, corners, force, torque);
+        return count;
+    }
+
+    #ifdef FIXED_POINT
+
+    /// Apply all force terms in fixed point.
+
+    static int apply(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::FixedProperties &properties, const CubeBase::FixedState &state, const CubeBase::FixedSecondary &secondary, const CubeBase::FixedCorners &corners, FixedVector &force, FixedVector &torque)
+    {
+        int count = A::apply(input, planes, properties, state, secondary, corners, force, torque);
+        count += B::apply(input, planes, properties, state, secondary, corners, force, torque);
+        count += C::apply(input, planes, properties, state, secondary, corners, force, torque);
+        count += D::apply(input, planes, properties, state, secondary, corners, force, torque);
+        return count;
+    }
+
+    #endif
+
+    /// Apply only the force terms that are not contact terms.
+
+    static void applyBody(const CubeBase::Input &input, const std::vector<Plane> &planes, const CubeBase::Properties &properties, const CubeBase::State &state, const CubeBase::Secondary &secondary, const CubeBase::Corners &corners, Vector &force, Vector &torque)
+    {
+        if (!A::contacts)
+            A::apply(input, planes, properties, state, secondary, corners, force, torque);
+        if (!B::contacts)
+            B::apply(input, planes, properties, state, secondary, corners, force, torque);
+        if (!C::contacts)
+            C::apply(input, planes, properties, state, secondary, corners, force, torque);
+        if (!D::contacts)
+            D::apply(input, planes, properties, state, secondary, corners, force, torque);
+    }
+};
+
+/// A cube with self contained physics simulation.
+///
+/// This class is responsible for maintaining and integrating its
+/// physics state using an RK4 integrator. The nature of the
+/// integrator requires that we structure this class in such a
+/// way that all forces can be calculated from the current physics
+/// state at any time. See Cube::integrate for details.
+///
+/// The force terms acting on the cube are a compile time parameter,
+/// see ForcePipeline. Cube is the player controlled cube used by the
+/// scenes, the other typedefs below drop the terms a body does not need.
+
+template <class Forces> class BasicCube : public CubeBase
+{
+public:
+
+    /// Cube color
+
+    float r,g,b,a;
+
+    Statistics statistics;              ///< contact statistics for the most recent update.
+
+    Integrator integrator;              ///< integrator used by update.
+
+    /// Default constructor.
+	
+	BasicCube()
+	{
+		properties.set(1, 1);
+
+		current.position = Vector(0,40,0);
+		current.momentum = Vector(0,0,0);
+		current.orientation.identity();
+		current.angularMomentum = Vector(0,0,0);
+		
+		previous = current;
+
+        dirty = true;
+
+        r = g = b = a = 1;
+
+        statistics.clear();
+
+        integrator = RK4;
+
+        canSleep = true;
+        managedSleep = false;
+        asleep = false;
+        restTicks = 0;
+        restContacts = 0;
+        restPlanes = 0;
+        restPlanesKnown = false;
+	}
+
+    /// Update physics state.
+    /// @param input the current input data.
+    /// @param planes the set of world collision planes to collide against.
+    /// @param dt delta time to advance ahead in seconds.
+
+    void update(const Input &input, const std::vector<Plane> &planes, float dt)
+    {
+        previous = current;
+        statistics.clear();
+
+        if (asleep)
+        {
+            if (!disturbed(input, planes))
+                return;
+
+            wake();
+        }
+
+        secondary();
+
+        switch (integrator)
+        {
+            case RK4:
+                #ifdef FIXED_POINT
+                integrate<FixedRK4Integrator>(input, planes, properties, current, cache, dt, &statistics);
+                #else
+                integrate<RK4Integrator>(input, planes, properties, current, cache, dt, &statistics);
+                #endif
+                break;
+
+            case SemiImplicitEuler:
+                integrate<EulerIntegrator>(input, planes, properties, current, cache, dt, &statistics);
+                break;
+
+            case VelocityVerlet:
+                integrate<VerletIntegrator>(input, planes, properties, current, cache, dt, &statistics);
+                break;
+
+            case Midpoint:
+                integrate<MidpointIntegrator>(input, planes, properties, current, cache, dt, &statistics);
+                break;
+
+            case Implicit:
+                integrate<ImplicitIntegrator>(input, planes, properties, current, cache, dt, &statistics);
+                break;
+
+            case Adaptive:
+                integrate<AdaptiveIntegrator>(input, planes, properties, current, cache, dt, &statistics);
+                break;
+        }
+
+        rest();
+    }
+
+    /// Integrate velocity for one step with the contact solver.
+    /// Applies every force term except contacts to the momentum, see Forces::applyBody.
+    /// Contacts are then resolved by Solver and the step finished with integratePosition.
+    /// The integrator setting is not used: this is always semi-implicit euler.
+    /// @param input the current input data.
+    /// @param planes the set of world collision planes (used by the control force for jumping).
+    /// @param dt delta time to advance ahead in seconds.
+    /// @returns false if the cube is sleeping and stays asleep, in which case integratePosition must not be called.
+
+    bool integrateVelocity(const Input &input, const std::vector<Plane> &planes, float dt)
+    {
+        previous = current;
+        statistics.clear();
+
+        if (asleep)
+        {
+            if (!disturbed(input, planes))
+                return false;
+
+            wake();
+        }
+
+        secondary();
+
+        Corners corners;
+        if (Forces::corners)
+            calculateCorners(properties, cache, corners);
+
+        Vector force(0,0,0);
+        Vector torque(0,0,0);
+
+        Forces::applyBody(input, planes, properties, current, cache, corners, force, torque);
+
+        current.momentum += force * dt;
+        current.angularMomentum += torque * dt;
+        dirty = true;
+
+        statistics.evaluations = 1;
+        statistics.substeps = 1;
+
+        return true;
+    }
+
+    /// Finish a step with the contact solver.
+    /// @param velocity the linear velocity calculated by the solver.
+    /// @param angularVelocity the angular velocity calculated by the solver.
+    /// @param contacts the number of contact points touching the cube.
+    /// @param dt delta time to advance ahead in seconds.
+
+    void integratePosition(const Vector &velocity, const Vector &angularVelocity, int contacts, float dt)
+    {
+        current.momentum = velocity * properties.mass;
+        current.angularMomentum = angularVelocity * properties.inertiaTensor;
+        current.position += velocity * dt;
+        cache.calculate(current, properties);
+        current.orientation += cache.spin * dt;
+        current.orientation.normalize();
+        cache.calculate(current, properties);
+        dirty = false;
+
+        statistics.contacts[0] = contacts;
+        statistics.lastContacts = contacts;
+
+        rest();
+    }
+
+    /// Returns true if the cube is sleeping.
+    /// A sleeping cube is at rest and skips integration until woken.
+
+    bool sleeping() const
+    {
+        return asleep;
+    }
+
+    /// Wake the cube up if it is sleeping.
+    /// Called automatically on input, snaps and changes to the planes the
+    /// cube is touching, see disturbed. Call this when something else that
+    /// could change the contacts of the cube happens, for example another
+    /// cube landing on it.
+
+    void wake()
+    {
+        asleep = false;
+        restTicks = 0;
+    }
+
+    /// Returns true if the cube has been at rest long enough to sleep.
+
+    bool resting() const
+    {
+        return restTicks>=sleepTicks;
+    }
+
+    /// Put the cube to sleep.
+    /// Normally the cube does this itself once it is resting, unless managedSleep is set.
+
+    void sleep()
+    {
+        // come to a complete stop so the cube stays put when woken
+
+        asleep = true;
+        restPlanesKnown = false;
+        current.momentum.zero();
+        current.angularMomentum.zero();
+        dirty = true;
+    }
+
+    /// Check whether a sleeping cube has to wake up.
+    /// A cube wakes on input, when the set of planes its corners are inside is not
+    /// the one it went to sleep on (a plane moved or was removed, or new world or
+    /// terrain geometry reaches it) and when a plane it is inside has a velocity.
+    /// The planes are recorded as a hash by the first update after going to sleep.
+    /// With managedSleep only input wakes the cube here, its owner wakes it on
+    /// contact changes (see Scene::sleepIslands).
+    /// @param input the current input data.
+    /// @param planes the collision planes the cube would be updated against.
+    /// @returns true if the cube must wake up.
+
+    bool disturbed(const Input &input, const std::vector<Plane> &planes)
+    {
+        if (input.left || input.right || input.forward || input.back || input.jump)
+            return true;
+
+        if (!Forces::contacts || managedSleep)
+            return false;
+
+        Corners corners;
+        calculateCorners(properties, secondary(), corners);
+
+        unsigned int hash = 2166136261u;
+
+        for (unsigned int i=0; i<planes.size(); i++)
+        {
+            const Plane &plane = planes[i];
+
+            float penetration[8];
+            if (!penetrations(corners, plane, penetration))
+                continue;
+
+            if (plane.velocity.x!=0 || plane.velocity.y!=0 || plane.velocity.z!=0)
+                return true;
+
+            const float value[] = { plane.normal.x, plane.normal.y, plane.normal.z, plane.constant };
+
+            for (int j=0; j<4; j++)
+            {
+                unsigned int bits = Mathematics::bits(value[j]);
+                for (int k=0; k<4; k++)
+                {
+                    hash ^= bits & 0xFF;
+                    hash *= 16777619u;
+                    bits >>= 8;
+                }
+            }
+        }
+
+        if (!restPlanesKnown)
+        {
+            restPlanes = hash;
+            restPlanesKnown = true;
+            return false;
+        }
+
+        return hash!=restPlanes;
+    }
+
+    /// Move the cube and stop it moving into a surface.
+    /// Used by continuous collision detection to stop a fast cube where it
+    /// first touches static geometry, see Scene::continuous.
+    /// @param offset how far to move the cube.
+    /// @param normal unit normal of the surface. Momentum into the surface is removed.
+
+    void impact(const Vector &offset, const Vector &normal)
+    {
+        current.position += offset;
+
+        const float into = current.momentum.dot(normal);
+        if (into<0)
+            current.momentum -= normal * into;
+
+        dirty = true;
+    }
+
+    /// Smooth physics state towards target.
+
+    void smooth(const State &target, float tightness)
+    {
+        previous = current;
+        current = target;
+        current.position = previous.position + (target.position-previous.position) * tightness;
+        current.orientation = slerp(previous.orientation, target.orientation, tightness);
+        current.orientation.normalize();
+        dirty = true;
+    }
+
+    #ifndef HEADLESS
+
+    /// Render cube at interpolated state.
+    /// Calculates interpolated state then renders cube at the interpolated 
+	/// position and orientation using OpenGL.
+	/// @param alpha interpolation alpha in [0,1]
+
+    void render(const Vector &light, float alpha = 1.0f)
+	{	
+		glPushMatrix();
+
+		State state = interpolate(previous, current, alpha);
+
+        Secondary secondary;
+        secondary.calculate(state, properties);
+		
+		// opengl matrices are column major so pass in the transpose
+
+		Matrix bodyToWorld = secondary.bodyToWorld.matrix().transpose();
+		glMultMatrixf(bodyToWorld.data());
+		
+        // render cube
+
+        GLfloat color[] = { r, g, b, a };
+
+		glMaterialfv(GL_FRONT, GL_AMBIENT, color);
+		glMaterialfv(GL_FRONT, GL_DIFFUSE, color);
+		
+		glEnable(GL_LIGHTING);
+		
+        if (a!=1.0f)
+        {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+
+        glDepthFunc(GL_ALWAYS);
+
+        const float s = properties.size * 0.5f;
+
+        glBegin(GL_QUADS);
+		
+			glNormal3f(0,0,+1);
+			glVertex3f(-s,-s,+s);
+			glVertex3f(+s,-s,+s);
+			glVertex3f(+s,+s,+s);
+			glVertex3f(-s,+s,+s);
+
+			glNormal3f(0,0,-1);
+			glVertex3f(-s,-s,-s);
+			glVertex3f(-s,+s,-s);
+			glVertex3f(+s,+s,-s);
+			glVertex3f(+s,-s,-s);
+			
+			glNormal3f(0,+1,0);
+			glVertex3f(-s,+s,-s);
+			glVertex3f(-s,+s,+s);
+			glVertex3f(+s,+s,+s);
+			glVertex3f(+s,+s,-s);
+			
+			glNormal3f(0,-1,0);
+			glVertex3f(-s,-s,-s);
+			glVertex3f(+s,-s,-s);
+			glVertex3f(+s,-s,+s);
+			glVertex3f(-s,-s,+s);
+
+			glNormal3f(+1,0,0);
+			glVertex3f(+s,-s,-s);
+			glVertex3f(+s,+s,-s);
+			glVertex3f(+s,+s,+s);
+			glVertex3f(+s,-s,+s);
+			
+			glNormal3f(-1,0,0);
+			glVertex3f(-s,-s,-s);
+			glVertex3f(-s,-s,+s);
+			glVertex3f(-s,+s,+s);
+			glVertex3f(-s,+s,-s);
+			
+		glEnd();
+
+        glDepthFunc(GL_LEQUAL);
+
+        glDisable(GL_BLEND);
+		glDisable(GL_LIGHTING);
+
+        // render shadow volume
+
+        if (a==1.0f)
+        {
+            // enter state for rendering shadow volumes to stencil
+
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glDepthMask(GL_FALSE);
+            
+            glEnable(GL_STENCIL_TEST);
+
+            Vector bodySpaceLight = secondary.worldToBody * light;
+
+            // render front faces
+
+            glStencilFunc(GL_ALWAYS, 0x0, 0xff);
+            glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+
+            renderShadowVolume(properties, bodySpaceLight);
+
+            // render shadow volume back faces
+
+            glCullFace(GL_FRONT);
+            glStencilFunc(GL_ALWAYS, 0x0, 0xff);
+            glStencilOp(GL_KEEP, GL_KEEP, GL_DECR);
+            
+            renderShadowVolume(properties, bodySpaceLight);
+
+            // restore normal rendering state
+
+            glCullFace(GL_BACK);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthMask(GL_TRUE);
+
+            glDisable(GL_STENCIL_TEST);
+        }
+
+		glPopMatrix();
+	}
+
+    #endif
+
+    void snap(const State &state)
+    {
+        current = state;
+        previous = state;
+        dirty = true;
+        wake();
+    }
+
+    const State &state() const
+    {
+        return current;
+    }
+
+    /// Secondary state for the current physics state.
+    /// Recalculated on demand if the current state has changed since it was last calculated.
+
+    const Secondary &secondary() const
+    {
+        if (dirty)
+        {
+            cache.calculate(current, properties);
+            dirty = false;
+        }
+        return cache;
+    }
+
+    Properties properties;      ///< mass properties of the cube.
+
+    bool canSleep;              ///< if false the cube never goes to sleep.
+    bool managedSleep;          ///< if true the cube never goes to sleep by itself, its owner calls sleep when it is resting (see Scene islands).
+	
+private:
+
+    #ifndef HEADLESS
+
+    /// render shadow volume
+
+    static void renderShadowVolume(const Properties &properties, const Vector &light)
+    {
+        glBegin(GL_QUADS);
+
+        const float s = properties.size * 0.5f;
+
+        silhouette(light, Vector(-s,+s,-s), Vector(+s,+s,-s));
+        silhouette(light, Vector(+s,+s,-s), Vector(+s,+s,+s));
+        silhouette(light, Vector(+s,+s,+s), Vector(-s,+s,+s));
+        silhouette(light, Vector(-s,+s,+s), Vector(-s,+s,-s));
+
+        silhouette(light, Vector(-s,-s,-s), Vector(+s,-s,-s));
+        silhouette(light, Vector(+s,-s,-s), Vector(+s,-s,+s));
+        silhouette(light, Vector(+s,-s,+s), Vector(-s,-s,+s));
+        silhouette(light, Vector(-s,-s,+s), Vector(-s,-s,-s));
+
+        silhouette(light, Vector(-s,+s,-s), Vector(-s,-s,-s));
+        silhouette(light, Vector(+s,+s,-s), Vector(+s,-s,-s));
+        silhouette(light, Vector(+s,+s,+s), Vector(+s,-s,+s));
+        silhouette(light, Vector(-s,+s,+s), Vector(-s,-s,+s));
+
+        glEnd();
+    }
+
+    /// test and render edge a-b if its a silhouette edge relative to light
+
+    static void silhouette(const Vector &light, const Vector &edgeA, const Vector &edgeB)
+    {
+        Vector a = edgeA;
+        Vector b = edgeB;
+
+        // determine edge normals
+
+        Vector midpoint = (a + b) * 0.5f;
+        
+        Vector leftNormal;
+
+        if (midpoint.x!=0)
+            leftNormal = Vector(midpoint.x, 0, 0);
+        else
+            leftNormal = Vector(0, midpoint.y, 0);
+
+        Vector rightNormal = midpoint - leftNormal;
+
+        // check if silhouette edge
+
+        const Vector differenceA = a - light;
+
+        const float leftDot = leftNormal.dot(differenceA);
+        const float rightDot = rightNormal.dot(differenceA);
+
+        if ((leftDot<0 && rightDot>0) || (leftDot>0 && rightDot<0))
+        {
+            // extrude quad
+
+            const Vector differenceB = b - light;
+
+            Vector _a = a + differenceA * 100;
+            Vector _b = b + differenceB * 100;
+
+            // ensure correct winding order for silhouette edge
+
+            const Vector cross = (b - a).cross(differenceA);
+            
+            if (cross.dot(a)<0)
+            {
+                Vector t = a;
+                a = b;
+                b = t;
+
+                t = _a;
+                _a = _b;
+                _b = t;
+            }
+
+            // render extruded quad
+
+            glVertex3f(a.x, a.y, a.z); 
+            glVertex3f(b.x, b.y, b.z);
+            glVertex3f(_b.x, _b.y, _b.z);
+            glVertex3f(_a.x, _a.y, _a.z); 
+        }
+    }
+
+    #endif
+
+    /// Interpolate between two physics states.
+	
+	static State interpolate(const State &a, const State &b, float alpha)
+	{
+		State state = b;
+		state.position = a.position*(1-alpha) + b.position*alpha;
+		state.momentum = a.momentum*(1-alpha) + b.momentum*alpha;
+		state.orientation = slerp(a.orientation, b.orientation, alpha);
+		state.angularMomentum = a.angularMomentum*(1-alpha) + b.angularMomentum*alpha;
+		state.orientation.normalize();
+		return state;
+	}
+
+	State previous;		///< previous physics state.
+    State current;		///< current physics state.
+
+    mutable Secondary cache;    ///< secondary state for the current physics state.
+    mutable bool dirty;         ///< true if cache needs to be recalculated.
+
+    bool asleep;                ///< true if the cube is sleeping.
+    int restTicks;              ///< number of consecutive updates the cube has been at rest.
+    int restContacts;           ///< number of contacts at the end of the previous update.
+    unsigned int restPlanes;    ///< hash of the planes the sleeping cube is inside, see disturbed.
+    bool restPlanesKnown;       ///< true once restPlanes has been recorded for the current sleep.
+
+    /// Update rest detection after integrating.
+    ///
+    /// The cube goes to sleep after it has been slow for a number of
+    /// consecutive updates with an unchanging set of contacts. Two sets
+    /// of thresholds are used for hysteresis: the rest counter only
+    /// advances while the cube is below the sleep thresholds and is only
+    /// reset once the cube exceeds the higher wake thresholds, so a cube
+    /// jittering around a single threshold still settles.
+
+    void rest()
+    {
+        const float sleepLinear = 0.05f;
+        const float sleepAngular = 0.05f;
+        const float wakeLinear = 0.1f;
+        const float wakeAngular = 0.1f;
+
+        const int contacts = statistics.lastContacts;
+
+        const float linear = cache.velocity.lengthSquared();
+        const float angular = cache.angularVelocity.lengthSquared();
+
+        if (contacts!=restContacts || linear>wakeLinear*wakeLinear || angular>wakeAngular*wakeAngular)
+            restTicks = 0;
+        else if (linear<sleepLinear*sleepLinear && angular<sleepAngular*sleepAngular)
+            restTicks++;
+
+        restContacts = contacts;
+
+        if (canSleep && !managedSleep && resting())
+            sleep();
+    }
+
+    static const int sleepTicks = 50;       ///< number of updates at rest before a cube can sleep.
+
+    /// Derivative values for primary state.
+    /// This structure stores all derivative values for primary state in Cube::State.
+    /// For example velocity is the derivative of position, force is the derivative
+    /// of momentum etc. Storing all derivatives in this structure makes it easy
+    /// to implement the RK4 integrator cleanly because it needs to calculate the
+    /// and store derivative values at several points each timestep.
+
+	struct Derivative
+	{
+		Vector velocity;                ///< velocity is the derivative of position.
+		Vector force;                   ///< force in the derivative of momentum.
+		Quaternion spin;                ///< spin is the derivative of the orientation quaternion.
+		Vector torque;                  ///< torque is the derivative of angular momentum.
+		int contacts;                   ///< number of corner contacts found while evaluating.
+	};	
+
+    /// Evaluate all derivative values for the physics state at time t.
+    /// @param input the current input data.
+    /// @param planes the set of all collision planes in the scene.
+    /// @param properties the cube mass properties.
+    /// @param state the physics state of the cube.
+    /// @param secondary the secondary state calculated from state.
+
+	static Derivative evaluate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, const State &state, const Secondary &secondary)
+	{
+		Derivative output;
+		output.velocity = secondary.velocity;
+		output.spin = secondary.spin;
+		output.contacts = forces(input, planes, properties, state, secondary, output.force, output.torque);
+		return output;
+	}
+	
+    /// Evaluate derivative values for the physics state at future time t+dt 
+    /// using the specified set of derivatives to advance dt seconds from the 
+    /// specified physics state.
+    /// @param input the current input data.
+    /// @param planes the set of all collision planes in the scene.
+    /// @param properties the cube mass properties.
+    /// @param initial the physics state of the cube at the start of the timestep.
+    /// @param dt the time in seconds to advance forward.
+    /// @param derivative the set of derivative values to use to advance forward in time from initial.
+
+	static Derivative evaluate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, const State &initial, float dt, const Derivative &derivative)
+	{
+        State state = initial;
+
+		state.position += derivative.velocity * dt;
+		state.momentum += derivative.force * dt;
+		state.orientation += derivative.spin * dt;
+		state.angularMomentum += derivative.torque * dt;
+        state.orientation.normalize();
+
+        Secondary secondary;
+        secondary.calculate(state, properties);
+		
+		Derivative output;
+		output.velocity = secondary.velocity;
+		output.spin = secondary.spin;
+		output.contacts = forces(input, planes, properties, state, secondary, output.force, output.torque);
+		return output;
+	}
+
+    /// Integrate physics state forward by dt seconds.
+    /// The integrator policy selects how the derivatives are combined, see
+    /// RK4Integrator, EulerIntegrator, VerletIntegrator, MidpointIntegrator,
+    /// ImplicitIntegrator and AdaptiveIntegrator.
+    /// On entry secondary must hold the secondary state for state, on exit it
+    /// holds the secondary state for the integrated state.
+    /// If statistics is non-null the contact counts for each stage are written to it.
+
+    template <class Policy> static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics = 0)
+    {
+        Policy::integrate(input, planes, properties, state, secondary, dt, statistics);
+    }
+
+    /// Classic fourth order Runge-Kutta integrator.
+    /// Accurately numerically integrates with error O(5). This involves 
+    /// evaluating derivatives at four points in the timestep using the 
+    /// Cube::evaluate method then updating the primary state values as 
+    /// a weighted sum of these values then finally recalculating secondary state.
+
+    struct RK4Integrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+		{
+            #ifdef PROFILING
+            const double start = timer();
+            #endif
+
+			Derivative a = evaluate(input, planes, properties, state, secondary);
+
+            #ifdef PROFILING
+            const double stageA = timer();
+            #endif
+
+			Derivative b = evaluate(input, planes, properties, state, dt*0.5f, a);
+
+            #ifdef PROFILING
+            const double stageB = timer();
+            #endif
+
+			Derivative c = evaluate(input, planes, properties, state, dt*0.5f, b);
+
+            #ifdef PROFILING
+            const double stageC = timer();
+            #endif
+
+			Derivative d = evaluate(input, planes, properties, state, dt, c);
+
+            #ifdef PROFILING
+            const double stageD = timer();
+            #endif
+
+            if (statistics)
+            {
+                statistics->contacts[0] = a.contacts;
+                statistics->contacts[1] = b.contacts;
+                statistics->contacts[2] = c.contacts;
+                statistics->contacts[3] = d.contacts;
+                statistics->lastContacts = d.contacts;
+                statistics->evaluations = 4;
+                statistics->substeps = 1;
+
+                #ifdef PROFILING
+                statistics->stageTime[0] = stageA - start;
+                statistics->stageTime[1] = stageB - stageA;
+                statistics->stageTime[2] = stageC - stageB;
+                statistics->stageTime[3] = stageD - stageC;
+                #endif
+            }
+		
+			state.position += 1.0f/6.0f * dt * (a.velocity + 2.0f*(b.velocity + c.velocity) + d.velocity);
+			state.momentum += 1.0f/6.0f * dt * (a.force + 2.0f*(b.force + c.force) + d.force);
+			state.orientation += 1.0f/6.0f * dt * (a.spin + 2.0f*(b.spin + c.spin) + d.spin);
+			state.angularMomentum += 1.0f/6.0f * dt * (a.torque + 2.0f*(b.torque + c.torque) + d.torque);
+            state.orientation.normalize();
+			secondary.calculate(state, properties);
+		}	
+    };
+
+    #ifdef FIXED_POINT
+
+    /// Derivatives of the fixed point state, see Derivative.
+
+    struct FixedDerivative
+    {
+        FixedVector velocity;
+        FixedVector force;
+        FixedQuaternion spin;
+        FixedVector torque;
+        int contacts;
+    };
+
+    /// Evaluate fixed point derivatives at the start of the timestep.
+
+    static FixedDerivative evaluate(const Input &input, const std::vector<Plane> &planes, const FixedProperties &properties, const FixedState &state, const FixedSecondary &secondary)
+    {
+        FixedDerivative output;
+        output.velocity = secondary.velocity;
+        output.spin = secondary.spin;
+        output.contacts = forces(input, planes, properties, state, secondary, output.force, output.torque);
+        return output;
+    }
+
+    /// Evaluate fixed point derivatives at time t+dt*fraction using the derivative to advance from state.
+    /// The fraction is applied after the timestep so that a half step is not limited by the resolution of dt/2.
+
+    static FixedDerivative evaluate(const Input &input, const std::vector<Plane> &planes, const FixedProperties &properties, FixedState state, Fixed dt, Fixed fraction, const FixedDerivative &derivative)
+    {
+        state.position += derivative.velocity * dt * fraction;
+        state.momentum += derivative.force * dt * fraction;
+        state.orientation += derivative.spin * dt * fraction;
+        state.angularMomentum += derivative.torque * dt * fraction;
+        state.orientation.normalize();
+
+        FixedSecondary secondary;
+        secondary.calculate(state, properties);
+
+        FixedDerivative output;
+        output.velocity = secondary.velocity;
+        output.spin = secondary.spin;
+        output.contacts = forces(input, planes, properties, state, secondary, output.force, output.torque);
+        return output;
+    }
+
+    /// Calculate fixed point force and torque, see the floating point version.
+
+    static int forces(const Input &input, const std::vector<Plane> &planes, const FixedProperties &properties, const FixedState &state, const FixedSecondary &secondary, FixedVector &force, FixedVector &torque)
+    {
+        force.zero();
+        torque.zero();
+
+        FixedCorners corners;
+        if (Forces::corners)
+            calculateCorners(properties, state, secondary, corners);
+
+        return Forces::apply(input, planes, properties, state, secondary, corners, force, torque);
+    }
+
+    /// Fourth order Runge-Kutta integrator in Q16.16 fixed point.
+    /// Used in place of RK4Integrator in FIXED_POINT builds. The state is
+    /// rounded to fixed point on the way in and converted back on the way out,
+    /// both of which are exact roundings, and everything in between is integer
+    /// arithmetic, so the result is bit identical on every platform.
+
+    struct FixedRK4Integrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+        {
+            const FixedProperties fixedProperties(properties);
+            FixedState fixedState(state);
+            fixedState.orientation.normalize();
+
+            FixedSecondary fixedSecondary;
+            fixedSecondary.calculate(fixedState, fixedProperties);
+
+            const Fixed h(dt);
+            const Fixed one = Fixed::bits(65536);
+            const Fixed half = Fixed::bits(32768);
+            const Fixed two = Fixed::bits(131072);
+            static const Fixed sixth(1.0f/6.0f);
+
+            FixedDerivative a = evaluate(input, planes, fixedProperties, fixedState, fixedSecondary);
+            FixedDerivative b = evaluate(input, planes, fixedProperties, fixedState, h, half, a);
+            FixedDerivative c = evaluate(input, planes, fixedProperties, fixedState, h, half, b);
+            FixedDerivative d = evaluate(input, planes, fixedProperties, fixedState, h, one, c);
+
+            if (statistics)
+            {
+                statistics->contacts[0] = a.contacts;
+                statistics->contacts[1] = b.contacts;
+                statistics->contacts[2] = c.contacts;
+                statistics->contacts[3] = d.contacts;
+                statistics->lastContacts = d.contacts;
+                statistics->evaluations = 4;
+                statistics->substeps = 1;
+            }
+
+            fixedState.position += (a.velocity + (b.velocity + c.velocity) * two + d.velocity) * h * sixth;
+            fixedState.momentum += (a.force + (b.force + c.force) * two + d.force) * h * sixth;
+            fixedState.orientation += (a.spin + (b.spin + c.spin) * two + d.spin) * h * sixth;
+            fixedState.angularMomentum += (a.torque + (b.torque + c.torque) * two + d.torque) * h * sixth;
+            fixedState.orientation.normalize();
+
+            fixedState.get(state);
+            secondary.calculate(state, properties);
+        }
+    };
+
+    #endif
+
+    /// Semi-implicit (symplectic) Euler integrator.
+    /// Evaluates forces once, updates momentum first, then advances position
+    /// and orientation with the updated velocity and spin. One evaluation per
+    /// step, first order accurate but much better behaved than explicit Euler.
+
+    struct EulerIntegrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+        {
+            Derivative a = evaluate(input, planes, properties, state, secondary);
+
+            state.momentum += a.force * dt;
+            state.angularMomentum += a.torque * dt;
+            secondary.calculate(state, properties);
+
+            state.position += secondary.velocity * dt;
+            state.orientation += secondary.spin * dt;
+            state.orientation.normalize();
+            secondary.calculate(state, properties);
+
+            if (statistics)
+            {
+                statistics->contacts[0] = a.contacts;
+                statistics->lastContacts = a.contacts;
+                statistics->evaluations = 1;
+                statistics->substeps = 1;
+            }
+        }
+    };
+
+    /// Velocity verlet integrator (kick, drift, kick).
+    /// Applies half of the force at the start of the step, advances position
+    /// and orientation with the resulting velocity, then applies half of the 
+    /// force evaluated at the new position. Two evaluations per step, second
+    /// order accurate and good at conserving energy.
+
+    struct VerletIntegrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+        {
+            const float halfStep = dt * 0.5f;
+
+            Derivative a = evaluate(input, planes, properties, state, secondary);
+
+            state.momentum += a.force * halfStep;
+            state.angularMomentum += a.torque * halfStep;
+            secondary.calculate(state, properties);
+
+            state.position += secondary.velocity * dt;
+            state.orientation += secondary.spin * dt;
+            state.orientation.normalize();
+            secondary.calculate(state, properties);
+
+            Derivative b = evaluate(input, planes, properties, state, secondary);
+
+            state.momentum += b.force * halfStep;
+            state.angularMomentum += b.torque * halfStep;
+            secondary.calculate(state, properties);
+
+            if (statistics)
+            {
+                statistics->contacts[0] = a.contacts;
+                statistics->contacts[1] = b.contacts;
+                statistics->lastContacts = b.contacts;
+                statistics->evaluations = 2;
+                statistics->substeps = 1;
+            }
+        }
+    };
+
+    /// Midpoint (second order Runge-Kutta) integrator.
+    /// Evaluates derivatives at the start of the step, uses them to advance
+    /// half a step, then advances the whole step with the derivatives at the
+    /// midpoint. Two evaluations per step.
+
+    struct MidpointIntegrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+        {
+            Derivative a = evaluate(input, planes, properties, state, secondary);
+            Derivative b = evaluate(input, planes, properties, state, dt*0.5f, a);
+
+            state.position += b.velocity * dt;
+            state.momentum += b.force * dt;
+            state.orientation += b.spin * dt;
+            state.angularMomentum += b.torque * dt;
+            state.orientation.normalize();
+            secondary.calculate(state, properties);
+
+            if (statistics)
+            {
+                statistics->contacts[0] = a.contacts;
+                statistics->contacts[1] = b.contacts;
+                statistics->lastContacts = b.contacts;
+                statistics->evaluations = 2;
+                statistics->substeps = 1;
+            }
+        }
+    };
+
+    /// Adaptive Dormand-Prince 5(4) integrator.
+    ///
+    /// Covers the timestep with as many sub-steps as needed to keep the 
+    /// difference between an embedded fifth and fourth order solution within
+    /// tolerance. In free flight the forces are smooth and a single sub-step 
+    /// covers the whole timestep, while impacts against the stiff contact 
+    /// springs get subdivided. Each sub-step costs six evaluations, the 
+    /// seventh is reused as the first of the next sub-step (first same as last).
+    ///
+    /// The outer timestep is unchanged so networking and history are unaffected.
+    /// The number of sub-steps taken is written to Statistics::substeps.
+
+    struct AdaptiveIntegrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+        {
+            const float positionTolerance = 0.0001f;            // meters
+            const float orientationTolerance = 0.0001f;         // quaternion units
+            const float velocityTolerance = 0.001f;             // meters per second (and radians per second)
+            const float minimumStep = dt / 64;
+
+            // dormand-prince coefficients
+
+            static const float a[7][6] = 
+            {
+                { 0 },
+                { 1.0f/5 },
+                { 3.0f/40, 9.0f/40 },
+                { 44.0f/45, -56.0f/15, 32.0f/9 },
+                { 19372.0f/6561, -25360.0f/2187, 64448.0f/6561, -212.0f/729 },
+                { 9017.0f/3168, -355.0f/33, 46732.0f/5247, 49.0f/176, -5103.0f/18656 },
+                { 35.0f/384, 0, 500.0f/1113, 125.0f/192, -2187.0f/6784, 11.0f/84 }
+            };
+
+            static const float error[7] = 
+            {
+                35.0f/384 - 5179.0f/57600, 
+                0, 
+                500.0f/1113 - 7571.0f/16695, 
+                125.0f/192 - 393.0f/640, 
+                -2187.0f/6784 + 92097.0f/339200, 
+                11.0f/84 - 187.0f/2100, 
+                -1.0f/40
+            };
+
+            const float momentumTolerance = velocityTolerance * properties.mass;
+            const float angularMomentumTolerance = velocityTolerance * properties.inertiaTensor;
+
+            Derivative k[7];
+            k[0] = evaluate(input, planes, properties, state, secondary);
+
+            if (statistics)
+                statistics->contacts[0] = k[0].contacts;
+
+            int evaluations = 1;
+            int substeps = 0;
+
+            float time = 0;
+            float h = dt;
+
+            while (time<dt)
+            {
+                if (h>dt-time)
+                    h = dt-time;
+
+                for (int i=1; i<7; i++)
+                {
+                    k[i] = evaluate(input, planes, properties, state, h, combine(k, a[i], i));
+                    if (statistics && evaluations<4)
+                        statistics->contacts[evaluations] = k[i].contacts;
+                    evaluations++;
+                }
+
+                // error estimate is the difference between fifth and fourth order solutions
+
+                const Derivative e = combine(k, error, 7);
+
+                const float ratio = maximum(maximum((e.velocity * h).length() / positionTolerance, 
+                                                    (e.spin * h).length() / orientationTolerance), 
+                                            maximum((e.force * h).length() / momentumTolerance, 
+                                                    (e.torque * h).length() / angularMomentumTolerance));
+
+                if (ratio<=1 || h<=minimumStep)
+                {
+                    // accept fifth order solution
+
+                    const Derivative &step = k[6];
+                    const Derivative solution = combine(k, a[6], 6);
+
+                    state.position += solution.velocity * h;
+                    state.momentum += solution.force * h;
+                    state.orientation += solution.spin * h;
+                    state.angularMomentum += solution.torque * h;
+                    state.orientation.normalize();
+                    secondary.calculate(state, properties);
+
+                    k[0] = step;
+
+                    time += h;
+                    substeps++;
+                }
+
+                // adjust step size. the classic controller exponent is -1/5 but the
+                // fourth root keeps it to square roots, which are deterministic.
+
+                float scale = ratio>0 ? 0.9f / Mathematics::sqrt(Mathematics::sqrt(ratio)) : 5.0f;
+                if (scale<0.2f)
+                    scale = 0.2f;
+                if (scale>5.0f)
+                    scale = 5.0f;
+
+                h *= scale;
+                if (h<minimumStep)
+                    h = minimumStep;
+            }
+
+            if (statistics)
+            {
+                statistics->lastContacts = k[0].contacts;
+                statistics->evaluations = evaluations;
+                statistics->substeps = substeps;
+            }
+        }
+
+        /// Weighted sum of the first n derivatives.
+
+        static Derivative combine(const Derivative k[], const float weight[], int n)
+        {
+            Derivative sum;
+            sum.velocity = k[0].velocity * weight[0];
+            sum.force = k[0].force * weight[0];
+            sum.spin = k[0].spin * weight[0];
+            sum.torque = k[0].torque * weight[0];
+            for (int i=1; i<n; i++)
+            {
+                sum.velocity += k[i].velocity * weight[i];
+                sum.force += k[i].force * weight[i];
+                sum.spin += k[i].spin * weight[i];
+                sum.torque += k[i].torque * weight[i];
+            }
+            sum.contacts = 0;
+            return sum;
+        }
+    };
+
+    /// Calculate force and torque for physics state at time t.
+    /// Due to the way that the RK4 integrator works we need to calculate
+    /// force implicitly from state rather than explictly applying forces
+    /// to the rigid body once per update. This is because the RK4 achieves
+    /// its accuracy by detecting curvature in derivative values over the 
+    /// timestep so we need our force values to supply the curvature.
+    /// The force terms applied are selected at compile time by Forces, see
+    /// ForcePipeline. The cube corners are transformed to world space once
+    /// here and shared by the terms that need them.
+    /// @returns the number of corner contacts found.
+
+	static int forces(const Input &input, const std::vector<Plane> &planes, const Properties &properties, const State &state, const Secondary &secondary, Vector &force, Vector &torque)
+	{
+		force.zero();
+		torque.zero();
+
+        Corners corners;
+        if (Forces::corners)
+            calculateCorners(properties, secondary, corners);
+		
+        const int contacts = Forces::apply(input, planes, properties, state, secondary, corners, force, torque);
+
+        assert(force==force);
+        assert(torque==torque);
+
+        return contacts;
+	}
+
+    /// Semi-implicit integrator with implicit contact springs.
+    ///
+    /// Applies the non contact force terms explicitly, then resolves the plane
+    /// contacts as impulses whose size comes from an implicit step of the
+    /// springs and dampers in Cube::collisionForPoint, see Cube::implicitCollision.
+    /// Finally position and orientation are advanced with the resulting velocities.
+    ///
+    /// One force evaluation per step and stable for any timestep. Compared with
+    /// RK4 at 100Hz in the "timesteps" section of Benchmark.cpp, the resting
+    /// penetration is the same at 30-100Hz and landings sink less, but each
+    /// step loses some energy in the contact springs, so pushes out of a plane
+    /// are weaker and the trajectory drifts a meter or more from RK4 within a
+    /// second (about 3m at 30Hz). RK4 itself stays stable at 30Hz in this scene
+    /// with four times the evaluations, and follows the 100Hz trajectory closely.
+
+    struct ImplicitIntegrator
+    {
+        static void integrate(const Input &input, const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, float dt, Statistics *statistics)
+        {
+            Corners corners;
+            if (Forces::corners)
+                calculateCorners(properties, secondary, corners);
+
+            Vector force(0,0,0);
+            Vector torque(0,0,0);
+
+            Forces::applyBody(input, planes, properties, state, secondary, corners, force, torque);
+
+            state.momentum += force * dt;
+            state.angularMomentum += torque * dt;
+            secondary.velocity = state.momentum * properties.inverseMass;
+            secondary.angularVelocity = state.angularMomentum * properties.inverseInertiaTensor;
+
+            const int contacts = Forces::contacts ? implicitCollision(planes, properties, state, secondary, corners, dt) : 0;
+
+            state.position += secondary.velocity * dt;
+            secondary.calculate(state, properties);
+            state.orientation += secondary.spin * dt;
+            state.orientation.normalize();
+            secondary.calculate(state, properties);
+
+            if (statistics)
+            {
+                statistics->contacts[0] = contacts;
+                statistics->lastContacts = contacts;
+                statistics->evaluations = 1;
+                statistics->substeps = 1;
+            }
+        }
+    };
+
+    /// A contact point being resolved by Cube::implicitCollision.
+
+    struct Contact
+    {
+        Vector r;                       ///< contact point relative to the center of mass.
+        Vector normal;                  ///< plane normal.
+        Vector tangent[2];              ///< tangent directions for friction.
+        Vector surface;                 ///< velocity of the plane surface.
+        float mass;                     ///< inverse effective mass along the normal.
+        float tangentMass[2];           ///< inverse effective mass along each tangent.
+        float softness;                 ///< inverse of the implicit spring and damper stiffness along the normal.
+        float bias;                     ///< normal speed the spring is pushing towards.
+        float tangentSoftness;          ///< inverse of the implicit friction stiffness.
+        float impulse;                  ///< accumulated normal impulse.
+        float tangentImpulse[2];        ///< accumulated friction impulse along each tangent.
+        bool touching;                  ///< true if the corner is inside the plane at the start of the step.
+    };
+
+    /// Resolve contacts against planes with implicit contact impulses.
+    ///
+    /// Along the normal the spring (k) and dampers (b scaled by penetration,
+    /// plus c while approaching) of Cube::collisionForPoint are integrated
+    /// implicitly. For one contact the separating speed u at the end of the
+    /// step and the contact impulse P satisfy
+    ///
+    ///     P = dt ( k (penetration - u dt / 2) - d u )
+    ///
+    /// so the spring pushes with its depth halfway through the step. This is
+    /// stable for any k and dt and loses half as much energy per step as
+    /// backward euler (u dt). Corners that are not inside a plane yet but
+    /// will cross it during the step at their current speed are contacts too,
+    /// with a negative penetration, so a fast cube is caught before it sinks
+    /// deep into the plane instead of a step later. Several contacts are
+    /// solved together by iterating over them, each time correcting the
+    /// accumulated impulse towards this relation given the velocity left by
+    /// the others. The normal impulse never pulls the cube into the plane.
+    /// Tangential friction is solved the same way with P = -f dt v.
+    ///
+    /// @param planes the set of collision planes in the scene.
+    /// @param properties the cube mass properties.
+    /// @param state the cube physics state, momentum and angular momentum are updated.
+    /// @param secondary the cube secondary state, velocity and angular velocity are updated.
+    /// @param corners the cube corners in world space.
+    /// @param dt the timestep in seconds.
+    /// @returns the number of corner contacts.
+
+    static int implicitCollision(const std::vector<Plane> &planes, const Properties &properties, State &state, Secondary &secondary, const Corners &corners, float dt)
+    {
+        const float c = 10;
+        const float k = 100;
+        const float b = 5;
+        const float f = 3;
+
+        const int maximumContacts = 32;
+        const int iterations = 4;
+
+        const float radius = properties.size * 0.87f;
+
+        Contact contacts[maximumContacts];
+        int count = 0;
+
+        for (unsigned int i=0; i<planes.size(); i++)
+        {
+            const Plane &plane = planes[i];
+
+            const float reach = radius + ( secondary.velocity - plane.velocity ).length() * dt + radius * secondary.angularVelocity.length() * dt;
+
+            if (state.position.dot(plane.normal) - plane.constant > reach)
+                continue;
+
+            float penetration[8];
+
+            penetrations(corners, plane, penetration);
+
+            for (int j=0; j<8 && count<maximumContacts; j++)
+            {
+                const Vector r = corners.point(j) - state.position;
+                const float speed = plane.normal.dot(secondary.angularVelocity.cross(r) + secondary.velocity - plane.velocity);
+
+                if (penetration[j] - speed * dt > 0)
+                {
+                    Contact &contact = contacts[count++];
+
+                    contact.r = r;
+                    contact.normal = plane.normal;
+                    contact.surface = plane.velocity;
+
+                    const Vector axis = Mathematics::abs(plane.normal.x)<0.9f ? Vector(1,0,0) : Vector(0,1,0);
+                    contact.tangent[0] = plane.normal.cross(axis).unit();
+                    contact.tangent[1] = plane.normal.cross(contact.tangent[0]);
+
+                    const Vector rn = contact.r.cross(contact.normal);
+                    contact.mass = properties.inverseMass + rn.dot(rn) * properties.inverseInertiaTensor;
+
+                    for (int t=0; t<2; t++)
+                    {
+                        const Vector rt = contact.r.cross(contact.tangent[t]);
+                        contact.tangentMass[t] = properties.inverseMass + rt.dot(rt) * properties.inverseInertiaTensor;
+                        contact.tangentImpulse[t] = 0;
+                    }
+
+                    const float d = b * ( penetration[j]>0 ? penetration[j] : 0 ) + (speed<0 ? c : 0);
+                    const float stiffness = 0.5f * dt * dt * k + dt * d;
+
+                    contact.softness = 1.0f / stiffness;
+                    contact.bias = dt * k * penetration[j] * contact.softness;
+                    contact.tangentSoftness = 1.0f / (f * dt);
+                    contact.impulse = 0;
+                    contact.touching = penetration[j] > 0;
+                }
+            }
+        }
+
+        for (int iteration=0; iteration<iterations; iteration++)
+        {
+            for (int i=0; i<count; i++)
+            {
+                Contact &contact = contacts[i];
+
+                // normal
+
+                Vector velocity = secondary.angularVelocity.cross(contact.r) + secondary.velocity - contact.surface;
+
+                const float speed = contact.normal.dot(velocity);
+                float delta = (contact.bias - speed - contact.softness * contact.impulse) / (contact.mass + contact.softness);
+                if (contact.impulse + delta < 0)
+                    delta = -contact.impulse;
+                contact.impulse += delta;
+
+                applyImpulse(properties, state, secondary, contact.normal * delta, contact.r);
+
+                // friction, only once a corner that was not inside the plane has hit it
+
+                if (!contact.touching && contact.impulse <= 0)
+                    continue;
+
+                velocity = secondary.angularVelocity.cross(contact.r) + secondary.velocity - contact.surface;
+
+                for (int t=0; t<2; t++)
+                {
+                    const float tangentSpeed = contact.tangent[t].dot(velocity);
+                    const float tangentDelta = (- tangentSpeed - contact.tangentSoftness * contact.tangentImpulse[t]) / (contact.tangentMass[t] + contact.tangentSoftness);
+                    contact.tangentImpulse[t] += tangentDelta;
+                    applyImpulse(properties, state, secondary, contact.tangent[t] * tangentDelta, contact.r);
+                }
+            }
+        }
+
+        return count;
+    }
+
+    /// Apply an impulse at offset r from the center of mass and update velocities.
+
+    static void applyImpulse(const Properties &properties, State &state, Secondary &secondary, const Vector &impulse, const Vector &r)
+    {
+        assert(impulse==impulse);
+        state.momentum += impulse;
+        state.angularMomentum += r.cross(impulse);
+        secondary.velocity = state.momentum * properties.inverseMass;
+        secondary.angularVelocity = state.angularMomentum * properties.inverseInertiaTensor;
+    }
+
+};
+
+/// Player controlled cube with all force terms.
+
+typedef BasicCube< ForcePipeline<Gravity, Damping, PlaneContacts, PlayerControl> > Cube;
+
+/// Static prop that collides with the world but ignores input.
+
+typedef BasicCube< ForcePipeline<Gravity, Damping, PlaneContacts> > PropCube;
+
+/// Projectile in free flight that never reaches the collision planes.
+
+typedef BasicCube< ForcePipeline<Gravity, Damping> > ProjectileCube;
@@ -0,0 +1,897 @@
+/// A batch of cubes simulated together.
+///
+/// This class integrates many cubes at once using the same force model as
+/// Cube, but instead of one State object per cube, each component of the
+/// physics state is kept in its own contiguous array (structure of arrays).
+/// Each stage of the RK4 integrator (evaluate, forces, recalculate) then runs
+/// as a tight loop over the whole batch instead of as a chain of per object
+/// calls. This is how a server steps thousands of bodies per tick.
+///
+/// Built with SSE, recalculate and the plane collision work on four cubes at a
+/// time in registers. Without SSE the loops stay scalar and the only gain is the
+/// memory layout. The "batch" section of Benchmark.cpp times both against the
+/// same cubes updated one at a time, from 256 up to 32768 cubes.
+///
+/// The per body results are identical to Cube::update, so a cube can be moved
+/// in and out of a batch without a pop. FIXED_POINT builds are the exception:
+/// Cube quantizes its state each step and the batch does not. The planes are
+/// treated as static world geometry (Plane::velocity is ignored) and the cubes
+/// in a batch do not collide with each other, use Scene props for that.
+
+class CubeBatch
+{
+public:
+
+    /// Default constructor.
+
+    CubeBatch()
+    {
+        count = 0;
+    }
+
+    /// Add a cube to the batch.
+    /// @param state the initial physics state of the cube.
+    /// @param properties the mass properties of the cube.
+    /// @returns the index of the cube in the batch.
+
+    int add(const Cube::State &state, const Cube::Properties &properties)
+    {
+        const int index = count++;
+
+        current.resize(count);
+        scratch.resize(count);
+        secondary.resize(count);
+        scratchSecondary.resize(count);
+        for (int i=0; i<4; i++)
+            derivatives[i].resize(count);
+
+        size.resize(count);
+        mass.resize(count);
+        inverseMass.resize(count);
+        inertiaTensor.resize(count);
+        inverseInertiaTensor.resize(count);
+
+        size[index] = properties.size;
+        mass[index] = properties.mass;
+        inverseMass[index] = properties.inverseMass;
+        inertiaTensor[index] = properties.inertiaTensor;
+        inverseInertiaTensor[index] = properties.inverseInertiaTensor;
+
+        Cube::Input input;
+        input.left = false;
+        input.right = false;
+        input.forward = false;
+        input.back = false;
+        input.jump = false;
+        inputs.push_back(input);
+
+        snap(index, state);
+
+        return index;
+    }
+
+    /// Remove all cubes from the batch.
+
+    void clear()
+    {
+        count = 0;
+        inputs.clear();
+    }
+
+    /// Number of cubes in the batch.
+
+    int cubes() const
+    {
+        return count;
+    }
+
+    /// Input data for the cube at index.
+
+    Cube::Input& input(int index)
+    {
+        assert(index>=0);
+        assert(index<count);
+        return inputs[index];
+    }
+
+    /// Set the physics state of the cube at index.
+
+    void snap(int index, const Cube::State &state)
+    {
+        assert(index>=0);
+        assert(index<count);
+
+        current.position.set(index, state.position);
+        current.momentum.set(index, state.momentum);
+        current.orientation.set(index, state.orientation);
+        current.angularMomentum.set(index, state.angularMomentum);
+
+        calculate(current, secondary, index);
+    }
+
+    /// Get the physics state of the cube at index.
+
+    Cube::State state(int index) const
+    {
+        assert(index>=0);
+        assert(index<count);
+
+        Cube::State state;
+        state.position = current.position.get(index);
+        state.momentum = current.momentum.get(index);
+        state.orientation = current.orientation.get(index);
+        state.angularMomentum = current.angularMomentum.get(index);
+        return state;
+    }
+
+    /// Update physics state of all cubes in the batch.
+    /// @param planes the set of world collision planes to collide against.
+    /// @param dt delta time to advance ahead in seconds.
+
+    void update(const std::vector<Plane> &planes, float dt)
+    {
+        if (count==0)
+            return;
+
+        integrate(planes, dt);
+    }
+
+private:
+
+    /// A contiguous array of vectors stored as separate x,y,z arrays.
+
+    struct Vectors
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        void resize(int size)
+        {
+            x.resize(size);
+            y.resize(size);
+            z.resize(size);
+        }
+
+        Vector get(int i) const
+        {
+            return Vector(x[i], y[i], z[i]);
+        }
+
+        void set(int i, const Vector &vector)
+        {
+            x[i] = vector.x;
+            y[i] = vector.y;
+            z[i] = vector.z;
+        }
+    };
+
+    /// A contiguous array of quaternions stored as separate w,x,y,z arrays.
+
+    struct Quaternions
+    {
+        std::vector<float> w;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        void resize(int size)
+        {
+            w.resize(size);
+            x.resize(size);
+            y.resize(size);
+            z.resize(size);
+        }
+
+        Quaternion get(int i) const
+        {
+            return Quaternion(w[i], x[i], y[i], z[i]);
+        }
+
+        void set(int i, const Quaternion &quaternion)
+        {
+            w[i] = quaternion.w;
+            x[i] = quaternion.x;
+            y[i] = quaternion.y;
+            z[i] = quaternion.z;
+        }
+    };
+
+    /// Primary physics state for every cube in the batch.
+
+    struct State
+    {
+        Vectors position;
+        Vectors momentum;
+        Quaternions orientation;
+        Vectors angularMomentum;
+
+        void resize(int size)
+        {
+            position.resize(size);
+            momentum.resize(size);
+            orientation.resize(size);
+            angularMomentum.resize(size);
+        }
+    };
+
+    /// Secondary physics state calculated from a State.
+    /// The rotation is stored as the rows of the 3x3 body to world matrix
+    /// which is all the force calculations need (translation is position).
+
+    struct Secondary
+    {
+        Vectors velocity;
+        Quaternions spin;
+        Vectors angularVelocity;
+        Vectors row1;
+        Vectors row2;
+        Vectors row3;
+
+        void resize(int size)
+        {
+            velocity.resize(size);
+            spin.resize(size);
+            angularVelocity.resize(size);
+            row1.resize(size);
+            row2.resize(size);
+            row3.resize(size);
+        }
+    };
+
+    /// Derivative values for every cube in the batch.
+    /// See Cube::Derivative.
+
+    struct Derivative
+    {
+        Vectors velocity;
+        Vectors force;
+        Quaternions spin;
+        Vectors torque;
+
+        void resize(int size)
+        {
+            velocity.resize(size);
+            force.resize(size);
+            spin.resize(size);
+            torque.resize(size);
+        }
+    };
+
+    /// Normalize orientations and recalculate secondary state values from primary values for all cubes.
+    /// With SSE four cubes are done at a time, with the same operations in the same order as
+    /// Quaternion::normalize, calculate and Quaternion::matrix so the results are the same.
+
+    void recalculate(State &state, Secondary &secondary)
+    {
+        int i = 0;
+
+        #ifdef SSE
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+
+        for (; i+4<=count; i+=4)
+        {
+            __m128 w = _mm_loadu_ps(&state.orientation.w[i]);
+            __m128 x = _mm_loadu_ps(&state.orientation.x[i]);
+            __m128 y = _mm_loadu_ps(&state.orientation.y[i]);
+            __m128 z = _mm_loadu_ps(&state.orientation.z[i]);
+
+            // normalize
+
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+            const __m128 degenerate = _mm_cmpeq_ps(length, zero);
+            const __m128 inverse = _mm_div_ps(one, length);
+
+            w = _mm_or_ps(_mm_and_ps(degenerate, one), _mm_andnot_ps(degenerate, _mm_mul_ps(w, inverse)));
+            x = _mm_andnot_ps(degenerate, _mm_mul_ps(x, inverse));
+            y = _mm_andnot_ps(degenerate, _mm_mul_ps(y, inverse));
+            z = _mm_andnot_ps(degenerate, _mm_mul_ps(z, inverse));
+
+            _mm_storeu_ps(&state.orientation.w[i], w);
+            _mm_storeu_ps(&state.orientation.x[i], x);
+            _mm_storeu_ps(&state.orientation.y[i], y);
+            _mm_storeu_ps(&state.orientation.z[i], z);
+
+            // velocity and angular velocity
+
+            const __m128 inverseMass4 = _mm_loadu_ps(&inverseMass[i]);
+            const __m128 inverseInertia4 = _mm_loadu_ps(&inverseInertiaTensor[i]);
+
+            const __m128 angularVelocityX = _mm_mul_ps(_mm_loadu_ps(&state.angularMomentum.x[i]), inverseInertia4);
+            const __m128 angularVelocityY = _mm_mul_ps(_mm_loadu_ps(&state.angularMomentum.y[i]), inverseInertia4);
+            const __m128 angularVelocityZ = _mm_mul_ps(_mm_loadu_ps(&state.angularMomentum.z[i]), inverseInertia4);
+
+            _mm_storeu_ps(&secondary.velocity.x[i], _mm_mul_ps(_mm_loadu_ps(&state.momentum.x[i]), inverseMass4));
+            _mm_storeu_ps(&secondary.velocity.y[i], _mm_mul_ps(_mm_loadu_ps(&state.momentum.y[i]), inverseMass4));
+            _mm_storeu_ps(&secondary.velocity.z[i], _mm_mul_ps(_mm_loadu_ps(&state.momentum.z[i]), inverseMass4));
+
+            _mm_storeu_ps(&secondary.angularVelocity.x[i], angularVelocityX);
+            _mm_storeu_ps(&secondary.angularVelocity.y[i], angularVelocityY);
+            _mm_storeu_ps(&secondary.angularVelocity.z[i], angularVelocityZ);
+
+            // spin is half the angular velocity as a quaternion times the orientation
+
+            const __m128 hw = _mm_mul_ps(half, zero);
+            const __m128 hx = _mm_mul_ps(angularVelocityX, half);
+            const __m128 hy = _mm_mul_ps(angularVelocityY, half);
+            const __m128 hz = _mm_mul_ps(angularVelocityZ, half);
+
+            _mm_storeu_ps(&secondary.spin.w[i], _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(hw, w), _mm_mul_ps(hx, x)), _mm_mul_ps(hy, y)), _mm_mul_ps(hz, z)));
+            _mm_storeu_ps(&secondary.spin.x[i], _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(hw, x), _mm_mul_ps(hx, w)), _mm_mul_ps(hy, z)), _mm_mul_ps(hz, y)));
+            _mm_storeu_ps(&secondary.spin.y[i], _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(hw, y), _mm_mul_ps(hx, z)), _mm_mul_ps(hy, w)), _mm_mul_ps(hz, x)));
+            _mm_storeu_ps(&secondary.spin.z[i], _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(hw, z), _mm_mul_ps(hx, y)), _mm_mul_ps(hy, x)), _mm_mul_ps(hz, w)));
+
+            // rotation matrix rows
+
+            const __m128 tx = _mm_mul_ps(two, x);
+            const __m128 ty = _mm_mul_ps(two, y);
+            const __m128 tz = _mm_mul_ps(two, z);
+            const __m128 twx = _mm_mul_ps(tx, w);
+            const __m128 twy = _mm_mul_ps(ty, w);
+            const __m128 twz = _mm_mul_ps(tz, w);
+            const __m128 txx = _mm_mul_ps(tx, x);
+            const __m128 txy = _mm_mul_ps(ty, x);
+            const __m128 txz = _mm_mul_ps(tz, x);
+            const __m128 tyy = _mm_mul_ps(ty, y);
+            const __m128 tyz = _mm_mul_ps(tz, y);
+            const __m128 tzz = _mm_mul_ps(tz, z);
+
+            _mm_storeu_ps(&secondary.row1.x[i], _mm_sub_ps(one, _mm_add_ps(tyy, tzz)));
+            _mm_storeu_ps(&secondary.row1.y[i], _mm_sub_ps(txy, twz));
+            _mm_storeu_ps(&secondary.row1.z[i], _mm_add_ps(txz, twy));
+            _mm_storeu_ps(&secondary.row2.x[i], _mm_add_ps(txy, twz));
+            _mm_storeu_ps(&secondary.row2.y[i], _mm_sub_ps(one, _mm_add_ps(txx, tzz)));
+            _mm_storeu_ps(&secondary.row2.z[i], _mm_sub_ps(tyz, twx));
+            _mm_storeu_ps(&secondary.row3.x[i], _mm_sub_ps(txz, twy));
+            _mm_storeu_ps(&secondary.row3.y[i], _mm_add_ps(tyz, twx));
+            _mm_storeu_ps(&secondary.row3.z[i], _mm_sub_ps(one, _mm_add_ps(txx, tyy)));
+        }
+
+        #endif
+
+        for (; i<count; i++)
+        {
+            Quaternion orientation = state.orientation.get(i);
+            orientation.normalize();
+            state.orientation.set(i, orientation);
+
+            calculate(state, secondary, i);
+        }
+    }
+
+    /// Calculate secondary state values from primary values for the cube at index i.
+    /// See Cube::Secondary::calculate.
+
+    void calculate(const State &state, Secondary &secondary, int i)
+    {
+        const Quaternion orientation = state.orientation.get(i);
+
+        const Vector velocity = state.momentum.get(i) * inverseMass[i];
+        const Vector angularVelocity = state.angularMomentum.get(i) * inverseInertiaTensor[i];
+        const Quaternion spin = 0.5f * Quaternion(0, angularVelocity.x, angularVelocity.y, angularVelocity.z) * orientation;
+
+        secondary.velocity.set(i, velocity);
+        secondary.angularVelocity.set(i, angularVelocity);
+        secondary.spin.set(i, spin);
+
+        const Matrix rotation = orientation.matrix();
+        secondary.row1.set(i, Vector(rotation.m11, rotation.m12, rotation.m13));
+        secondary.row2.set(i, Vector(rotation.m21, rotation.m22, rotation.m23));
+        secondary.row3.set(i, Vector(rotation.m31, rotation.m32, rotation.m33));
+    }
+
+    /// Evaluate derivative values for the whole batch at the current state.
+    /// See Cube::evaluate.
+
+    void evaluate(const std::vector<Plane> &planes, Derivative &output)
+    {
+        output.velocity = secondary.velocity;
+        output.spin = secondary.spin;
+
+        forces(planes, current, secondary, output);
+    }
+
+    /// Evaluate derivative values for the whole batch at future time t+dt.
+    /// Advances scratch state dt seconds from the current state using the
+    /// input derivatives, then calculates output derivatives at that point.
+    /// See Cube::evaluate.
+
+    void evaluate(const std::vector<Plane> &planes, float dt, const Derivative &input, Derivative &output)
+    {
+        for (int i=0; i<count; i++)
+        {
+            scratch.position.x[i] = current.position.x[i] + input.velocity.x[i] * dt;
+            scratch.position.y[i] = current.position.y[i] + input.velocity.y[i] * dt;
+            scratch.position.z[i] = current.position.z[i] + input.velocity.z[i] * dt;
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            scratch.momentum.x[i] = current.momentum.x[i] + input.force.x[i] * dt;
+            scratch.momentum.y[i] = current.momentum.y[i] + input.force.y[i] * dt;
+            scratch.momentum.z[i] = current.momentum.z[i] + input.force.z[i] * dt;
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            scratch.orientation.w[i] = current.orientation.w[i] + input.spin.w[i] * dt;
+            scratch.orientation.x[i] = current.orientation.x[i] + input.spin.x[i] * dt;
+            scratch.orientation.y[i] = current.orientation.y[i] + input.spin.y[i] * dt;
+            scratch.orientation.z[i] = current.orientation.z[i] + input.spin.z[i] * dt;
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            scratch.angularMomentum.x[i] = current.angularMomentum.x[i] + input.torque.x[i] * dt;
+            scratch.angularMomentum.y[i] = current.angularMomentum.y[i] + input.torque.y[i] * dt;
+            scratch.angularMomentum.z[i] = current.angularMomentum.z[i] + input.torque.z[i] * dt;
+        }
+
+        recalculate(scratch, scratchSecondary);
+
+        output.velocity = scratchSecondary.velocity;
+        output.spin = scratchSecondary.spin;
+
+        forces(planes, scratch, scratchSecondary, output);
+    }
+
+    /// Integrate the whole batch forward by dt seconds with RK4.
+    /// See Cube::integrate.
+
+    void integrate(const std::vector<Plane> &planes, float dt)
+    {
+        Derivative &a = derivatives[0];
+        Derivative &b = derivatives[1];
+        Derivative &c = derivatives[2];
+        Derivative &d = derivatives[3];
+
+        evaluate(planes, a);
+        evaluate(planes, dt*0.5f, a, b);
+        evaluate(planes, dt*0.5f, b, c);
+        evaluate(planes, dt, c, d);
+
+        const float k = 1.0f/6.0f * dt;
+
+        for (int i=0; i<count; i++)
+        {
+            current.position.x[i] += k * (a.velocity.x[i] + 2.0f*(b.velocity.x[i] + c.velocity.x[i]) + d.velocity.x[i]);
+            current.position.y[i] += k * (a.velocity.y[i] + 2.0f*(b.velocity.y[i] + c.velocity.y[i]) + d.velocity.y[i]);
+            current.position.z[i] += k * (a.velocity.z[i] + 2.0f*(b.velocity.z[i] + c.velocity.z[i]) + d.velocity.z[i]);
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            current.momentum.x[i] += k * (a.force.x[i] + 2.0f*(b.force.x[i] + c.force.x[i]) + d.force.x[i]);
+            current.momentum.y[i] += k * (a.force.y[i] + 2.0f*(b.force.y[i] + c.force.y[i]) + d.force.y[i]);
+            current.momentum.z[i] += k * (a.force.z[i] + 2.0f*(b.force.z[i] + c.force.z[i]) + d.force.z[i]);
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            current.orientation.w[i] += k * (a.spin.w[i] + 2.0f*(b.spin.w[i] + c.spin.w[i]) + d.spin.w[i]);
+            current.orientation.x[i] += k * (a.spin.x[i] + 2.0f*(b.spin.x[i] + c.spin.x[i]) + d.spin.x[i]);
+            current.orientation.y[i] += k * (a.spin.y[i] + 2.0f*(b.spin.y[i] + c.spin.y[i]) + d.spin.y[i]);
+            current.orientation.z[i] += k * (a.spin.z[i] + 2.0f*(b.spin.z[i] + c.spin.z[i]) + d.spin.z[i]);
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            current.angularMomentum.x[i] += k * (a.torque.x[i] + 2.0f*(b.torque.x[i] + c.torque.x[i]) + d.torque.x[i]);
+            current.angularMomentum.y[i] += k * (a.torque.y[i] + 2.0f*(b.torque.y[i] + c.torque.y[i]) + d.torque.y[i]);
+            current.angularMomentum.z[i] += k * (a.torque.z[i] + 2.0f*(b.torque.z[i] + c.torque.z[i]) + d.torque.z[i]);
+        }
+
+        recalculate(current, secondary);
+    }
+
+    /// Calculate force and torque for the whole batch.
+    /// Each force term is applied across all cubes before moving on to the next.
+    /// With SSE collision is done four cubes at a time, see collisionAndControl.
+    /// See Cube::forces.
+
+    void forces(const std::vector<Plane> &planes, const State &state, const Secondary &secondary, Derivative &output)
+    {
+        Vectors &force = output.force;
+        Vectors &torque = output.torque;
+
+        // gravity
+
+        for (int i=0; i<count; i++)
+        {
+            force.x[i] = 0;
+            force.y[i] = -9.8f;
+            force.z[i] = 0;
+        }
+
+        // damping
+
+        const float linear = 0.001f;
+        const float angular = 0.001f;
+
+        for (int i=0; i<count; i++)
+        {
+            force.x[i] -= linear * secondary.velocity.x[i];
+            force.y[i] -= linear * secondary.velocity.y[i];
+            force.z[i] -= linear * secondary.velocity.z[i];
+        }
+
+        for (int i=0; i<count; i++)
+        {
+            torque.x[i] = 0;
+            torque.y[i] = 0;
+            torque.z[i] = 0;
+            torque.x[i] -= angular * secondary.angularVelocity.x[i];
+            torque.y[i] -= angular * secondary.angularVelocity.y[i];
+            torque.z[i] -= angular * secondary.angularVelocity.z[i];
+        }
+
+        // collision and control
+
+        int first = 0;
+
+        #ifdef SSE
+        first = collisionAndControl(planes, state, secondary, output);
+        #endif
+
+        for (int i=first; i<count; i++)
+        {
+            const Vector position = state.position.get(i);
+            const Vector velocity = secondary.velocity.get(i);
+            const Vector angularVelocity = secondary.angularVelocity.get(i);
+
+            Vector corners[8];
+            calculateCorners(state, secondary, i, corners);
+
+            Vector f = force.get(i);
+            Vector t = torque.get(i);
+
+            const float radius = size[i] * 0.87f;
+
+            for (unsigned int p=0; p<planes.size(); p++)
+            {
+                if (position.dot(planes[p].normal) - planes[p].constant > radius)
+                    continue;
+
+                for (int j=0; j<8; j++)
+                    collisionForPoint(position, velocity, angularVelocity, f, t, corners[j], planes[p]);
+            }
+
+            float lowest = corners[0].y;
+            for (int j=1; j<8; j++)
+                if (corners[j].y<lowest)
+                    lowest = corners[j].y;
+
+            control(inputs[i], velocity, lowest, f);
+
+            assert(f==f);
+            assert(t==t);
+
+            force.set(i, f);
+            torque.set(i, t);
+        }
+    }
+
+    #ifdef SSE
+
+    /// Collision and control for the cubes in groups of four, one plane at a time.
+    /// @returns the number of cubes done, the rest are left for the cube at a time code.
+
+    int collisionAndControl(const std::vector<Plane> &planes, const State &state, const Secondary &secondary, Derivative &output)
+    {
+        if (planes.empty())
+            return 0;
+
+        const int done = count & ~3;
+
+        for (unsigned int p=0; p<planes.size(); p++)
+            collisionForPlane(planes[p], state, secondary, output);
+
+        for (int i=0; i<done; i++)
+        {
+            const Cube::Input &input = inputs[i];
+
+            if (!input.left && !input.right && !input.forward && !input.back && !input.jump)
+                continue;
+
+            Vector f = output.force.get(i);
+
+            const float lowest = input.jump ? lowestCorner(state, secondary, i) : 0;
+
+            control(input, secondary.velocity.get(i), lowest, f);
+
+            assert(f==f);
+
+            output.force.set(i, f);
+        }
+
+        return done;
+    }
+
+    /// Calculate collision response force and torque for the cubes against a plane, four cubes at a time.
+    ///
+    /// This is the collision loop in forces and collisionForPoint without branches: the
+    /// corners of each group of four cubes are transformed and tested together, and the
+    /// corners outside the plane and the velocity constraint force while separating
+    /// contribute zero. The force and torque stay in registers over the eight corners, and
+    /// the terms are added in the same order as the cube at a time code, so the results are
+    /// the same. Groups of four with no cube near the plane, or no corner inside it, are skipped.
+
+    void collisionForPlane(const Plane &plane, const State &state, const Secondary &secondary, Derivative &output)
+    {
+        const __m128 c = _mm_set1_ps(10);
+        const __m128 k = _mm_set1_ps(100);
+        const __m128 b = _mm_set1_ps(5);
+        const __m128 f = _mm_set1_ps(3);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 sign = _mm_set1_ps(-0.0f);
+
+        const __m128 normalX = _mm_set1_ps(plane.normal.x);
+        const __m128 normalY = _mm_set1_ps(plane.normal.y);
+        const __m128 normalZ = _mm_set1_ps(plane.normal.z);
+        const __m128 constant = _mm_set1_ps(plane.constant);
+
+        for (int i=0; i+4<=count; i+=4)
+        {
+            const __m128 positionX = _mm_loadu_ps(&state.position.x[i]);
+            const __m128 positionY = _mm_loadu_ps(&state.position.y[i]);
+            const __m128 positionZ = _mm_loadu_ps(&state.position.z[i]);
+
+            const __m128 size4 = _mm_loadu_ps(&size[i]);
+
+            const __m128 distance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(positionX, normalX), _mm_mul_ps(positionY, normalY)), _mm_mul_ps(positionZ, normalZ)), constant);
+            const __m128 inRange = _mm_cmple_ps(distance, _mm_mul_ps(size4, _mm_set1_ps(0.87f)));
+
+            if (!_mm_movemask_ps(inRange))
+                continue;
+
+            const __m128 row1X = _mm_loadu_ps(&secondary.row1.x[i]);
+            const __m128 row1Y = _mm_loadu_ps(&secondary.row1.y[i]);
+            const __m128 row1Z = _mm_loadu_ps(&secondary.row1.z[i]);
+            const __m128 row2X = _mm_loadu_ps(&secondary.row2.x[i]);
+            const __m128 row2Y = _mm_loadu_ps(&secondary.row2.y[i]);
+            const __m128 row2Z = _mm_loadu_ps(&secondary.row2.z[i]);
+            const __m128 row3X = _mm_loadu_ps(&secondary.row3.x[i]);
+            const __m128 row3Y = _mm_loadu_ps(&secondary.row3.y[i]);
+            const __m128 row3Z = _mm_loadu_ps(&secondary.row3.z[i]);
+
+            const __m128 velocityX = _mm_loadu_ps(&secondary.velocity.x[i]);
+            const __m128 velocityY = _mm_loadu_ps(&secondary.velocity.y[i]);
+            const __m128 velocityZ = _mm_loadu_ps(&secondary.velocity.z[i]);
+
+            const __m128 angularVelocityX = _mm_loadu_ps(&secondary.angularVelocity.x[i]);
+            const __m128 angularVelocityY = _mm_loadu_ps(&secondary.angularVelocity.y[i]);
+            const __m128 angularVelocityZ = _mm_loadu_ps(&secondary.angularVelocity.z[i]);
+
+            const __m128 s = _mm_mul_ps(size4, _mm_set1_ps(0.5f));
+
+            __m128 forceX = _mm_loadu_ps(&output.force.x[i]);
+            __m128 forceY = _mm_loadu_ps(&output.force.y[i]);
+            __m128 forceZ = _mm_loadu_ps(&output.force.z[i]);
+            __m128 torqueX = _mm_loadu_ps(&output.torque.x[i]);
+            __m128 torqueY = _mm_loadu_ps(&output.torque.y[i]);
+            __m128 torqueZ = _mm_loadu_ps(&output.torque.z[i]);
+
+            for (int j=0; j<8; j++)
+            {
+                const Vector corner = cornerSigns(j);
+
+                const __m128 x = _mm_mul_ps(_mm_set1_ps(corner.x), s);
+                const __m128 y = _mm_mul_ps(_mm_set1_ps(corner.y), s);
+                const __m128 z = _mm_mul_ps(_mm_set1_ps(corner.z), s);
+
+                const __m128 pointX = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(row1X, x), _mm_mul_ps(row1Y, y)), _mm_mul_ps(row1Z, z)), positionX);
+                const __m128 pointY = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(row2X, x), _mm_mul_ps(row2Y, y)), _mm_mul_ps(row2Z, z)), positionY);
+                const __m128 pointZ = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(row3X, x), _mm_mul_ps(row3Y, y)), _mm_mul_ps(row3Z, z)), positionZ);
+
+                const __m128 penetration = _mm_sub_ps(constant, _mm_add_ps(_mm_add_ps(_mm_mul_ps(pointX, normalX), _mm_mul_ps(pointY, normalY)), _mm_mul_ps(pointZ, normalZ)));
+                const __m128 contact = _mm_and_ps(inRange, _mm_cmpgt_ps(penetration, zero));
+
+                if (!_mm_movemask_ps(contact))
+                    continue;
+
+                const __m128 rx = _mm_sub_ps(pointX, positionX);
+                const __m128 ry = _mm_sub_ps(pointY, positionY);
+                const __m128 rz = _mm_sub_ps(pointZ, positionZ);
+
+                const __m128 vx = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(angularVelocityY, rz), _mm_mul_ps(angularVelocityZ, ry)), velocityX);
+                const __m128 vy = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(angularVelocityZ, rx), _mm_mul_ps(angularVelocityX, rz)), velocityY);
+                const __m128 vz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(angularVelocityX, ry), _mm_mul_ps(angularVelocityY, rx)), velocityZ);
+
+                const __m128 relativeSpeed = _mm_xor_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, vx), _mm_mul_ps(normalY, vy)), _mm_mul_ps(normalZ, vz)), sign);
+
+                const __m128 collision = _mm_and_ps(_mm_and_ps(contact, _mm_cmpgt_ps(relativeSpeed, zero)), _mm_mul_ps(relativeSpeed, c));
+                const __m128 penalty = _mm_and_ps(contact, _mm_mul_ps(penetration, k));
+                const __m128 damping = _mm_and_ps(contact, _mm_mul_ps(_mm_mul_ps(relativeSpeed, penetration), b));
+
+                // collision, friction, penalty and damping force, added in that order
+
+                __m128 forces[4][3];
+
+                forces[0][0] = _mm_mul_ps(normalX, collision);
+                forces[0][1] = _mm_mul_ps(normalY, collision);
+                forces[0][2] = _mm_mul_ps(normalZ, collision);
+
+                forces[1][0] = _mm_and_ps(contact, _mm_mul_ps(_mm_xor_ps(_mm_add_ps(vx, _mm_mul_ps(normalX, relativeSpeed)), sign), f));
+                forces[1][1] = _mm_and_ps(contact, _mm_mul_ps(_mm_xor_ps(_mm_add_ps(vy, _mm_mul_ps(normalY, relativeSpeed)), sign), f));
+                forces[1][2] = _mm_and_ps(contact, _mm_mul_ps(_mm_xor_ps(_mm_add_ps(vz, _mm_mul_ps(normalZ, relativeSpeed)), sign), f));
+
+                forces[2][0] = _mm_mul_ps(normalX, penalty);
+                forces[2][1] = _mm_mul_ps(normalY, penalty);
+                forces[2][2] = _mm_mul_ps(normalZ, penalty);
+
+                forces[3][0] = _mm_mul_ps(normalX, damping);
+                forces[3][1] = _mm_mul_ps(normalY, damping);
+                forces[3][2] = _mm_mul_ps(normalZ, damping);
+
+                for (int n=0; n<4; n++)
+                {
+                    forceX = _mm_add_ps(forceX, forces[n][0]);
+                    forceY = _mm_add_ps(forceY, forces[n][1]);
+                    forceZ = _mm_add_ps(forceZ, forces[n][2]);
+
+                    torqueX = _mm_add_ps(torqueX, _mm_sub_ps(_mm_mul_ps(ry, forces[n][2]), _mm_mul_ps(rz, forces[n][1])));
+                    torqueY = _mm_add_ps(torqueY, _mm_sub_ps(_mm_mul_ps(rz, forces[n][0]), _mm_mul_ps(rx, forces[n][2])));
+                    torqueZ = _mm_add_ps(torqueZ, _mm_sub_ps(_mm_mul_ps(rx, forces[n][1]), _mm_mul_ps(ry, forces[n][0])));
+                }
+            }
+
+            _mm_storeu_ps(&output.force.x[i], forceX);
+            _mm_storeu_ps(&output.force.y[i], forceY);
+            _mm_storeu_ps(&output.force.z[i], forceZ);
+            _mm_storeu_ps(&output.torque.x[i], torqueX);
+            _mm_storeu_ps(&output.torque.y[i], torqueY);
+            _mm_storeu_ps(&output.torque.z[i], torqueZ);
+        }
+    }
+
+    #endif
+
+    /// Height of the lowest corner of the cube at index i.
+    /// The same as the lowest y of calculateCorners, without calculating x and z.
+
+    float lowestCorner(const State &state, const Secondary &secondary, int i) const
+    {
+        const float s = size[i] * 0.5f;
+
+        float lowest = 0;
+
+        for (int j=0; j<8; j++)
+        {
+            const Vector corner = cornerSigns(j);
+            const float y = secondary.row2.x[i] * (corner.x * s) + secondary.row2.y[i] * (corner.y * s) + secondary.row2.z[i] * (corner.z * s) + state.position.y[i];
+            if (j==0 || y<lowest)
+                lowest = y;
+        }
+
+        return lowest;
+    }
+
+    /// Calculate the world space corners of the cube at index i.
+
+    void calculateCorners(const State &state, const Secondary &secondary, int i, Vector corners[]) const
+    {
+        const Vector position = state.position.get(i);
+        const Vector row1 = secondary.row1.get(i);
+        const Vector row2 = secondary.row2.get(i);
+        const Vector row3 = secondary.row3.get(i);
+
+        const float s = size[i] * 0.5f;
+
+        for (int j=0; j<8; j++)
+        {
+            const Vector corner = cornerSigns(j) * s;
+            corners[j] = Vector(row1.dot(corner) + position.x,
+                                row2.dot(corner) + position.y,
+                                row3.dot(corner) + position.z);
+        }
+    }
+
+    /// Corner j of a unit cube centered at the origin with side length 2.
+    /// Corners are in the same order as Cube::collision (a through h).
+
+    static Vector cornerSigns(int j)
+    {
+        static const float signs[8][3] =
+        {
+            { -1,-1,-1 }, { +1,-1,-1 }, { +1,+1,-1 }, { -1,+1,-1 },
+            { -1,-1,+1 }, { +1,-1,+1 }, { +1,+1,+1 }, { -1,+1,+1 }
+        };
+
+        return Vector(signs[j][0], signs[j][1], signs[j][2]);
+    }
+
+    /// Calculate collision response force and torque for a point against a plane.
+    /// See Cube::collisionForPoint.
+
+    static void collisionForPoint(const Vector &position, const Vector &linearVelocity, const Vector &angularVelocity, Vector &force, Vector &torque, const Vector &point, const Plane &plane)
+    {
+        const float c = 10;
+        const float k = 100;
+        const float b = 5;
+        const float f = 3;
+
+        const float penetration = plane.constant - point.dot(plane.normal);
+
+        if (penetration>0)
+        {
+            const Vector r = point - position;
+
+            Vector velocity = angularVelocity.cross(r) + linearVelocity;
+
+            const float relativeSpeed = - plane.normal.dot(velocity);
+
+            if (relativeSpeed>0)
+            {
+                Vector collisionForce = plane.normal * (relativeSpeed * c);
+                force += collisionForce;
+                torque += r.cross(collisionForce);
+            }
+
+            Vector tangentialVelocity = velocity + (plane.normal * relativeSpeed);
+            Vector frictionForce = - tangentialVelocity * f;
+            force += frictionForce;
+            torque += r.cross(frictionForce);
+
+            Vector penaltyForce = plane.normal * (penetration * k);
+            force += penaltyForce;
+            torque += r.cross(penaltyForce);
+
+            Vector dampingForce = plane.normal * (relativeSpeed * penetration * b);
+            force += dampingForce;
+            torque += r.cross(dampingForce);
+        }
+    }
+
+    /// Control forces.
+    /// @param lowest height of the lowest corner of the cube, only used when jumping.
+    /// See Cube::control.
+
+    static void control(const Cube::Input &input, const Vector &velocity, float lowest, Vector &force)
+    {
+        const float f = 50.0f;
+
+        if (input.left)
+            force.x -= f;
+
+        if (input.right)
+            force.x += f;
+
+        if (input.forward)
+            force.z -= f;
+
+        if (input.back)
+            force.z += f;
+
+        if (input.jump && velocity.y>=-0.1f)
+        {
+            const float j = 20;
+            const float k = 5;
+
+            const float difference = j - velocity.y;
+
+            if (difference>0 && lowest<0.05f)
+                force.y += difference * k;
+        }
+    }
+
+    int count;                                  ///< number of cubes in the batch.
+
+    State current;                              ///< current physics state of all cubes.
+    State scratch;                              ///< physics state at the point being evaluated by the current RK4 stage.
+    Secondary secondary;                        ///< secondary state calculated from the current state.
+    Secondary scratchSecondary;                 ///< secondary state calculated from the scratch state.
+    Derivative derivatives[4];                  ///< derivatives for the four RK4 stages.
+
+    std::vector<float> size;                    ///< length of the cube sides in meters.
+    std::vector<float> mass;                    ///< mass of each cube in kilograms.
+    std::vector<float> inverseMass;             ///< inverse mass of each cube.
+    std::vector<float> inertiaTensor;           ///< inertia tensor of each cube.
+    std::vector<float> inverseInertiaTensor;    ///< inverse inertia tensor of each cube.
+
+    std::vector<Cube::Input> inputs;            ///< current input for each cube.
+};
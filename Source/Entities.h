@@ -0,0 +1,203 @@
+/// Entity handles.
+///
+/// Maps generational handles to indices in dense arrays. The components of
+/// each entity, such as the cubes in Scene, are kept packed together in
+/// arrays with no holes so that updating every entity walks memory in order.
+/// Removing an entity moves the last entity into its place, so dense indices
+/// change and must not be held on to. Handles stay valid instead: a handle is
+/// a slot that records the dense index of its entity, plus the generation of
+/// the slot when the entity was added. Slots are reused by later entities with
+/// the generation increased, so a handle to a removed entity is detected as
+/// stale rather than finding whatever entity took its slot.
+///
+/// All the data is in flat arrays so copying the whole table for a snapshot
+/// is a handful of memory copies. Rolling back to a copy goes through restore,
+/// which keeps generations increasing so that handles given out after the copy
+/// was taken never match an entity added after rolling back.
+
+class Entities
+{
+public:
+
+    /// Handle to an entity.
+
+    struct Handle
+    {
+        int slot;                           ///< slot of the entity, -1 for a null handle.
+        unsigned int generation;            ///< generation of the slot when the entity was added.
+
+        Handle()
+        {
+            slot = -1;
+            generation = 0;
+        }
+
+        bool operator==(const Handle &other) const
+        {
+            return slot==other.slot && generation==other.generation;
+        }
+
+        bool operator!=(const Handle &other) const
+        {
+            return !(*this==other);
+        }
+    };
+
+    /// Add an entity at the end of the dense arrays.
+    /// The caller appends the components of the entity to its arrays.
+    /// @returns the handle of the entity, its dense index is size()-1.
+
+    Handle add()
+    {
+        int slot;
+
+        if (freeSlots.empty())
+        {
+            slot = (int) slots.size();
+            slots.push_back(Slot());
+        }
+        else
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+
+        slots[slot].index = (int) owners.size();
+        slots[slot].issued = slots[slot].generation;
+        owners.push_back(slot);
+
+        Handle handle;
+        handle.slot = slot;
+        handle.generation = slots[slot].generation;
+        return handle;
+    }
+
+    /// Remove an entity.
+    /// The last entity moves into the dense index of the removed entity, the caller
+    /// must do the same to its component arrays and then remove their last element.
+    /// @returns the dense index of the removed entity, or -1 if the handle is stale.
+
+    int remove(const Handle &handle)
+    {
+        const int index = find(handle);
+        if (index<0)
+            return -1;
+
+        const int last = (int) owners.size() - 1;
+
+        owners[index] = owners[last];
+        slots[owners[index]].index = index;
+        owners.pop_back();
+
+        Slot &slot = slots[handle.slot];
+        slot.index = -1;
+        slot.generation = slot.issued + 1;
+        freeSlots.push_back(handle.slot);
+
+        return index;
+    }
+
+    /// Look up the dense index of an entity.
+    /// @returns the dense index, or -1 if the handle is null or stale.
+
+    int find(const Handle &handle) const
+    {
+        if (handle.slot<0 || handle.slot>=(int)slots.size())
+            return -1;
+
+        const Slot &slot = slots[handle.slot];
+
+        return slot.generation==handle.generation ? slot.index : -1;
+    }
+
+    /// Get the handle of the entity at a dense index.
+
+    Handle handle(int index) const
+    {
+        assert(index>=0 && index<(int)owners.size());
+
+        Handle handle;
+        handle.slot = owners[index];
+        handle.generation = slots[handle.slot].generation;
+        return handle;
+    }
+
+    /// Number of entities.
+
+    int size() const
+    {
+        return (int) owners.size();
+    }
+
+    /// Remove all entities. Every handle given out so far becomes stale.
+
+    void clear()
+    {
+        for (unsigned int i=0; i<owners.size(); i++)
+        {
+            Slot &slot = slots[owners[i]];
+            slot.index = -1;
+            slot.generation = slot.issued + 1;
+            freeSlots.push_back(owners[i]);
+        }
+
+        owners.clear();
+    }
+
+    /// Roll back to a copy of this table taken earlier.
+    /// The entities are those of the copy, and handles to them are valid again.
+    /// Any other handle is stale, including handles given out after the copy was
+    /// taken: each slot keeps the newest generation it has given out, and slots
+    /// that are free after rolling back move past it, so they never give out the
+    /// same handle twice.
+
+    void restore(const Entities &snapshot)
+    {
+        const unsigned int count = snapshot.slots.size()>slots.size() ? (unsigned int) snapshot.slots.size() : (unsigned int) slots.size();
+
+        std::vector<Slot> restored(count);
+
+        for (unsigned int i=0; i<count; i++)
+        {
+            Slot &slot = restored[i];
+
+            if (i<snapshot.slots.size())
+                slot = snapshot.slots[i];
+
+            if (i<slots.size() && slots[i].issued>slot.issued)
+                slot.issued = slots[i].issued;
+
+            if (slot.index<0)
+                slot.generation = slot.issued + 1;
+        }
+
+        slots.swap(restored);
+        owners = snapshot.owners;
+        freeSlots = snapshot.freeSlots;
+
+        for (unsigned int i=(unsigned int) snapshot.slots.size(); i<count; i++)
+            freeSlots.push_back(i);
+    }
+
+private:
+
+    /// A slot maps a handle to the dense index of its entity.
+
+    struct Slot
+    {
+        int index;                          ///< dense index of the entity, -1 if the slot is free.
+        unsigned int generation;            ///< generation of the entity in the slot, or of the next entity if the slot is free.
+        unsigned int issued;                ///< newest generation given out by the slot, freeing the slot moves past it.
+
+        Slot()
+        {
+            index = -1;
+            generation = 0;
+            issued = 0;
+        }
+    };
+
+    std::vector<Slot> slots;                ///< slots indexed by handle.
+    std::vector<int> owners;                ///< slot of the entity at each dense index.
+    std::vector<int> freeSlots;             ///< slots free for reuse.
+};
@@ -0,0 +1,314 @@
+namespace Mathematics
+{
+    /// Q16.16 fixed point number.
+    ///
+    /// Sixteen bits of integer part and sixteen bits of fraction stored in a 32 bit
+    /// integer, giving a range of +/-32768 with a resolution of about 0.000015.
+    /// Products and quotients are calculated with 64 bit intermediates.
+    ///
+    /// Unlike floating point, integer arithmetic gives the same bits on every
+    /// compiler and platform regardless of optimization settings, which is what
+    /// the FIXED_POINT build relies on. Conversions to and from float are exact
+    /// roundings so they are deterministic too.
+    ///
+    /// Note that right shifts of negative values are assumed to be arithmetic,
+    /// which is true of every compiler we build with.
+
+    class Fixed
+    {
+    public:
+
+        /// default constructor.
+        /// does nothing for speed.
+
+        Fixed() {}
+
+        /// construct from a floating point value, rounding to the nearest fixed point value.
+
+        explicit Fixed(float value)
+        {
+            raw = (int) ::floor((double) value * 65536.0 + 0.5);
+        }
+
+        /// construct from raw fixed point bits.
+
+        static Fixed bits(int raw)
+        {
+            Fixed result;
+            result.raw = raw;
+            return result;
+        }
+
+        /// convert to floating point.
+
+        float toFloat() const
+        {
+            return raw * (1.0f / 65536.0f);
+        }
+
+        Fixed operator-() const
+        {
+            return bits(-raw);
+        }
+
+        Fixed operator+(Fixed other) const
+        {
+            return bits(raw + other.raw);
+        }
+
+        Fixed operator-(Fixed other) const
+        {
+            return bits(raw - other.raw);
+        }
+
+        Fixed operator*(Fixed other) const
+        {
+            return bits((int) (((long long) raw * other.raw) >> 16));
+        }
+
+        Fixed operator/(Fixed other) const
+        {
+            assert(other.raw!=0);
+            return bits((int) (((long long) raw * 65536) / other.raw));
+        }
+
+        Fixed& operator+=(Fixed other)
+        {
+            raw += other.raw;
+            return *this;
+        }
+
+        Fixed& operator-=(Fixed other)
+        {
+            raw -= other.raw;
+            return *this;
+        }
+
+        bool operator==(Fixed other) const { return raw==other.raw; }
+        bool operator!=(Fixed other) const { return raw!=other.raw; }
+        bool operator<(Fixed other) const { return raw<other.raw; }
+        bool operator>(Fixed other) const { return raw>other.raw; }
+        bool operator<=(Fixed other) const { return raw<=other.raw; }
+        bool operator>=(Fixed other) const { return raw>=other.raw; }
+
+        int raw;            ///< fixed point bits, value * 65536.
+    };
+
+    /// calculate the square root of a fixed point number.
+    /// bit by bit integer square root of the value shifted up by 16 bits.
+
+    inline Fixed sqrt(Fixed value)
+    {
+        assert(value.raw>=0);
+
+        unsigned long long n = (unsigned long long) value.raw << 16;
+        unsigned long long result = 0;
+        unsigned long long bit = 1ULL << 62;
+
+        while (bit>n)
+            bit >>= 2;
+
+        while (bit)
+        {
+            if (n>=result+bit)
+            {
+                n -= result + bit;
+                result = (result>>1) + bit;
+            }
+            else
+                result >>= 1;
+            bit >>= 2;
+        }
+
+        return Fixed::bits((int) result);
+    }
+
+    /// A vector in 3-space with fixed point components.
+    /// Only the operations needed by the fixed point integrator are provided.
+
+    class FixedVector
+    {
+    public:
+
+        /// default constructor.
+        /// does nothing for speed.
+
+        FixedVector() {}
+
+        /// construct vector from fixed point components.
+
+        FixedVector(Fixed x, Fixed y, Fixed z)
+        {
+            this->x = x;
+            this->y = y;
+            this->z = z;
+        }
+
+        /// construct vector by rounding a floating point vector.
+
+        explicit FixedVector(const Vector &vector)
+        {
+            x = Fixed(vector.x);
+            y = Fixed(vector.y);
+            z = Fixed(vector.z);
+        }
+
+        /// set all components to zero.
+
+        void zero()
+        {
+            x = y = z = Fixed::bits(0);
+        }
+
+        /// convert to a floating point vector.
+
+        Vector toVector() const
+        {
+            return Vector(x.toFloat(), y.toFloat(), z.toFloat());
+        }
+
+        FixedVector operator-() const
+        {
+            return FixedVector(-x, -y, -z);
+        }
+
+        FixedVector operator+(const FixedVector &other) const
+        {
+            return FixedVector(x+other.x, y+other.y, z+other.z);
+        }
+
+        FixedVector operator-(const FixedVector &other) const
+        {
+            return FixedVector(x-other.x, y-other.y, z-other.z);
+        }
+
+        FixedVector operator*(Fixed s) const
+        {
+            return FixedVector(x*s, y*s, z*s);
+        }
+
+        FixedVector& operator+=(const FixedVector &other)
+        {
+            x += other.x;
+            y += other.y;
+            z += other.z;
+            return *this;
+        }
+
+        FixedVector& operator-=(const FixedVector &other)
+        {
+            x -= other.x;
+            y -= other.y;
+            z -= other.z;
+            return *this;
+        }
+
+        /// dot product.
+
+        Fixed dot(const FixedVector &other) const
+        {
+            return x*other.x + y*other.y + z*other.z;
+        }
+
+        /// cross product.
+
+        FixedVector cross(const FixedVector &other) const
+        {
+            return FixedVector(y*other.z - z*other.y, z*other.x - x*other.z, x*other.y - y*other.x);
+        }
+
+        Fixed x,y,z;
+    };
+
+    /// A quaternion with fixed point components.
+    /// Only the operations needed by the fixed point integrator are provided.
+
+    class FixedQuaternion
+    {
+    public:
+
+        /// default constructor.
+        /// does nothing for speed.
+
+        FixedQuaternion() {}
+
+        /// construct quaternion from fixed point components.
+
+        FixedQuaternion(Fixed w, Fixed x, Fixed y, Fixed z)
+        {
+            this->w = w;
+            this->x = x;
+            this->y = y;
+            this->z = z;
+        }
+
+        /// construct quaternion by rounding a floating point quaternion.
+
+        explicit FixedQuaternion(const Quaternion &q)
+        {
+            w = Fixed(q.w);
+            x = Fixed(q.x);
+            y = Fixed(q.y);
+            z = Fixed(q.z);
+        }
+
+        /// convert to a floating point quaternion.
+
+        Quaternion toQuaternion() const
+        {
+            return Quaternion(w.toFloat(), x.toFloat(), y.toFloat(), z.toFloat());
+        }
+
+        /// normalize to unit length.
+        /// a zero quaternion becomes the identity.
+
+        void normalize()
+        {
+            const Fixed length = sqrt(w*w + x*x + y*y + z*z);
+
+            if (length.raw==0)
+            {
+                w = Fixed::bits(65536);
+                x = y = z = Fixed::bits(0);
+            }
+            else
+            {
+                w = w / length;
+                x = x / length;
+                y = y / length;
+                z = z / length;
+            }
+        }
+
+        FixedQuaternion operator+(const FixedQuaternion &other) const
+        {
+            return FixedQuaternion(w+other.w, x+other.x, y+other.y, z+other.z);
+        }
+
+        FixedQuaternion operator*(Fixed s) const
+        {
+            return FixedQuaternion(w*s, x*s, y*s, z*s);
+        }
+
+        /// quaternion product, same convention as Quaternion.
+
+        FixedQuaternion operator*(const FixedQuaternion &b) const
+        {
+            return FixedQuaternion( w*b.w - x*b.x - y*b.y - z*b.z,
+                                    w*b.x + x*b.w + y*b.z - z*b.y,
+                                    w*b.y - x*b.z + y*b.w + z*b.x,
+                                    w*b.z + x*b.y - y*b.x + z*b.w );
+        }
+
+        FixedQuaternion& operator+=(const FixedQuaternion &other)
+        {
+            w += other.w;
+            x += other.x;
+            y += other.y;
+            z += other.z;
+            return *this;
+        }
+
+        Fixed w,x,y,z;
+    };
+}
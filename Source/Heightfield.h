@@ -0,0 +1,292 @@
+/// Heightfield terrain.
+///
+/// A regular grid of 16 bit height samples over the x/z plane. Each grid cell
+/// is split into two triangles along its diagonal. Finding the surface under a
+/// point is a constant time cell lookup plus a test of which side of the diagonal
+/// it falls on, so the scene finds the terrain under each corner of a cube
+/// directly instead of scanning every surface, and terrain costs two bytes per
+/// sample instead of a triangle mesh.
+///
+/// The grid is split into square tiles that are loaded and unloaded independently,
+/// so large maps can be streamed in around the player. Each tile stores its own
+/// edge samples, duplicating the edges it shares with its neighbours, so every
+/// cell lookup reads a single tile. Points over tiles that are not loaded have
+/// no terrain under them.
+
+class Heightfield
+{
+public:
+
+    Heightfield()
+    {
+        origin.zero();
+        tilesX = 0;
+        tilesZ = 0;
+        tileCells = 0;
+        cellSize = 1;
+        heightScale = 1;
+        loadedTiles = 0;
+    }
+
+    /// Set up the heightfield with no tiles loaded.
+    /// @param origin the position of the first corner of tile 0,0 with a height sample of zero.
+    /// @param tilesX the number of tiles along the x axis.
+    /// @param tilesZ the number of tiles along the z axis.
+    /// @param tileCells the number of cells along each side of a tile.
+    /// @param cellSize the size of each cell.
+    /// @param heightScale the height of one unit of a height sample.
+
+    void initialize(const Vector &origin, int tilesX, int tilesZ, int tileCells, float cellSize, float heightScale)
+    {
+        this->origin = origin;
+        this->tilesX = tilesX;
+        this->tilesZ = tilesZ;
+        this->tileCells = tileCells;
+        this->cellSize = cellSize;
+        this->heightScale = heightScale;
+
+        tiles.clear();
+        tiles.resize(tilesX * tilesZ);
+        loadedTiles = 0;
+    }
+
+    /// Load the height samples of a tile, replacing any already loaded.
+    /// @param heights (tileCells+1) * (tileCells+1) samples, in rows of increasing x with rows in order of increasing z.
+
+    void setTile(int x, int z, const unsigned short heights[])
+    {
+        assert(x>=0 && x<tilesX && z>=0 && z<tilesZ);
+
+        std::vector<unsigned short> &tile = tiles[z*tilesX + x];
+
+        if (tile.empty())
+            loadedTiles++;
+
+        tile.assign(heights, heights + tileSamples());
+    }
+
+    /// Unload a tile.
+
+    void clearTile(int x, int z)
+    {
+        assert(x>=0 && x<tilesX && z>=0 && z<tilesZ);
+
+        std::vector<unsigned short> &tile = tiles[z*tilesX + x];
+
+        if (!tile.empty())
+            loadedTiles--;
+
+        std::vector<unsigned short>().swap(tile);
+    }
+
+    /// Returns true if a tile is loaded.
+
+    bool loaded(int x, int z) const
+    {
+        return x>=0 && x<tilesX && z>=0 && z<tilesZ && !tiles[z*tilesX + x].empty();
+    }
+
+    /// Returns true if no tiles are loaded.
+
+    bool empty() const
+    {
+        return loadedTiles==0;
+    }
+
+    /// Number of height samples in a tile.
+
+    int tileSamples() const
+    {
+        return (tileCells + 1) * (tileCells + 1);
+    }
+
+    /// Get the terrain height under a point.
+    /// @returns false if there is no terrain loaded under the point.
+
+    bool height(float x, float z, float &height) const
+    {
+        Vector point, normal;
+        int id;
+
+        if (!triangle(x, z, point, normal, id))
+            return false;
+
+        height = point.y - (normal.x * (x - point.x) + normal.z * (z - point.z)) / normal.y;
+        return true;
+    }
+
+    /// Find the terrain triangles under a set of points, such as the corners of a cube.
+    /// For each triangle with a point no further than the margin above it, the plane of the triangle is appended.
+    /// @param points the points to look up.
+    /// @param count the number of points.
+    /// @param margin how far above the terrain a point can be and still find the triangle under it.
+    /// @param planes the planes of the triangles found are appended to this array, each triangle once.
+    /// @param ids an index identifying the triangle of each plane is appended to this array.
+
+    void query(const Vector points[], int count, float margin, std::vector<Plane> &planes, std::vector<int> &ids) const
+    {
+        const unsigned int first = ids.size();
+
+        for (int i=0; i<count; i++)
+        {
+            Vector point, normal;
+            int id;
+
+            if (!triangle(points[i].x, points[i].z, point, normal, id))
+                continue;
+
+            if ((points[i] - point).dot(normal)>margin)
+                continue;
+
+            bool found = false;
+            for (unsigned int j=first; j<ids.size() && !found; j++)
+                found = ids[j]==id;
+
+            if (found)
+                continue;
+
+            planes.push_back(Plane(normal, point));
+            ids.push_back(id);
+        }
+    }
+
+    /// Sweep points along a line and find the first place any of them moves below the terrain.
+    /// Each point is stepped along the line at half the cell size and the crossing is found
+    /// between the last step above the terrain and the first step below it. Points that start
+    /// below the terrain are in contact already and ignored.
+    /// @param points the points to sweep, normally the corners of a cube.
+    /// @param count the number of points.
+    /// @param displacement how far the points move.
+    /// @param fraction on entry only hits before this fraction of the displacement are found, set to the fraction of the first hit.
+    /// @param normal set to the upward unit normal of the terrain triangle hit first.
+    /// @returns true if a hit was found.
+
+    bool sweep(const Vector points[], int count, const Vector &displacement, float &fraction, Vector &normal) const
+    {
+        const float across = Mathematics::sqrt(displacement.x * displacement.x + displacement.z * displacement.z);
+        const int steps = 1 + (int) Mathematics::minimum(across / (cellSize * 0.5f), 256.0f);
+
+        bool hit = false;
+
+        for (int i=0; i<count; i++)
+        {
+            float above;
+            if (!this->above(points[i], above) || above<0)
+                continue;
+
+            for (int j=1; j<=steps; j++)
+            {
+                const float t = fraction * j / steps;
+
+                float next;
+                if (!this->above(points[i] + displacement * t, next))
+                    break;
+
+                if (next<0)
+                {
+                    const float previous = fraction * (j-1) / steps;
+                    const float crossing = previous + (t - previous) * above / (above - next);
+
+                    Vector point;
+                    int id;
+                    const Vector position = points[i] + displacement * crossing;
+                    if (triangle(position.x, position.z, point, normal, id))
+                    {
+                        fraction = crossing;
+                        hit = true;
+                    }
+                    break;
+                }
+
+                above = next;
+            }
+        }
+
+        return hit;
+    }
+
+private:
+
+    /// Height of a point above the terrain under it, negative if it is below the terrain.
+    /// @returns false if there is no terrain loaded under the point.
+
+    bool above(const Vector &point, float &distance) const
+    {
+        float height;
+        if (!this->height(point.x, point.z, height))
+            return false;
+
+        distance = point.y - height;
+        return true;
+    }
+
+    /// Look up the triangle under a point.
+    /// @param point set to a vertex of the triangle.
+    /// @param normal set to the upward unit normal of the triangle.
+    /// @param id set to an index identifying the triangle.
+    /// @returns false if there is no terrain loaded under the point.
+
+    bool triangle(float x, float z, Vector &point, Vector &normal, int &id) const
+    {
+        const float gridX = (x - origin.x) / cellSize;
+        const float gridZ = (z - origin.z) / cellSize;
+
+        if (gridX<0 || gridZ<0)
+            return false;
+
+        const int cellX = (int) gridX;
+        const int cellZ = (int) gridZ;
+
+        const int tileX = cellX / tileCells;
+        const int tileZ = cellZ / tileCells;
+
+        if (tileX>=tilesX || tileZ>=tilesZ)
+            return false;
+
+        const std::vector<unsigned short> &tile = tiles[tileZ*tilesX + tileX];
+
+        if (tile.empty())
+            return false;
+
+        const int row = tileCells + 1;
+        const unsigned short *sample = &tile[(cellZ - tileZ*tileCells) * row + cellX - tileX*tileCells];
+
+        const float x0 = origin.x + cellX * cellSize;
+        const float z0 = origin.z + cellZ * cellSize;
+        const float x1 = x0 + cellSize;
+        const float z1 = z0 + cellSize;
+
+        const Vector a(x0, origin.y + sample[0] * heightScale, z0);
+        const Vector c(x1, origin.y + sample[row+1] * heightScale, z1);
+
+        // split along the diagonal from a to c
+
+        const bool lower = gridX - cellX >= gridZ - cellZ;
+
+        if (lower)
+        {
+            const Vector b(x1, origin.y + sample[1] * heightScale, z0);
+            normal = (c - a).cross(b - a);
+        }
+        else
+        {
+            const Vector d(x0, origin.y + sample[row] * heightScale, z1);
+            normal = (d - a).cross(c - a);
+        }
+
+        normal.normalize();
+        point = a;
+        id = (cellZ * tilesX * tileCells + cellX) * 2 + (lower ? 0 : 1);
+
+        return true;
+    }
+
+    Vector origin;                                      ///< position of the first corner of tile 0,0 at height zero.
+    int tilesX;                                         ///< number of tiles along x.
+    int tilesZ;                                         ///< number of tiles along z.
+    int tileCells;                                      ///< number of cells along each side of a tile.
+    float cellSize;                                     ///< size of a cell.
+    float heightScale;                                  ///< height of one unit of a height sample.
+    std::vector< std::vector<unsigned short> > tiles;   ///< height samples of each tile, empty if the tile is not loaded.
+    int loadedTiles;                                    ///< number of tiles loaded.
+};
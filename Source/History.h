@@ -1,313 +1,403 @@
-/// History buffer.
-/// Stores a history of all "moves" (time, input, state) since the last 
-/// correction received from the server, plus a list of all *important moves*
-/// (changes in input) in the same time period.
-/// Used in client side prediction to apply server corrections 'in the past'
-/// Press F4 while running to toggle visualization of the history buffer.
-
-class History
-{
-public:
-
-    History(int size = 1000)
-    {
-        moves.resize(size);
-        importantMoves.resize(size);
-
-        #ifdef LOGGING
-        logfile = fopen("history.log", "w");
-        #endif
-    }
-
-    ~History()
-    {
-        #ifdef LOGGING
-        if (logfile)
-        {
-            fclose(logfile);
-            logfile = 0;
-        }
-        #endif
-    }
-
-    void add(const Move &move)
-    {
-        // log for comparison
-
-        if (logfile)
-        {
-            Vector position = move.state.position;
-            Quaternion orientation = move.state.orientation;
-            Cube::Input input = move.input;
-            fprintf(logfile, "%d: position=(%f,%f,%f), orientation=(%f,%f,%f,%f), input=(%d,%d,%d,%d,%d)\n", move.time, position.x, position.y, position.z, orientation.w, orientation.x, orientation.y, orientation.z, input.left, input.right, input.forward, input.back, input.jump);
-        }
-
-        // determine if important move
-
-        bool important = true;
-
-        if (!moves.empty())
-        {
-            const Move &previous = moves.newest();
-
-            important = move.input.left!=previous.input.left || 
-                        move.input.right!=previous.input.right ||
-                        move.input.forward!=previous.input.forward ||
-                        move.input.back!=previous.input.back ||
-                        move.input.jump!=previous.input.jump;
-        }
-
-        if (important)
-            importantMoves.add(move);
-
-        // add move to history
-
-        moves.add(move);
-    }
-
-    void correction(Scene &scene, unsigned int t, const Cube::State &state, const Cube::Input &input)
-    {
-        // discard out of date important moves 
-
-        while (importantMoves.oldest().time<t && !importantMoves.empty())
-            importantMoves.remove();
-
-        // discard out of date moves
-
-        while (moves.oldest().time<t && !moves.empty())
-            moves.remove();
-        
-        if (moves.empty())
-            return;
-
-        // compare correction state with move history state
-
-        if (state!=moves.oldest().state)
-        {
-            // discard corrected move
-
-            moves.remove();
-
-            // save current scene data
-
-            unsigned int savedTime = scene.time;
-            Cube::Input savedInput = scene.input;
-
-            // rewind to correction and replay moves
-
-            scene.time = t;
-            scene.input = input;
-            scene.cube.snap(state);
-
-            scene.replaying = true;
-
-            int i = moves.tail;
-
-            while (i!=moves.head)
-            {
-                while (scene.time<moves[i].time)
-                    scene.update(scene.time);
-                scene.input = moves[i].input;
-                moves[i].state = scene.cube.state();
-                moves.next(i);
-            }
-
-            scene.update(scene.time);
-            
-            scene.replaying = false;
-
-            // restore saved input
-
-            scene.input = savedInput;
-        }
-    }
-
-    /// render history buffer as a cool trail
-
-    void render()
-    {
-        int i = moves.tail;
-
-        glDepthMask(GL_FALSE);
-        glDisable(GL_CULL_FACE);
-
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE);
-
-        Cube::State previous;
-
-        int count = 0;
-
-        while (i!=moves.head)
-        {
-            const Cube::State &state = moves[i].state;
-
-            if (count++==0)
-            {
-                previous = state;
-                continue;
-            }
-
-            Vector a = state.bodyToWorld * (Vector(-1,-1,-1) * state.size * 0.5);
-            Vector b = state.bodyToWorld * (Vector(+1,-1,-1) * state.size * 0.5);
-            Vector c = state.bodyToWorld * (Vector(+1,+1,-1) * state.size * 0.5);
-            Vector d = state.bodyToWorld * (Vector(-1,+1,-1) * state.size * 0.5);
-            Vector e = state.bodyToWorld * (Vector(-1,-1,+1) * state.size * 0.5);
-            Vector f = state.bodyToWorld * (Vector(+1,-1,+1) * state.size * 0.5);
-            Vector g = state.bodyToWorld * (Vector(+1,+1,+1) * state.size * 0.5);
-            Vector h = state.bodyToWorld * (Vector(-1,+1,+1) * state.size * 0.5);
-
-            Vector _a = previous.bodyToWorld * (Vector(-1,-1,-1) * previous.size * 0.5);
-            Vector _b = previous.bodyToWorld * (Vector(+1,-1,-1) * previous.size * 0.5);
-            Vector _c = previous.bodyToWorld * (Vector(+1,+1,-1) * previous.size * 0.5);
-            Vector _d = previous.bodyToWorld * (Vector(-1,+1,-1) * previous.size * 0.5);
-            Vector _e = previous.bodyToWorld * (Vector(-1,-1,+1) * previous.size * 0.5);
-            Vector _f = previous.bodyToWorld * (Vector(+1,-1,+1) * previous.size * 0.5);
-            Vector _g = previous.bodyToWorld * (Vector(+1,+1,+1) * previous.size * 0.5);
-            Vector _h = previous.bodyToWorld * (Vector(-1,+1,+1) * previous.size * 0.5);
-            
-            previous = state;
-
-            glBegin(GL_QUADS);
-                
-                glColor3f(0.02f, 0.02f, 0.02f);
-
-                quad(a, b, _b, _a);
-                quad(b, c, _c, _b);
-                quad(c, d, _d, _c);
-                quad(d, a, _a, _d);
-
-                quad(e, f, _f, _e);
-                quad(f, g, _g, _f);
-                quad(g, h, _h, _g);
-                quad(h, e, _e, _h);
-
-                quad(a, e, _e, _a);
-                quad(b, f, _f, _b);
-                quad(c, g, _g, _c);
-                quad(d, h, _h, _d);
-
-            glEnd();
-
-            moves.next(i);
-        }
-
-        glDisable(GL_BLEND);
-
-        glDepthMask(GL_TRUE);
-        glEnable(GL_CULL_FACE);
-    }
-
-    /// get important moves in a std::vector form
-
-    void importantMoveArray(std::vector<Move> &array)
-    {
-        const int size = importantMoves.size();
-
-        array.resize(size);
-
-        int i = importantMoves.tail;
-
-        for (int j=0; j<size; j++)
-        {
-            array[j] = importantMoves[i];
-            importantMoves.next(i);
-        }
-    }
-
-private:
-
-    /// circular buffer class
-
-    struct CircularBuffer
-    {
-        int head;
-        int tail;
-
-        CircularBuffer()
-        {
-            head = 0;
-            tail = 0;
-        }
-
-        void resize(int size)
-        {
-            head = 0;
-            tail = 0;
-            moves.resize(size);
-        }
-
-        int size()
-        {
-            int count = head - tail;
-            if (count<0)
-                count += (int) moves.size();
-            return count;
-        }
-
-        void add(const Move &move)
-        {
-            moves[head] = move;
-            next(head);
-
-        }
-
-        void remove()
-        {
-            assert(!empty());
-            next(tail);
-        }
-
-        Move& oldest()
-        {
-            assert(!empty());
-            return moves[tail];
-        }
-
-        Move& newest()
-        {
-            assert(!empty());
-            int index = head-1;
-            if (index==-1)
-                index = (int) moves.size() - 1;
-            return moves[index];
-        }
-
-        bool empty() const
-        {
-            return head==tail;
-        }
-
-        void next(int &index)
-        {
-            index ++;
-            if (index>=(int)moves.size()) 
-                index -= (int)moves.size();
-        }
-
-        void previous(int &index)
-        {
-            index --;
-            if (index<0)
-                index += (int)moves.size();
-        }
-
-        Move& operator[](int index)
-        {
-            assert(index>=0);
-            assert(index<(int)moves.size());
-            return moves[index];
-        }
-
-    private:
-
-        std::vector<Move> moves;
-    };
-
-private:
-
-    CircularBuffer moves;                       ///< stores all recent moves
-    CircularBuffer importantMoves;              ///< stores recent *important* moves
-
-    FILE *logfile;
-};
+/// History buffer.
+/// Stores a history of all "moves" (time, input, state) since the last 
+/// correction received from the server, plus a list of all *important moves*
+/// (changes in input) in the same time period.
+/// Used in client side prediction to apply server corrections 'in the past'
+/// Both are kept in ring buffers that drop their oldest moves when full.
+/// Press F4 while running to toggle visualization of the history buffer.
+
+class History
+{
+public:
+
+    /// Correction tolerances.
+    /// A correction only rewinds and replays when the server state differs from
+    /// the state the client predicted for that time by more than one of these.
+    /// Smaller differences are ignored. The error cannot build up past the
+    /// tolerances this way, because once the prediction drifts further than them
+    /// the next correction replays. Set them all to zero to replay whenever the
+    /// states differ at all.
+
+    struct Tolerance
+    {
+        float position;                 ///< position error in meters.
+        float orientation;              ///< orientation error in radians (approximate, exact for small angles).
+        float momentum;                 ///< momentum error in kilogram meters per second.
+        float angularMomentum;          ///< angular momentum error in kilogram meters squared per second.
+    };
+
+    /// Correction counters since the history was created or the counters were last reset.
+    /// Every correction received is either skipped or replayed.
+
+    struct Counters
+    {
+        unsigned int received;          ///< corrections received.
+        unsigned int skipped;           ///< corrections within tolerance, or too old to apply, that did not replay.
+        unsigned int replayed;          ///< corrections that rewound and replayed.
+        unsigned int replayedSteps;     ///< scene updates done replaying corrections.
+
+        void clear()
+        {
+            received = 0;
+            skipped = 0;
+            replayed = 0;
+            replayedSteps = 0;
+        }
+    };
+
+    Tolerance tolerance;                ///< how far off a prediction can be before a correction replays.
+    Counters counters;                  ///< correction counters.
+
+    History(int size = 1024)
+    {
+        moves.resize(size);
+        importantMoves.resize(size);
+
+        moves.overflow = RingBuffer<Move>::DropOldest;
+        importantMoves.overflow = RingBuffer<Move>::DropOldest;
+
+        tolerance.position = 0.01f;
+        tolerance.orientation = 0.01f;
+        tolerance.momentum = 0.05f;
+        tolerance.angularMomentum = 0.05f;
+
+        counters.clear();
+
+        replayMove = 0;
+
+        logfile = 0;
+
+        #ifdef LOGGING
+        logfile = fopen("history.log", "w");
+        #endif
+    }
+
+    ~History()
+    {
+        #ifdef LOGGING
+        if (logfile)
+        {
+            fclose(logfile);
+            logfile = 0;
+        }
+        #endif
+    }
+
+    void add(const Move &move)
+    {
+        // log for comparison
+
+        if (logfile)
+        {
+            Vector position = move.state.position;
+            Quaternion orientation = move.state.orientation;
+            Cube::Input input = move.input;
+            fprintf(logfile, "%d: position=(%f,%f,%f), orientation=(%f,%f,%f,%f), input=(%d,%d,%d,%d,%d)\n", move.time, position.x, position.y, position.z, orientation.w, orientation.x, orientation.y, orientation.z, input.left, input.right, input.forward, input.back, input.jump);
+        }
+
+        // determine if important move
+
+        bool important = true;
+
+        if (!moves.empty())
+        {
+            const Move &previous = moves.newest();
+
+            important = move.input.left!=previous.input.left || 
+                        move.input.right!=previous.input.right ||
+                        move.input.forward!=previous.input.forward ||
+                        move.input.back!=previous.input.back ||
+                        move.input.jump!=previous.input.jump;
+        }
+
+        if (important)
+            importantMoves.add(move);
+
+        // add move to history
+
+        moves.add(move);
+
+        // a full history drops its oldest move, which a replay in progress may not have reached
+
+        if (replayMove-moves.tail()>moves.size())
+            replayMove = moves.tail();
+    }
+
+    /// Apply a correction from the server.
+    /// If the server state at time t is further from the predicted state than the tolerance,
+    /// the scene is rewound to the server state and the moves since then are replayed.
+
+    void correction(Scene &scene, unsigned int t, const Cube::State &state, const Cube::Input &input)
+    {
+        const Cube::Input savedInput = scene.input(scene.player);
+
+        if (!rewind(scene, t, state, input))
+            return;
+
+        replay(scene, 0);
+
+        scene.input(scene.player) = savedInput;
+    }
+
+    /// Check a correction from the server and rewind the scene to it if it is significant.
+    /// The scene is only changed if it is rewound, then the moves since the correction
+    /// must be replayed with replay to bring it back up to the current time.
+    /// @returns true if the scene was rewound.
+
+    bool rewind(Scene &scene, unsigned int t, const Cube::State &state, const Cube::Input &input)
+    {
+        if (!check(t, state))
+            return false;
+
+        // rewind to correction
+
+        scene.time = t;
+        scene.input(scene.player) = input;
+        scene.cube(scene.player).snap(state);
+
+        return true;
+    }
+
+    /// Check a correction from the server without rewinding a scene.
+    /// Discards the moves it makes out of date and, if it is significant, sets up
+    /// a replay of the moves since it, which rewind does along with the scene.
+    /// @returns true if the correction must be replayed.
+
+    bool check(unsigned int t, const Cube::State &state)
+    {
+        counters.received++;
+
+        // discard out of date important moves 
+
+        while (!importantMoves.empty() && importantMoves.oldest().time<t)
+            importantMoves.remove();
+
+        // discard out of date moves
+
+        while (!moves.empty() && moves.oldest().time<t)
+            moves.remove();
+        
+        if (moves.empty())
+        {
+            counters.skipped++;
+            return false;
+        }
+
+        // compare correction state with move history state
+
+        if (!significant(state, moves.oldest().state))
+        {
+            counters.skipped++;
+            return false;
+        }
+
+        counters.replayed++;
+
+        // discard corrected move
+
+        moves.remove();
+
+        replayMove = moves.tail();
+
+        return true;
+    }
+
+    /// Replay the moves since the last rewind, storing the corrected state of each move.
+    /// Moves added while the replay is unfinished are replayed as well, so a replay
+    /// spread over several frames catches up as long as it replays more steps per
+    /// frame than the client adds moves.
+    /// @param steps the most scene updates to do, or zero for no limit.
+    /// @returns true when the scene has caught up with the newest move, false if the step limit was reached first.
+
+    bool replay(Scene &scene, int steps)
+    {
+        scene.replaying = true;
+
+        bool finished = false;
+        int count = 0;
+
+        while (!steps || count<steps)
+        {
+            if (replayMove==moves.head())
+            {
+                scene.update(scene.time);
+                counters.replayedSteps++;
+                finished = true;
+                break;
+            }
+
+            if (scene.time<moves[replayMove].time)
+            {
+                scene.update(scene.time);
+                counters.replayedSteps++;
+                count++;
+                continue;
+            }
+
+            scene.input(scene.player) = moves[replayMove].input;
+            moves[replayMove].state = scene.cube(scene.player).state();
+            replayMove++;
+        }
+
+        scene.replaying = false;
+
+        return finished;
+    }
+
+    /// Copy the moves still to be replayed since the last check or rewind,
+    /// for replaying them somewhere else such as on another thread.
+
+    void replayMoves(std::vector<Move> &array)
+    {
+        array.clear();
+
+        for (unsigned int i=replayMove; i!=moves.head(); i++)
+            array.push_back(moves[i]);
+    }
+
+    /// Store the corrected states of moves copied with replayMoves and replayed elsewhere.
+    /// The replay continues from the last of them, so a scene holding the replay at the
+    /// time of that move, with its state stored and its input set, is brought up to
+    /// the current time by replay along with any moves added since they were copied.
+    /// Moves may be added in between, but no correction may be checked.
+
+    void replayed(const std::vector<Move> &array)
+    {
+        for (unsigned int i=0; i<array.size(); i++)
+        {
+            assert(moves[replayMove].time==array[i].time);
+
+            moves[replayMove].state = array[i].state;
+
+            if (i+1<array.size())
+                replayMove++;
+        }
+    }
+
+    #ifndef HEADLESS
+
+    /// render history buffer as a cool trail
+    /// @param size the cube size in meters.
+
+    void render(float size)
+    {
+        unsigned int i = moves.tail();
+
+        glDepthMask(GL_FALSE);
+        glDisable(GL_CULL_FACE);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+
+        Cube::State previous;
+
+        int count = 0;
+
+        while (i!=moves.head())
+        {
+            const Cube::State &state = moves[i].state;
+
+            if (count++==0)
+            {
+                previous = state;
+                continue;
+            }
+
+            const Transform bodyToWorld(state.orientation, state.position);
+            const Transform previousBodyToWorld(previous.orientation, previous.position);
+
+            Vector a = bodyToWorld * (Vector(-1,-1,-1) * size * 0.5);
+            Vector b = bodyToWorld * (Vector(+1,-1,-1) * size * 0.5);
+            Vector c = bodyToWorld * (Vector(+1,+1,-1) * size * 0.5);
+            Vector d = bodyToWorld * (Vector(-1,+1,-1) * size * 0.5);
+            Vector e = bodyToWorld * (Vector(-1,-1,+1) * size * 0.5);
+            Vector f = bodyToWorld * (Vector(+1,-1,+1) * size * 0.5);
+            Vector g = bodyToWorld * (Vector(+1,+1,+1) * size * 0.5);
+            Vector h = bodyToWorld * (Vector(-1,+1,+1) * size * 0.5);
+
+            Vector _a = previousBodyToWorld * (Vector(-1,-1,-1) * size * 0.5);
+            Vector _b = previousBodyToWorld * (Vector(+1,-1,-1) * size * 0.5);
+            Vector _c = previousBodyToWorld * (Vector(+1,+1,-1) * size * 0.5);
+            Vector _d = previousBodyToWorld * (Vector(-1,+1,-1) * size * 0.5);
+            Vector _e = previousBodyToWorld * (Vector(-1,-1,+1) * size * 0.5);
+            Vector _f = previousBodyToWorld * (Vector(+1,-1,+1) * size * 0.5);
+            Vector _g = previousBodyToWorld * (Vector(+1,+1,+1) * size * 0.5);
+            Vector _h = previousBodyToWorld * (Vector(-1,+1,+1) * size * 0.5);
+            
+            previous = state;
+
+            glBegin(GL_QUADS);
+                
+                glColor3f(0.02f, 0.02f, 0.02f);
+
+                quad(a, b, _b, _a);
+                quad(b, c, _c, _b);
+                quad(c, d, _d, _c);
+                quad(d, a, _a, _d);
+
+                quad(e, f, _f, _e);
+                quad(f, g, _g, _f);
+                quad(g, h, _h, _g);
+                quad(h, e, _e, _h);
+
+                quad(a, e, _e, _a);
+                quad(b, f, _f, _b);
+                quad(c, g, _g, _c);
+                quad(d, h, _h, _d);
+
+            glEnd();
+
+            i++;
+        }
+
+        glDisable(GL_BLEND);
+
+        glDepthMask(GL_TRUE);
+        glEnable(GL_CULL_FACE);
+    }
+
+    #endif
+
+    /// get important moves in a std::vector form
+
+    void importantMoveArray(std::vector<Move> &array)
+    {
+        const unsigned int size = importantMoves.size();
+
+        array.resize(size);
+
+        unsigned int i = importantMoves.tail();
+
+        for (unsigned int j=0; j<size; j++)
+            array[j] = importantMoves[i++];
+    }
+
+private:
+
+    /// Returns true if a corrected state is further from the predicted state than the tolerance.
+
+    bool significant(const Cube::State &corrected, const Cube::State &predicted) const
+    {
+        if (corrected==predicted)
+            return false;
+
+        // q and -q are the same orientation, so measure to whichever is closer
+
+        const Quaternion &a = corrected.orientation;
+        const Quaternion &b = predicted.orientation;
+
+        const Quaternion difference = a.w*b.w + a.x*b.x + a.y*b.y + a.z*b.z<0 ? a + b : a - b;
+
+        return (corrected.position - predicted.position).length()>tolerance.position ||
+               difference.length() * 2.0f>tolerance.orientation ||
+               (corrected.momentum - predicted.momentum).length()>tolerance.momentum ||
+               (corrected.angularMomentum - predicted.angularMomentum).length()>tolerance.angularMomentum;
+    }
+
+    RingBuffer<Move> moves;                     ///< stores all recent moves
+    RingBuffer<Move> importantMoves;            ///< stores recent *important* moves
+
+    unsigned int replayMove;                    ///< index of the next move to replay after a rewind
+
+    FILE *logfile;
+};
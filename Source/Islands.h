@@ -0,0 +1,138 @@
+/// Island builder.
+///
+/// Groups bodies that touch into islands using union-find: every touching
+/// pair is joined, then each body belongs to the island of its root. Bodies
+/// in different islands cannot affect each other this step, so islands can be
+/// integrated and solved independently (and in parallel), and an island can
+/// sleep as a whole once every body in it is at rest.
+///
+/// Islands are numbered in order of their lowest body, and the bodies of each
+/// island are listed in increasing order, so the result does not depend on the
+/// order that pairs were joined.
+
+class Islands
+{
+public:
+
+    /// Start building islands for a number of bodies, each in its own island.
+
+    void reset(int bodies)
+    {
+        parent.resize(bodies);
+        rank.resize(bodies);
+        for (int i=0; i<bodies; i++)
+        {
+            parent[i] = i;
+            rank[i] = 0;
+        }
+    }
+
+    /// Join the islands of two touching bodies.
+
+    void join(int a, int b)
+    {
+        a = root(a);
+        b = root(b);
+
+        if (a==b)
+            return;
+
+        // union by rank
+
+        if (rank[a]<rank[b])
+            parent[a] = b;
+        else if (rank[a]>rank[b])
+            parent[b] = a;
+        else
+        {
+            parent[b] = a;
+            rank[a]++;
+        }
+    }
+
+    /// Gather the bodies of each island once all pairs have been joined.
+
+    void build()
+    {
+        const int bodies = (int) parent.size();
+
+        islandOf.resize(bodies);
+        start.clear();
+        members.resize(bodies);
+
+        // number islands in order of their lowest body
+
+        std::vector<int> &number = rank;
+        for (int i=0; i<bodies; i++)
+            number[i] = -1;
+
+        int count = 0;
+        for (int i=0; i<bodies; i++)
+        {
+            const int r = root(i);
+            if (number[r]<0)
+                number[r] = count++;
+            islandOf[i] = number[r];
+        }
+
+        // counting sort of the bodies by island
+
+        start.resize(count + 1, 0);
+        for (int i=0; i<bodies; i++)
+            start[islandOf[i] + 1]++;
+        for (int i=0; i<count; i++)
+            start[i+1] += start[i];
+
+        std::vector<int> fill(start.begin(), start.end() - 1);
+        for (int i=0; i<bodies; i++)
+            members[fill[islandOf[i]]++] = i;
+    }
+
+    /// Number of islands.
+
+    int count() const
+    {
+        return start.empty() ? 0 : (int) start.size() - 1;
+    }
+
+    /// Number of bodies in an island.
+
+    int size(int island) const
+    {
+        return start[island+1] - start[island];
+    }
+
+    /// Get body i of an island.
+
+    int body(int island, int i) const
+    {
+        return members[start[island] + i];
+    }
+
+    /// Get the island a body belongs to.
+
+    int island(int body) const
+    {
+        return islandOf[body];
+    }
+
+private:
+
+    /// Find the root of a body's island, halving the path on the way.
+
+    int root(int i)
+    {
+        while (parent[i]!=i)
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    std::vector<int> parent;            ///< union-find parent of each body.
+    std::vector<int> rank;              ///< union-find rank of each root, reused for island numbering by build.
+    std::vector<int> islandOf;          ///< island of each body.
+    std::vector<int> start;             ///< index of the first body of each island in members, plus one past the end.
+    std::vector<int> members;           ///< bodies sorted by island.
+};
@@ -1,139 +1,242 @@
-/// General mathematics routines
-
-#include <math.h>
-#include <float.h>
-#include <assert.h>
-
-namespace Mathematics
-{
-	const float epsilon = 0.00001f;                         ///< floating point epsilon for single precision. todo: verify epsilon value and usage
-	const float epsilonSquared = epsilon * epsilon;         ///< epsilon value squared
-
-	const float pi = 3.1415926f;                            ///< pi stored at a reasonable precision for single precision floating point.
-
-	/// test for floating point equality within [-epsilon,+epsilon]
-
-	inline bool equal(float a, float b)
-	{
-		const float d = a - b;
-		if (d<epsilon && d>-epsilon) 
-			return true;
-		else 
-			return false;
-	}
-
-	/// determine the minimum floating point value
-
-	inline float minimum(float a, float b)
-	{
-		if (a<b) 
-			return a;
-		else 
-			return b;
-	}
-
-	/// determine the maximum floating point value
-
-	inline float maximum(float a, float b)
-	{
-		if (a>b) 
-			return a;
-		else 
-			return b;
-	}
-
-	/// calculate the square root of a floating point number.
-
-	inline float sqrt(float value)
-	{
-		assert(value>=0);
-		return (float) pow(value, 0.5f);
-	}
-
-	/// calculate the sine of a floating point angle in radians.
-
-	inline float sin(float radians)
-	{
-		return (float) ::sin(radians);
-	}
-
-	/// calculate the cosine of a floating point angle in radians.
-
-	inline float cos(float radians)
-	{
-		return (float) ::cos(radians);
-	}
-
-	/// calculate the tangent of a floating point angle in radians.
-
-	inline float tan(float radians)
-	{
-		return (float) ::tan(radians);
-	}
-
-	/// calculate the arcsine of a floating point value. result is in radians.
-
-	inline float asin(float value)
-	{
-		return (float) ::asin(value);
-	}
-
-	/// calculate the arccosine of a floating point value. result is in radians.
-
-	inline float acos(float value)
-	{
-		return (float) ::acos(value);
-	}
-
-	/// calculate the arctangent of a floating point value y/x. result is in radians.
-
-	inline float atan2(float y, float x)
-	{
-		return (float) ::atan2(y,x);
-	}
-
-	/// calculate the floor of a floating point value.
-	/// the floor is the nearest integer strictly less than or equal to the floating point number.
-
-	inline float floor(float value)
-	{
-		return (float) ::floor(value);
-	}
-
-	/// calculate the ceiling of a floating point value.
-	/// the ceil is the nearest integer strictly greater than or equal to the floating point number.
-
-	inline float ceiling(float value)
-	{                     
-		return (float) ::ceil(value);
-	}
-
-	/// quickly determine the sign of a floating point number.
-
-	inline unsigned int sign(const float& v)
-	{	
-		return (((unsigned int&)v) & 0x80000000);
-	}
-
-	/// fast floating point absolute value.
-
-	inline float abs(float v)
-	{
-		*(int *)&v &= 0x7fffffff;
-		return v;
-	}
-
-	/// interpolate between interval [a,b] with t in [0,1].
-
-	inline float lerp(float a, float b, float t)
-	{
-		return a + (b - a) * t;
-	}
-
-	/// snap floating point number to grid.
-
-	inline float snap(float p, float grid)
-	{
-		return grid ? float( floor((p + grid*0.5f)/grid) * grid) : p;
-	}
-}
+/// General mathematics routines
+
+#include <math.h>
+#include <float.h>
+#include <assert.h>
+
+// define SSE to use the SSE versions of the hot loops that keep their data in
+// registers from load to store: the corner tests in Cube::penetrations, the spin
+// quaternion product and transforms in Cube::Secondary::calculate and the four
+// cubes at a time stages of CubeBatch. Vector, Quaternion and Matrix stay
+// scalar, since loading and storing a register around every small operation
+// costs more than the operation saves. the SSE code performs the same floating
+// point operations in the same order as the scalar code so results are identical
+// either way, see the "sse" section of Benchmark.cpp. build with /arch:AVX (or
+// -mavx) to have the compiler emit the VEX encoded forms of the same code.
+
+#ifdef SSE
+#include <xmmintrin.h>
+#ifdef _MSC_VER
+#define ALIGN16 __declspec(align(16))
+#else
+#define ALIGN16 __attribute__((aligned(16)))
+#endif
+#else
+#define ALIGN16
+#endif
+
+// define DETERMINISTIC to make the simulation produce bit identical results
+// across compilers, optimization levels and machines, so that client and server
+// agree exactly and History only replays on genuine mispredictions.
+//
+// this requires strict IEEE single precision arithmetic with no contraction of
+// multiply-adds into fused instructions and no excess precision intermediates.
+// the pragmas below turn contraction off where the compiler supports it, but the
+// build flags should also say so: /fp:precise /arch:SSE2 for visual c++, and
+// -ffp-contract=off -msse2 -mfpmath=sse (no -ffast-math) for gcc and clang.
+// the transcendental functions below are also replaced by our own polynomial
+// versions in deterministic mode since the c runtime versions differ by platform.
+
+#ifdef DETERMINISTIC
+#if defined(_MSC_VER)
+#pragma float_control(precise, on)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD!=0
+#error DETERMINISTIC requires single precision evaluation: build with SSE2 floating point, not x87
+#endif
+#endif
+
+namespace Mathematics
+{
+	const float epsilon = 0.00001f;                         ///< floating point epsilon for single precision. todo: verify epsilon value and usage
+	const float epsilonSquared = epsilon * epsilon;         ///< epsilon value squared
+
+	const float pi = 3.1415926f;                            ///< pi stored at a reasonable precision for single precision floating point.
+
+	/// test for floating point equality within [-epsilon,+epsilon]
+
+	inline bool equal(float a, float b)
+	{
+		const float d = a - b;
+		if (d<epsilon && d>-epsilon) 
+			return true;
+		else 
+			return false;
+	}
+
+	/// determine the minimum floating point value
+
+	inline float minimum(float a, float b)
+	{
+		if (a<b) 
+			return a;
+		else 
+			return b;
+	}
+
+	/// determine the maximum floating point value
+
+	inline float maximum(float a, float b)
+	{
+		if (a>b) 
+			return a;
+		else 
+			return b;
+	}
+
+	/// calculate the square root of a floating point number.
+	/// ieee 754 requires square root to be correctly rounded, so this is
+	/// deterministic as is provided the result is not kept at excess precision.
+
+	inline float sqrt(float value)
+	{
+		assert(value>=0);
+		#ifdef SSE
+		float result;
+		_mm_store_ss(&result, _mm_sqrt_ss(_mm_set_ss(value)));
+		return result;
+		#else
+		return ::sqrtf(value);
+		#endif
+	}
+
+	/// calculate the sine of a floating point angle in radians.
+	/// in deterministic mode the angle is reduced to [-pi/2,pi/2] and the sine is
+	/// evaluated with a taylor polynomial to x^11, accurate to around 1e-7.
+
+	inline float sin(float radians)
+	{
+		#ifdef DETERMINISTIC
+		const float twoPi = 6.2831853f;
+		const float halfPi = 1.5707963f;
+		float x = radians - twoPi * (float) ::floor(radians / twoPi + 0.5f);
+		if (x>halfPi)
+			x = pi - x;
+		else if (x<-halfPi)
+			x = -pi - x;
+		const float x2 = x * x;
+		return x * (1.0f + x2 * (-1.0f/6.0f + x2 * (1.0f/120.0f + x2 * (-1.0f/5040.0f + x2 * (1.0f/362880.0f + x2 * (-1.0f/39916800.0f))))));
+		#else
+		return (float) ::sin(radians);
+		#endif
+	}
+
+	/// calculate the cosine of a floating point angle in radians.
+
+	inline float cos(float radians)
+	{
+		#ifdef DETERMINISTIC
+		return sin(radians + 1.5707963f);
+		#else
+		return (float) ::cos(radians);
+		#endif
+	}
+
+	/// calculate the tangent of a floating point angle in radians.
+
+	inline float tan(float radians)
+	{
+		#ifdef DETERMINISTIC
+		return sin(radians) / cos(radians);
+		#else
+		return (float) ::tan(radians);
+		#endif
+	}
+
+	/// calculate the arccosine of a floating point value. result is in radians.
+	/// in deterministic mode uses abramowitz and stegun 4.4.46, accurate to around 2e-8
+	/// before rounding. the value is clamped to [-1,1].
+
+	inline float acos(float value)
+	{
+		#ifdef DETERMINISTIC
+		const float x = value<0 ? -value : value;
+		if (x>=1)
+			return value<0 ? pi : 0;
+		const float p = 1.5707963050f + x * (-0.2145988016f + x * (0.0889789874f + x * (-0.0501743046f + 
+		                x * (0.0308918810f + x * (-0.0170881256f + x * (0.0066700901f + x * -0.0012624911f))))));
+		const float result = sqrt(1.0f - x) * p;
+		return value<0 ? pi - result : result;
+		#else
+		return (float) ::acos(value);
+		#endif
+	}
+
+	/// calculate the arcsine of a floating point value. result is in radians.
+
+	inline float asin(float value)
+	{
+		#ifdef DETERMINISTIC
+		return 1.5707963f - acos(value);
+		#else
+		return (float) ::asin(value);
+		#endif
+	}
+
+	/// calculate the arctangent of a floating point value y/x. result is in radians.
+
+	inline float atan2(float y, float x)
+	{
+		return (float) ::atan2(y,x);
+	}
+
+	/// calculate the floor of a floating point value.
+	/// the floor is the nearest integer strictly less than or equal to the floating point number.
+
+	inline float floor(float value)
+	{
+		return (float) ::floor(value);
+	}
+
+	/// calculate the ceiling of a floating point value.
+	/// the ceil is the nearest integer strictly greater than or equal to the floating point number.
+
+	inline float ceiling(float value)
+	{                     
+		return (float) ::ceil(value);
+	}
+
+	/// quickly determine the sign of a floating point number.
+
+	inline unsigned int sign(const float& v)
+	{	
+		return (((unsigned int&)v) & 0x80000000);
+	}
+
+	/// fast floating point absolute value.
+
+	inline float abs(float v)
+	{
+		*(int *)&v &= 0x7fffffff;
+		return v;
+	}
+
+	/// get the bit pattern of a floating point number.
+	/// used for exact comparison and hashing of simulation state.
+
+	inline unsigned int bits(float value)
+	{
+		union { float f; unsigned int i; } u;
+		u.f = value;
+		return u.i;
+	}
+
+	/// interpolate between interval [a,b] with t in [0,1].
+
+	inline float lerp(float a, float b, float t)
+	{
+		return a + (b - a) * t;
+	}
+
+	/// snap floating point number to grid.
+
+	inline float snap(float p, float grid)
+	{
+		return grid ? float( floor((p + grid*0.5f)/grid) * grid) : p;
+	}
+}
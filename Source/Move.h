@@ -1,8 +1,8 @@
-/// Move data.
-
-struct Move
-{
-    unsigned int time;			///< integer time
-    Cube::State state;			///< cube physics state
-    Cube::Input input;			///< cube input
-};
+/// Move data.
+
+struct Move
+{
+    unsigned int time;			///< integer time
+    Cube::State state;			///< cube physics state
+    Cube::Input input;			///< cube input
+};
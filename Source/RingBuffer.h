@@ -0,0 +1,345 @@
+/// Ring buffers.
+///
+/// A ring buffer keeps a queue in an array, adding items at the head and
+/// removing them from the tail. The capacity is always a power of two so that
+/// wrapping an index around the array is a mask rather than a compare or a
+/// divide. The head and tail are free running counters that are only masked
+/// when the array is accessed: the number of items is head - tail even after the
+/// counters overflow, a full buffer is told apart from an empty one without
+/// leaving a slot unused, and the index of an item stays the same for as long
+/// as it is in the buffer, even when the buffer grows.
+///
+/// What happens when adding to a full buffer is chosen explicitly, see Overflow.
+/// LockFreeRingBuffer is a fixed capacity variant for passing items from one
+/// thread to another without locking.
+
+template <typename T> class RingBuffer
+{
+public:
+
+    /// What add does when the buffer is full.
+
+    enum Overflow
+    {
+        Grow,                           ///< double the capacity, so no item is ever lost (default).
+        DropOldest,                     ///< remove the oldest item to make room, for keeping a bounded history.
+        Reject                          ///< keep the buffer as it is and return false.
+    };
+
+    Overflow overflow;                  ///< what add does when the buffer is full.
+
+    /// Constructor.
+    /// @param capacity the number of items the buffer can hold, rounded up to a power of two.
+    /// @param overflow what add does when the buffer is full.
+
+    RingBuffer(unsigned int capacity = 16, Overflow overflow = Grow)
+    {
+        this->overflow = overflow;
+        overflows = 0;
+        resize(capacity);
+    }
+
+    /// Change the capacity, removing all items.
+    /// @param capacity the number of items the buffer can hold, rounded up to a power of two.
+
+    void resize(unsigned int capacity)
+    {
+        unsigned int size = 1;
+        while (size<capacity)
+            size <<= 1;
+
+        assert(size<=0x80000000);
+
+        items.clear();
+        items.resize(size);
+        mask = size - 1;
+
+        clear();
+    }
+
+    /// Remove all items.
+
+    void clear()
+    {
+        first = 0;
+        last = 0;
+    }
+
+    /// Add an item at the head.
+    /// @returns false if the buffer is full and the overflow policy is Reject.
+
+    bool add(const T &item)
+    {
+        if (full())
+        {
+            overflows++;
+
+            if (overflow==Reject)
+                return false;
+            else if (overflow==DropOldest)
+                remove();
+            else
+                grow();
+        }
+
+        items[last & mask] = item;
+        last++;
+
+        return true;
+    }
+
+    /// Remove the oldest item.
+
+    void remove()
+    {
+        assert(!empty());
+        first++;
+    }
+
+    /// The oldest item.
+
+    T& oldest()
+    {
+        assert(!empty());
+        return items[first & mask];
+    }
+
+    /// The newest item.
+
+    T& newest()
+    {
+        assert(!empty());
+        return items[(last-1) & mask];
+    }
+
+    /// Index of the oldest item. The items are tail() up to but not including head().
+
+    unsigned int tail() const
+    {
+        return first;
+    }
+
+    /// Index one past the newest item, where the next item added goes.
+
+    unsigned int head() const
+    {
+        return last;
+    }
+
+    /// Access the item at an index from tail() to head()-1.
+    /// Indices count up from the tail without wrapping, step through the items with ++.
+
+    T& operator[](unsigned int index)
+    {
+        assert(index-first<last-first);
+        return items[index & mask];
+    }
+
+    const T& operator[](unsigned int index) const
+    {
+        assert(index-first<last-first);
+        return items[index & mask];
+    }
+
+    /// Number of items in the buffer.
+
+    unsigned int size() const
+    {
+        return last - first;
+    }
+
+    /// Number of items the buffer can hold before it overflows.
+
+    unsigned int capacity() const
+    {
+        return mask + 1;
+    }
+
+    bool empty() const
+    {
+        return first==last;
+    }
+
+    bool full() const
+    {
+        return last-first>mask;
+    }
+
+    /// Number of times an item was added to a full buffer.
+
+    unsigned int overflowed() const
+    {
+        return overflows;
+    }
+
+private:
+
+    /// Double the capacity, keeping each item at its index.
+
+    void grow()
+    {
+        assert(items.size()<=0x40000000);
+
+        std::vector<T> larger(items.size()*2);
+        const unsigned int largerMask = (unsigned int) larger.size() - 1;
+
+        for (unsigned int i=first; i!=last; i++)
+            larger[i & largerMask] = items[i & mask];
+
+        items.swap(larger);
+        mask = largerMask;
+    }
+
+    std::vector<T> items;               ///< item array, the size is a power of two.
+    unsigned int mask;                  ///< capacity minus one, masks an index into the array.
+    unsigned int first;                 ///< index of the oldest item.
+    unsigned int last;                  ///< index one past the newest item.
+    unsigned int overflows;             ///< number of adds to a full buffer.
+};
+
+/// Lock free ring buffer for one producer thread and one consumer thread.
+///
+/// Only the producer calls add and only the consumer calls remove, then neither
+/// needs a lock: the producer is the only writer of the head and the consumer
+/// the only writer of the tail. An item is written before the head is published
+/// past it with release ordering, and the consumer reads the head with acquire
+/// ordering before reading the item, and the same the other way around for the
+/// tail, so each side only ever sees slots the other has finished with. Each side
+/// also keeps its last view of the other's counter and only reads the real one
+/// when that view says the buffer is full or empty, and the counters are kept on
+/// separate cache lines, so the two threads rarely touch the same cache line.
+///
+/// The capacity is fixed and a full buffer rejects items: the producer cannot
+/// drop items the consumer may be reading, or move the array under it.
+///
+/// Nothing in the game uses it yet, only the "ring_buffers" section of
+/// Benchmark.cpp. The game threads (Workers, Background) take whole jobs and
+/// hand the results back once, with nothing streamed between threads while a
+/// job runs: a correction received during a threaded replay is coalesced and
+/// replayed after it, see Client::receive. It is here for the first producer
+/// and consumer pair, such as receiving packets on a network thread.
+
+template <typename T> class LockFreeRingBuffer
+{
+public:
+
+    /// Constructor.
+    /// @param capacity the number of items the buffer can hold, rounded up to a power of two.
+
+    LockFreeRingBuffer(unsigned int capacity = 1024)
+    {
+        unsigned int size = 1;
+        while (size<capacity)
+            size <<= 1;
+
+        assert(size<=0x80000000);
+
+        items.resize(size);
+        mask = size - 1;
+
+        last = 0;
+        firstSeen = 0;
+        first = 0;
+        lastSeen = 0;
+    }
+
+    /// Add an item. Producer thread only.
+    /// @returns false if the buffer is full.
+
+    bool add(const T &item)
+    {
+        const unsigned int head = last;
+
+        if (head-firstSeen>mask)
+        {
+            firstSeen = acquire(first);
+            if (head-firstSeen>mask)
+                return false;
+        }
+
+        items[head & mask] = item;
+
+        release(last, head + 1);
+
+        return true;
+    }
+
+    /// Remove the oldest item. Consumer thread only.
+    /// @returns false if the buffer is empty.
+
+    bool remove(T &item)
+    {
+        const unsigned int tail = first;
+
+        if (tail==lastSeen)
+        {
+            lastSeen = acquire(last);
+            if (tail==lastSeen)
+                return false;
+        }
+
+        item = items[tail & mask];
+
+        release(first, tail + 1);
+
+        return true;
+    }
+
+    /// Number of items the buffer can hold.
+
+    unsigned int capacity() const
+    {
+        return mask + 1;
+    }
+
+private:
+
+    LockFreeRingBuffer(const LockFreeRingBuffer &other);
+    LockFreeRingBuffer& operator=(const LockFreeRingBuffer &other);
+
+    /// Read a counter written by the other thread, seeing everything it wrote before writing it.
+
+    static unsigned int acquire(const volatile unsigned int &counter)
+    {
+        #if defined(__ATOMIC_ACQUIRE)
+        return __atomic_load_n(&counter, __ATOMIC_ACQUIRE);
+        #elif defined(_WIN32)
+        return counter;                 // visual c++ gives volatile reads acquire semantics
+        #else
+        const unsigned int value = counter;
+        __sync_synchronize();
+        return value;
+        #endif
+    }
+
+    /// Write a counter read by the other thread, after everything written before it.
+
+    static void release(volatile unsigned int &counter, unsigned int value)
+    {
+        #if defined(__ATOMIC_RELEASE)
+        __atomic_store_n(&counter, value, __ATOMIC_RELEASE);
+        #elif defined(_WIN32)
+        counter = value;                // visual c++ gives volatile writes release semantics
+        #else
+        __sync_synchronize();
+        counter = value;
+        #endif
+    }
+
+    enum { CacheLine = 64 };
+
+    std::vector<T> items;               ///< item array, the size is a power of two.
+    unsigned int mask;                  ///< capacity minus one, masks an index into the array.
+
+    char pad0[CacheLine];
+
+    volatile unsigned int last;         ///< index one past the newest item, written by the producer.
+    unsigned int firstSeen;             ///< the producer's last view of first.
+
+    char pad1[CacheLine];
+
+    volatile unsigned int first;        ///< index of the oldest item, written by the consumer.
+    unsigned int lastSeen;              ///< the consumer's last view of last.
+
+    char pad2[CacheLine];
+};
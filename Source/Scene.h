@@ -1,133 +1,1079 @@
-/// Scene class.
-/// Represents the scene managing objects and collision geometry.
-
-const float defaultTightness = 0.25f;
-const float smoothTightness = 0.1f;
-
-struct Scene
-{
-    /// default constructor.
-
-    Scene()
-    {
-        // clear input to defaults
-
-        input.left = false;
-        input.right = false;
-        input.forward = false;
-        input.back = false;
-        input.jump = false;
-
-        // defaults
-
-        logfile = 0;
-        replaying = false;
-        tightness = defaultTightness;
-
-        // start simulation at t=0
-
-        time = 0;
-    }
-
-    /// destructor.
-
-    ~Scene()
-    {
-        #ifdef LOGGING
-        if (logfile)
-        {
-            fclose(logfile);
-            logfile = 0;
-        }
-        #endif
-    }
-
-    /// Initialize the scene.
-    /// Must be called after OpenGL is initialized so that it can extract
-    /// the clip planes for the view frustum.
-
-	void initialize()
-	{
-        // setup collision planes in scene
-
-		Plane left, right, bottom, top, front, back;
-		calculateFrustumPlanes(left, right, bottom, top, front, back);
-
-        front.constant += 2.0f;
-		
-        Plane ramp = Plane(Vector(0,1,-1).unit(), Vector(0,0,5));
-
-		planes.push_back(left);
-		planes.push_back(right);
-		planes.push_back(front);
-		planes.push_back(back);
-        planes.push_back(ramp);
-
-        Plane floor(Vector(0,1,0), 0);
-        planes.push_back(floor);
-    }
-
-    void log(const char filename[])
-    {
-        #ifdef LOGGING
-        logfile = fopen(filename, "w");
-        #endif
-    }
-
-    /// Update the scene from integer time t to t+1.
-
-	void update(unsigned int t)
-	{
-        // log for comparison
-
-        #ifdef LOGGING
-        if (logfile && !replaying)
-        {
-            Vector position = cube.state().position;
-            Quaternion orientation = cube.state().orientation;
-            fprintf(logfile, "%d: position=(%f,%f,%f), orientation=(%f,%f,%f,%f), input=(%d,%d,%d,%d,%d)\n", t, position.x, position.y, position.z, orientation.w, orientation.x, orientation.y, orientation.z, input.left, input.right, input.forward, input.back, input.jump);
-        }
-        #endif
-
-        // time step
-
-        cube.update(input, planes, timestep);
-
-        // update smoothed cube
-
-        if (!replaying)
-            smoothed.smooth(cube.state(), tightness);
-
-        // update smoothing tightness value for adaptive smoothing
-
-        tightness += (defaultTightness - tightness) * 0.01f;
-
-        // advance t
-
-        time ++;
-    }
-
-    /// call this method when a snap occurs to smooooooth it out baby
-
-    void smooth()
-    {
-        tightness = smoothTightness;
-    }
-
-public:
-
-    unsigned int time;              ///< current scene time.
-
-	Cube cube;                      ///< the cube object.
-    Cube::Input input;              ///< current input for the cube.
-
-    Cube smoothed;                  ///< smoothed cube following main cube.
-
-    std::vector<Plane> planes;      ///< the set of collision planes in the scene.
-
-    FILE *logfile;                  ///< file handle for logging (i diff logs to check sync)
-
-    bool replaying;                 ///< true if currently replaying moves (client side correction)
-
-    float tightness;                ///< current smoothing tightness
-};
+/// Scene class.
+/// Represents the scene managing objects and collision geometry.
+/// The scene always has the player cube, and may also have any number of
+/// props which collide with the player cube and with each other.
+/// Each cube is an entity: its components are kept in dense arrays indexed
+/// through Scene::entities, with the player cube always at index 0.
+/// Contacts are resolved either by the penalty forces in the cube force
+/// pipeline or by the sequential impulse contact solver, see Scene::contactMode.
+
+const float defaultTightness = 0.25f;
+const float smoothTightness = 0.1f;
+const float contactMargin = 0.1f;       ///< distance at which cubes start generating contact planes with each other.
+
+#ifdef HEADLESS
+
+/// Calculate frustum planes in world coordinates without OpenGL.
+/// Headless builds have no OpenGL context to read the projection and modelview
+/// matrices back from, so the camera set up by initializeOpenGL is rebuilt here with
+/// Matrix::lookat and Matrix::perspective. Those are left handed with clip depth in
+/// [0,1], so the plane equations differ from the OpenGL version and view space x
+/// is mirrored (which swaps left and right), but the planes agree to within rounding.
+
+inline void calculateFrustumPlanes(Plane &left, Plane &right, Plane &bottom, Plane &top, Plane &front, Plane &back)
+{
+    Matrix view;
+    view.lookat(Vector(0,1.85f,8), Vector(0,0.5f,0), Vector(0,1,0));
+
+    Matrix projection;
+    projection.perspective(45.0f * pi / 180.0f, 4.0f / 3.0f, 0.1f, 15);
+
+    const Matrix clip = projection * view;
+
+    right.normal = Vector(clip.m41 + clip.m11, clip.m42 + clip.m12, clip.m43 + clip.m13);
+    right.constant = - (clip.m44 + clip.m14);
+    right.normalize();
+
+    left.normal = Vector(clip.m41 - clip.m11, clip.m42 - clip.m12, clip.m43 - clip.m13);
+    left.constant = - (clip.m44 - clip.m14);
+    left.normalize();
+
+    bottom.normal = Vector(clip.m41 + clip.m21, clip.m42 + clip.m22, clip.m43 + clip.m23);
+    bottom.constant = - (clip.m44 + clip.m24);
+    bottom.normalize();
+
+    top.normal = Vector(clip.m41 - clip.m21, clip.m42 - clip.m22, clip.m43 - clip.m23);
+    top.constant = - (clip.m44 - clip.m24);
+    top.normalize();
+
+    front.normal = Vector(clip.m31, clip.m32, clip.m33);
+    front.constant = - clip.m34;
+    front.normalize();
+
+    back.normal = Vector(clip.m41 - clip.m31, clip.m42 - clip.m32, clip.m43 - clip.m33);
+    back.constant = - (clip.m44 - clip.m34);
+    back.normalize();
+}
+
+#endif
+
+struct Scene
+{
+    /// Contact resolution mode.
+
+    enum ContactMode
+    {
+        PenaltyContacts,                ///< penalty springs in the cube force pipeline, integrated by the cube integrator (default).
+        SolverContacts                  ///< sequential impulse solver with persistent manifolds, see Solver.
+    };
+
+    /// default constructor.
+
+    Scene()
+    {
+        // the player cube is the first entity and is never removed, so it stays at index 0
+
+        player = addEntity();
+
+        // defaults
+
+        logfile = 0;
+        replaying = false;
+        tightness = defaultTightness;
+        contactMode = PenaltyContacts;
+        continuous = false;
+        continuousSpeed = 5.0f;
+
+        // start simulation at t=0
+
+        time = 0;
+    }
+
+    /// destructor.
+
+    ~Scene()
+    {
+        #ifdef LOGGING
+        if (logfile)
+        {
+            fclose(logfile);
+            logfile = 0;
+        }
+        #endif
+    }
+
+    /// Initialize the scene.
+    /// Must be called after OpenGL is initialized so that it can extract
+    /// the clip planes for the view frustum (except in HEADLESS builds).
+
+	void initialize()
+	{
+        // setup collision planes in scene
+
+		Plane left, right, bottom, top, front, back;
+		calculateFrustumPlanes(left, right, bottom, top, front, back);
+
+        front.constant += 2.0f;
+		
+        Plane ramp = Plane(Vector(0,1,-1).unit(), Vector(0,0,5));
+
+		planes.push_back(left);
+		planes.push_back(right);
+		planes.push_back(front);
+		planes.push_back(back);
+        planes.push_back(ramp);
+
+        Plane floor(Vector(0,1,0), 0);
+        planes.push_back(floor);
+    }
+
+    void log(const char filename[])
+    {
+        #ifdef LOGGING
+        logfile = fopen(filename, "w");
+        #endif
+    }
+
+    /// Update the scene from integer time t to t+1.
+    /// @param t the integer time being updated.
+    /// @param dt the length of the step in seconds.
+
+	void update(unsigned int t, float dt = timestep)
+	{
+        // log for comparison
+
+        #ifdef LOGGING
+        if (logfile && !replaying)
+        {
+            const Cube::Input &input = inputs[0];
+            Vector position = cubes[0].state().position;
+            Quaternion orientation = cubes[0].state().orientation;
+            fprintf(logfile, "%d: position=(%f,%f,%f), orientation=(%f,%f,%f,%f), input=(%d,%d,%d,%d,%d)\n", t, position.x, position.y, position.z, orientation.w, orientation.x, orientation.y, orientation.z, input.left, input.right, input.forward, input.back, input.jump);
+        }
+        #endif
+
+        // stop fast cubes passing through thin geometry
+
+        if (continuous)
+            sweepBodies(dt);
+
+        // time step
+
+        if (contactMode==SolverContacts)
+            updateSolver(dt);
+        else if (cubes.size()==1 && !cubes[0].managedSleep)
+        {
+            if (staticGeometry())
+                findStaticPlanes(dt);
+            cubes[0].update(inputs[0], staticPlanes(0), dt);
+        }
+        else
+            updateBodies(dt);
+
+        // update smoothed cubes. only the player cube is corrected, so the props follow their cubes exactly
+
+        if (!replaying)
+        {
+            smoothedCubes[0].smooth(cubes[0].state(), tightness);
+            for (unsigned int i=1; i<cubes.size(); i++)
+                smoothedCubes[i].smooth(cubes[i].state(), 1);
+        }
+
+        // update smoothing tightness value for adaptive smoothing
+
+        tightness += (defaultTightness - tightness) * 0.01f;
+
+        // advance t
+
+        time ++;
+    }
+
+    /// Add a prop cube to the scene.
+    /// Props are simulated locally only: they are not part of the history
+    /// or the network protocol, and are not rewound when the player cube replays.
+    /// Props are kept packed in the component arrays after the player cube, which
+    /// removing a prop reorders, so hold on to the handle returned rather than an index.
+    /// @returns the handle of the prop, see prop and remove. The new prop is cubes.back().
+
+    Entities::Handle add(const Cube::State &state)
+    {
+        Vector min, max;
+
+        if (broadphase.bodies()==0)
+        {
+            bounds(0, min, max);
+            broadphase.add(min, max);           // the player cube is always body 0
+        }
+
+        // with props the scene decides when cubes sleep, see sleepIslands
+
+        cubes[0].managedSleep = true;
+
+        const Entities::Handle handle = addEntity();
+
+        cubes.back().snap(state);
+        cubes.back().managedSleep = true;
+        smoothedCubes.back().snap(state);
+
+        bounds((int) cubes.size() - 1, min, max);
+        broadphase.add(min, max);
+
+        return handle;
+    }
+
+    /// Remove a prop cube from the scene.
+    /// The last prop moves into the place of the removed prop. Sleeping cubes
+    /// that were touching the removed prop are woken up so they do not float.
+    /// @returns false if the handle is stale or is the player cube, which cannot be removed.
+
+    bool remove(const Entities::Handle &handle)
+    {
+        const int body = entities.find(handle);
+        if (body<=0)
+            return false;
+
+        const int last = (int) cubes.size() - 1;
+
+        const std::vector<int> &others = broadphase.overlapping(body);
+        for (unsigned int i=0; i<others.size(); i++)
+            wake(others[i]);
+
+        broadphase.remove(body);
+        solver.remove(body, last);
+
+        cubes[body] = cubes.back();
+        cubes.pop_back();
+        inputs[body] = inputs.back();
+        inputs.pop_back();
+        smoothedCubes[body] = smoothedCubes.back();
+        smoothedCubes.pop_back();
+        entities.remove(handle);
+
+        if (cubes.size()==1)
+            single();
+
+        return true;
+    }
+
+    /// Look up a prop cube by handle.
+    /// @returns the prop, or null if the handle is stale.
+
+    Cube* prop(const Entities::Handle &handle)
+    {
+        const int index = entities.find(handle);
+        return index<0 ? 0 : &cubes[index];
+    }
+
+    /// The cube of an entity, such as the player cube. The handle must be valid.
+
+    Cube& cube(const Entities::Handle &handle)
+    {
+        return cubes[index(handle)];
+    }
+
+    const Cube& cube(const Entities::Handle &handle) const
+    {
+        return cubes[index(handle)];
+    }
+
+    /// The current input of an entity. Only the player cube is driven by input, the props have none.
+
+    Cube::Input& input(const Entities::Handle &handle)
+    {
+        return inputs[index(handle)];
+    }
+
+    const Cube::Input& input(const Entities::Handle &handle) const
+    {
+        return inputs[index(handle)];
+    }
+
+    /// The smoothed cube of an entity, which follows its cube and is what gets rendered.
+
+    Cube& smoothed(const Entities::Handle &handle)
+    {
+        return smoothedCubes[index(handle)];
+    }
+
+    /// Simulation state of a scene for rolling back to, see snapshot and restore.
+    /// Holds everything that the next update depends on: the time, the input and
+    /// cube components with their sleep state, the entity handles, the broadphase
+    /// pairs and the solver manifolds used for warm starting. The smoothed cubes are
+    /// presentation only and are not included. Reusing a snapshot reuses its memory.
+
+    struct Snapshot
+    {
+        unsigned int time;
+        std::vector<Cube::Input> inputs;
+        std::vector<Cube> cubes;
+        Entities entities;
+        Broadphase broadphase;
+        Solver solver;
+    };
+
+    /// Save the simulation state of the scene.
+
+    void snapshot(Snapshot &snapshot) const
+    {
+        snapshot.time = time;
+        snapshot.inputs = inputs;
+        snapshot.cubes = cubes;
+        snapshot.entities = entities;
+        snapshot.broadphase = broadphase;
+        snapshot.solver = solver;
+    }
+
+    /// Roll the simulation back to a snapshot of this scene.
+    /// Updating from the restored state gives the same results as updating from the state when it was saved.
+    /// Handles of props added after the snapshot was taken are stale after restoring it.
+
+    void restore(const Snapshot &snapshot)
+    {
+        time = snapshot.time;
+        inputs = snapshot.inputs;
+        cubes = snapshot.cubes;
+        entities.restore(snapshot.entities);
+        broadphase = snapshot.broadphase;
+        solver = snapshot.solver;
+
+        smoothedCubes.resize(cubes.size());
+    }
+
+    /// Set this scene up to replay the player cube of another scene.
+    ///
+    /// A replay only moves the player cube, the props take part as static bodies,
+    /// so rather than copying the whole scene this copies the player cube and its
+    /// input, the props whose bounds overlap the box the replay is expected to stay
+    /// inside, and the solver manifolds between them, along with the planes and
+    /// contact settings. The world and terrain are not copied, see World::share.
+    /// The props of the previous replay are removed first, and the memory of this
+    /// scene is reused, so keep the scene for replaying one correction after another.
+    /// @param scene the scene to replay, at its current time.
+    /// @param min minimum corner of the box the player cube stays inside during the replay.
+    /// @param max maximum corner of the box.
+    /// @param handles receives the handle in the other scene of each prop copied, prop i of this scene is handles[i-1].
+
+    void prepareReplay(const Scene &scene, const Vector &min, const Vector &max, std::vector<Entities::Handle> &handles)
+    {
+        while (cubes.size()>1)
+        {
+            const int last = (int) cubes.size() - 1;
+            broadphase.remove(last);
+            entities.remove(entities.handle(last));
+            cubes.pop_back();
+            inputs.pop_back();
+            smoothedCubes.pop_back();
+        }
+
+        time = scene.time;
+        cubes[0] = scene.cubes[0];
+        inputs[0] = scene.inputs[0];
+        planes = scene.planes;
+        contactMode = scene.contactMode;
+        continuous = scene.continuous;
+        continuousSpeed = scene.continuousSpeed;
+
+        Vector bodyMin, bodyMax;
+        bounds(0, bodyMin, bodyMax);
+
+        if (broadphase.bodies()==0)
+            broadphase.add(bodyMin, bodyMax);
+        else
+            broadphase.update(0, bodyMin, bodyMax);
+
+        // copy the nearby props in the same order so the replay adds contacts in the same order
+
+        scene.broadphase.query(min, max, nearby);
+
+        replayMap.assign(scene.cubes.size(), -1);
+        replayMap[0] = 0;
+
+        handles.clear();
+
+        for (unsigned int i=0; i<nearby.size(); i++)
+        {
+            const int body = nearby[i];
+            if (body==0)
+                continue;
+
+            addEntity();
+            cubes.back() = scene.cubes[body];
+
+            bounds((int) cubes.size() - 1, bodyMin, bodyMax);
+            broadphase.add(bodyMin, bodyMax);
+
+            handles.push_back(scene.entities.handle(body));
+            replayMap[body] = (int) cubes.size() - 1;
+        }
+
+        // the player cube comes with the sleep setting of the other scene, which depends on its props
+
+        if (cubes.size()==1)
+            single();
+        else
+            cubes[0].managedSleep = true;
+
+        solver.assign(scene.solver, replayMap);
+    }
+
+    /// Take the solver manifolds of the player cube and the props copied into a replay
+    /// prepared with prepareReplay once it has finished, as replaying on this scene would
+    /// have left them. The manifolds between the props left out are kept, and manifolds
+    /// of props removed since the replay was prepared are dropped. The player cube
+    /// copied back from the replay gets the sleep setting of this scene again.
+    /// @param replay the scene the replay ran on.
+    /// @param handles the handles of the props copied into the replay scene.
+
+    void acceptReplay(const Scene &replay, const std::vector<Entities::Handle> &handles)
+    {
+        replayMap.resize(handles.size() + 1);
+        replayMap[0] = 0;
+
+        for (unsigned int i=0; i<handles.size(); i++)
+            replayMap[i+1] = entities.find(handles[i]);
+
+        solver.merge(replay.solver, replayMap);
+
+        cubes[0].managedSleep = cubes.size()>1;
+    }
+
+    /// call this method when a snap occurs to smooooooth it out baby
+
+    void smooth()
+    {
+        tightness = smoothTightness;
+    }
+
+public:
+
+    unsigned int time;              ///< current scene time.
+
+    Entities::Handle player;        ///< the player cube, the entity kept in sync between client, server and proxy. always at index 0.
+
+    std::vector<Cube> cubes;        ///< physics component: the cube of each entity, packed in no particular order after the player cube. see add.
+    std::vector<Cube::Input> inputs;    ///< input component: the current input of each entity.
+    std::vector<Cube> smoothedCubes;    ///< smoothing component: a cube following the cube of each entity, rendered with its color.
+
+    std::vector<Plane> planes;      ///< the set of collision planes in the scene.
+
+    World world;                    ///< static level geometry collided against as well as the planes. scenes that must agree, such as client and server, need the same world.
+
+    Heightfield terrain;            ///< terrain collided against as well as the planes and world. scenes that must agree need the same tiles loaded.
+
+    FILE *logfile;                  ///< file handle for logging (i diff logs to check sync)
+
+    bool replaying;                 ///< true if currently replaying moves (client side correction)
+
+    float tightness;                ///< current smoothing tightness
+
+    ContactMode contactMode;        ///< how contacts are resolved.
+
+    bool continuous;                ///< if true fast cubes are swept against static geometry each step so they cannot pass through it, see sweepBodies. off by default.
+
+    float continuousSpeed;          ///< cubes moving faster than this in meters per second are swept when continuous is set.
+
+    Solver solver;                  ///< contact solver used in SolverContacts mode. set solver.iterations to trade accuracy for speed.
+
+    Workers workers;                ///< worker threads for updating islands in parallel. none are started by default, see Workers::start.
+
+private:
+
+    /// Go back to just the player cube after the last prop is gone.
+    /// The player cube sleeps by itself again and update takes the single cube path,
+    /// which does not use the broadphase, so the player cube is taken out of it as well
+    /// and added back by the next prop.
+
+    void single()
+    {
+        assert(cubes.size()==1);
+
+        if (broadphase.bodies()>0)
+            broadphase.remove(0);
+
+        cubes[0].managedSleep = false;
+    }
+
+    /// Find touching pairs and build islands.
+    ///
+    /// Body 0 is the player cube and body i is prop i-1. The bounding box of
+    /// every body is moved in the sweep and prune broadphase, then each pair
+    /// it reports is tested with the oriented box narrowphase, see Cube::contact.
+    /// Touching bodies are joined into islands. Pairs of sleeping bodies skip
+    /// the narrowphase but are still joined. With the solver an island wakes up
+    /// as a whole when any body in it is moving, so a cube that lands on a
+    /// sleeping stack wakes the entire stack. With penalty contacts only the
+    /// sleeping cubes a moving cube touches wake up, see sleepIslands.
+
+    void findTouching()
+    {
+        const int count = (int) cubes.size();
+
+        for (int i=0; i<count; i++)
+        {
+            Vector min, max;
+            bounds(i, min, max);
+            broadphase.update(i, min, max);
+        }
+
+        broadphase.pairs(pairs);
+
+        islands.reset(count);
+        touching.clear();
+
+        const float wakeSpeedSquared = 0.1f * 0.1f;
+
+        for (unsigned int i=0; i<pairs.size(); i++)
+        {
+            Touching pair;
+            pair.a = pairs[i].a;
+            pair.b = pairs[i].b;
+
+            if (sleeping(pair.a) && sleeping(pair.b))
+            {
+                islands.join(pair.a, pair.b);
+                continue;
+            }
+
+            if (!CubeBase::contact(properties(pair.a), state(pair.a), secondary(pair.a), properties(pair.b), state(pair.b), secondary(pair.b), contactMargin, pair.planeA, pair.planeB))
+                continue;
+
+            // with penalty contacts a moving cube wakes up a sleeping cube it touches
+
+            if (contactMode==PenaltyContacts)
+            {
+                if (sleeping(pair.a) && secondary(pair.b).velocity.lengthSquared()>wakeSpeedSquared)
+                    wake(pair.a);
+
+                if (sleeping(pair.b) && secondary(pair.a).velocity.lengthSquared()>wakeSpeedSquared)
+                    wake(pair.b);
+            }
+
+            islands.join(pair.a, pair.b);
+            touching.push_back(pair);
+        }
+
+        islands.build();
+
+        if (contactMode==PenaltyContacts)
+            return;
+
+        // with the solver an island wakes up as a whole
+
+        for (int i=0; i<islands.count(); i++)
+        {
+            bool moving = false;
+            for (int j=0; j<islands.size(i) && !moving; j++)
+            {
+                const int body = islands.body(i,j);
+                moving = !sleeping(body) && secondary(body).velocity.lengthSquared()>wakeSpeedSquared;
+            }
+
+            if (moving)
+            {
+                for (int j=0; j<islands.size(i); j++)
+                {
+                    if (sleeping(islands.body(i,j)))
+                        wake(islands.body(i,j));
+                }
+            }
+        }
+    }
+
+    /// Put resting bodies to sleep.
+    /// With the solver an island sleeps as a whole once every body in it is resting.
+    /// Penalty contacts between two moving cubes never quite settle, so with penalty
+    /// contacts each resting cube sleeps on its own and a stack comes to rest from the bottom up.
+
+    void sleepIslands()
+    {
+        if (contactMode==PenaltyContacts)
+        {
+            for (int i=0; i<(int)cubes.size(); i++)
+            {
+                if (!sleeping(i) && canSleep(i) && resting(i))
+                    sleep(i);
+            }
+            return;
+        }
+
+        for (int i=0; i<islands.count(); i++)
+        {
+            bool resting = true;
+            for (int j=0; j<islands.size(i) && resting; j++)
+                resting = canSleep(islands.body(i,j)) && this->resting(islands.body(i,j));
+
+            if (resting)
+            {
+                for (int j=0; j<islands.size(i); j++)
+                {
+                    if (!sleeping(islands.body(i,j)))
+                        sleep(islands.body(i,j));
+                }
+            }
+        }
+    }
+
+    /// Update the player cube and props together with penalty contacts.
+    /// Touching pairs give each cube a contact plane that is added to the world
+    /// planes it collides against this step, then the islands are updated.
+
+    void updateBodies(float dt)
+    {
+        findTouching();
+
+        findStaticPlanes(dt);
+
+        for (unsigned int i=0; i<touching.size(); i++)
+        {
+            bodyPlanes[touching[i].a].push_back(touching[i].planeA);
+            bodyPlanes[touching[i].b].push_back(touching[i].planeB);
+        }
+
+        Job job = { this, UpdatePhase, dt };
+        workers.run(islandJob, &job, islands.count());
+
+        sleepIslands();
+    }
+
+    /// Update the player cube and props with the contact solver.
+    ///
+    /// Each cube integrates its velocity without contact forces, the corners of
+    /// each cube inside a world plane or the contact plane of another cube are
+    /// handed to the solver, and the solver corrects the velocities of all the
+    /// cubes in each island together before they integrate their positions.
+    /// Sleeping cubes, and props while replaying, take part as static bodies.
+
+    void updateSolver(float dt)
+    {
+        const int count = (int) cubes.size();
+
+        if (cubes.size()==1)
+        {
+            islands.reset(1);
+            islands.build();
+            touching.clear();
+        }
+        else
+            findTouching();
+
+        if (staticGeometry())
+            findStaticPlanes(dt);
+
+        // integrate velocities without contacts
+
+        bodies.resize(count);
+
+        Job job = { this, VelocityPhase, dt };
+        workers.run(islandJob, &job, islands.count());
+
+        // gather contacts. the solver manifolds are shared by all islands so this is serial
+
+        solver.begin();
+
+        for (int i=0; i<count; i++)
+        {
+            if (bodies[i].inverseMass==0)
+                continue;
+
+            Cube::Corners corners;
+            CubeBase::calculateCorners(properties(i), secondary(i), corners);
+
+            const float radius = properties(i).size * 0.87f;
+
+            const std::vector<Plane> &bodyStatic = staticPlanes(i);
+
+            for (unsigned int j=0; j<bodyStatic.size(); j++)
+            {
+                const Plane &plane = bodyStatic[j];
+
+                if (state(i).position.dot(plane.normal) - plane.constant > radius)
+                    continue;
+
+                float penetration[8];
+                const int mask = CubeBase::penetrations(corners, plane, penetration);
+                if (!mask)
+                    continue;
+
+                // world surfaces are numbered after the scene planes so their manifolds persist as the cube moves
+
+                const int surface = j<planes.size() ? (int) j : (int) planes.size() + bodySurfaces[i][j-planes.size()];
+
+                solver.add(i, Solver::world(surface), plane.normal, plane.velocity, corners, penetration, mask);
+            }
+        }
+
+        for (unsigned int i=0; i<touching.size(); i++)
+        {
+            const Touching &pair = touching[i];
+
+            if (bodies[pair.a].inverseMass==0 && bodies[pair.b].inverseMass==0)
+                continue;
+
+            Cube::Corners corners;
+            float penetration[8];
+
+            CubeBase::calculateCorners(properties(pair.a), secondary(pair.a), corners);
+            int mask = CubeBase::penetrations(corners, pair.planeA, penetration);
+            if (mask)
+                solver.add(pair.a, pair.b, pair.planeA.normal, Vector(0,0,0), corners, penetration, mask);
+
+            CubeBase::calculateCorners(properties(pair.b), secondary(pair.b), corners);
+            mask = CubeBase::penetrations(corners, pair.planeB, penetration);
+            if (mask)
+                solver.add(pair.b, pair.a, pair.planeB.normal, Vector(0,0,0), corners, penetration, mask);
+        }
+
+        // solve each island and integrate positions
+
+        solver.prepare(bodies, dt, &islands);
+
+        job.phase = SolvePhase;
+        workers.run(islandJob, &job, islands.count());
+
+        job.phase = PositionPhase;
+        workers.run(islandJob, &job, islands.count());
+
+        sleepIslands();
+    }
+
+    /// Island update phases, each is run for all islands before the next starts.
+
+    enum Phase
+    {
+        UpdatePhase,                    ///< update cubes with penalty contacts.
+        VelocityPhase,                  ///< integrate cube velocities for the solver.
+        SolvePhase,                     ///< solve island contacts.
+        PositionPhase                   ///< integrate cube positions with the solved velocities.
+    };
+
+    /// An island update phase being run by the workers.
+
+    struct Job
+    {
+        Scene *scene;
+        Phase phase;
+        float dt;
+    };
+
+    static void islandJob(void *data, int island)
+    {
+        const Job &job = *(const Job*) data;
+        job.scene->updateIsland(job.phase, island, job.dt);
+    }
+
+    /// Run an update phase for one island.
+    /// Islands are independent, so this may run on any thread at the same time as other islands.
+
+    void updateIsland(Phase phase, int island, float dt)
+    {
+        if (phase==SolvePhase)
+        {
+            solver.solve(island);
+            return;
+        }
+
+        for (int j=0; j<islands.size(island); j++)
+        {
+            const int i = islands.body(island, j);
+
+            switch (phase)
+            {
+                case UpdatePhase:
+                {
+                    if (i==0 || !replaying)
+                        cubes[i].update(inputs[i], bodyPlanes[i], dt);
+                }
+                break;
+
+                case VelocityPhase:
+                {
+                    const bool moving = (i==0 || !replaying) && cubes[i].integrateVelocity(inputs[i], staticPlanes(i), dt);
+
+                    Solver::Body &body = bodies[i];
+                    body.position = state(i).position;
+                    body.velocity = secondary(i).velocity;
+                    body.angularVelocity = secondary(i).angularVelocity;
+                    body.inverseMass = moving ? properties(i).inverseMass : 0;
+                    body.inverseInertia = moving ? properties(i).inverseInertiaTensor : 0;
+                }
+                break;
+
+                case PositionPhase:
+                {
+                    const Solver::Body &body = bodies[i];
+
+                    if (body.inverseMass==0)
+                        break;
+
+                    cubes[i].integratePosition(body.velocity, body.angularVelocity, body.contacts, dt);
+                }
+                break;
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    /// Continuous collision detection against static geometry.
+    ///
+    /// Contacts are found at the corners of each cube at the start of a step,
+    /// so a cube that moves further than the thickness of a wall in one step
+    /// can pass straight through it. Before the step each awake cube moving
+    /// faster than continuousSpeed sweeps its corners along its velocity against
+    /// the scene planes, the world and the terrain. If a corner would cross a
+    /// surface during the step, the cube is moved to just short of where it first
+    /// touches and its velocity into the surface is removed, so the contacts of
+    /// the step hold it there instead of missing the surface. Rotation during the
+    /// step is ignored, the corners move with the linear velocity only.
+
+    void sweepBodies(float dt)
+    {
+        const float skin = 0.001f;
+
+        const int count = (int) cubes.size();
+
+        for (int i=0; i<count; i++)
+        {
+            if (sleeping(i) || (i && replaying))
+                continue;
+
+            const Vector velocity = secondary(i).velocity;
+            if (velocity.lengthSquared()<=continuousSpeed*continuousSpeed)
+                continue;
+
+            const Vector displacement = velocity * dt;
+
+            Cube::Corners corners;
+            CubeBase::calculateCorners(properties(i), secondary(i), corners);
+
+            Vector points[8];
+            for (int j=0; j<8; j++)
+                points[j] = corners.point(j);
+
+            float fraction = 1;
+            Vector normal;
+            bool hit = false;
+
+            for (unsigned int j=0; j<planes.size(); j++)
+            {
+                const float approach = displacement.dot(planes[j].normal);
+                if (approach>=0)
+                    continue;
+
+                for (int k=0; k<8; k++)
+                {
+                    const float before = points[k].dot(planes[j].normal) - planes[j].constant;
+                    if (before<0 || before + approach>=0)
+                        continue;
+
+                    const float t = before / -approach;
+                    if (t<fraction)
+                    {
+                        fraction = t;
+                        normal = planes[j].normal;
+                        hit = true;
+                    }
+                }
+            }
+
+            if (!world.empty() && world.sweep(points, 8, displacement, fraction, normal))
+                hit = true;
+
+            if (!terrain.empty() && terrain.sweep(points, 8, displacement, fraction, normal))
+                hit = true;
+
+            if (!hit)
+                continue;
+
+            const Vector offset = displacement * fraction + normal * skin;
+
+            cubes[i].impact(offset, normal);
+        }
+    }
+
+    /// Returns true if there is static geometry besides the scene planes.
+
+    bool staticGeometry() const
+    {
+        return !world.empty() || !terrain.empty();
+    }
+
+    /// Find the static collision planes of each body for this step.
+    /// These are the scene planes, the planes of the world surfaces near the body
+    /// (see World::query) and the planes of the terrain triangles under its corners
+    /// (see Heightfield::query). Sleeping bodies whose sleep the scene manages only
+    /// get the scene planes. A sleeping player cube on its own gets all of them, so
+    /// that it wakes when the world or terrain under it changes, see Cube::disturbed.
+    /// World surfaces are numbered from zero and terrain triangles after them.
+    ///
+    /// The scene planes stay at the front of the planes of each body from one step
+    /// to the next, so only the planes after them are found again. They are copied
+    /// in again only when the scene planes have changed since the last step.
+
+    void findStaticPlanes(float dt)
+    {
+        const int count = (int) cubes.size();
+
+        bodyPlanes.resize(count);
+        bodySurfaces.resize(count);
+
+        const bool changed = !samePlanes(planes, bodyScenePlanes);
+        if (changed)
+            bodyScenePlanes = planes;
+
+        for (int i=0; i<count; i++)
+        {
+            if (changed || bodyPlanes[i].size()<planes.size())
+                bodyPlanes[i].assign(planes.begin(), planes.end());
+            else
+                bodyPlanes[i].resize(planes.size());
+
+            bodySurfaces[i].clear();
+
+            if (sleeping(i) && cubes[i].managedSleep)
+                continue;
+
+            const float margin = contactMargin + secondary(i).velocity.length() * dt;
+
+            if (!world.empty())
+                world.query(state(i).position, properties(i).size * 0.87f + margin, bodyPlanes[i], bodySurfaces[i]);
+
+            if (!terrain.empty())
+            {
+                Cube::Corners corners;
+                CubeBase::calculateCorners(properties(i), secondary(i), corners);
+
+                Vector points[8];
+                for (int j=0; j<8; j++)
+                    points[j] = corners.point(j);
+
+                const unsigned int first = bodySurfaces[i].size();
+
+                terrain.query(points, 8, margin, bodyPlanes[i], bodySurfaces[i]);
+
+                for (unsigned int j=first; j<bodySurfaces[i].size(); j++)
+                    bodySurfaces[i][j] += world.surfaces();
+            }
+        }
+    }
+
+    /// Compare two sets of planes exactly, see findStaticPlanes.
+
+    static bool samePlanes(const std::vector<Plane> &a, const std::vector<Plane> &b)
+    {
+        if (a.size()!=b.size())
+            return false;
+
+        for (unsigned int i=0; i<a.size(); i++)
+        {
+            if (a[i].normal.x!=b[i].normal.x || a[i].normal.y!=b[i].normal.y || a[i].normal.z!=b[i].normal.z || a[i].constant!=b[i].constant ||
+                a[i].velocity.x!=b[i].velocity.x || a[i].velocity.y!=b[i].velocity.y || a[i].velocity.z!=b[i].velocity.z)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Static collision planes of a body found by findStaticPlanes, or just the scene planes if there is no static geometry.
+
+    const std::vector<Plane>& staticPlanes(int body) const
+    {
+        return staticGeometry() ? bodyPlanes[body] : planes;
+    }
+
+    /// Bounding box of a body for the broadphase: its bounding sphere plus the contact margin.
+
+    void bounds(int body, Vector &min, Vector &max) const
+    {
+        const Vector position = state(body).position;
+        const float radius = properties(body).size * 0.87f + contactMargin;
+        min = position - Vector(radius,radius,radius);
+        max = position + Vector(radius,radius,radius);
+    }
+
+    const Cube::Properties& properties(int body) const
+    {
+        return cubes[body].properties;
+    }
+
+    const Cube::State& state(int body) const
+    {
+        return cubes[body].state();
+    }
+
+    const Cube::Secondary& secondary(int body) const
+    {
+        return cubes[body].secondary();
+    }
+
+    bool sleeping(int body) const
+    {
+        return cubes[body].sleeping();
+    }
+
+    void wake(int body)
+    {
+        cubes[body].wake();
+    }
+
+    bool resting(int body) const
+    {
+        return cubes[body].resting();
+    }
+
+    bool canSleep(int body) const
+    {
+        return cubes[body].canSleep;
+    }
+
+    void sleep(int body)
+    {
+        cubes[body].sleep();
+    }
+
+    /// Add an entity with default components at the end of the component arrays.
+
+    Entities::Handle addEntity()
+    {
+        const Cube::Input none = { false, false, false, false, false };
+
+        cubes.push_back(Cube());
+        inputs.push_back(none);
+        smoothedCubes.push_back(Cube());
+
+        return entities.add();
+    }
+
+    /// Dense index of an entity. The handle must be valid.
+
+    int index(const Entities::Handle &handle) const
+    {
+        const int index = entities.find(handle);
+        assert(index>=0);
+        return index;
+    }
+
+    Entities entities;                              ///< entity handles, entity i has cubes[i], inputs[i] and smoothedCubes[i].
+    Broadphase broadphase;                          ///< sweep and prune broadphase over the player cube and props.
+    std::vector<Broadphase::Pair> pairs;            ///< overlapping pairs reported by the broadphase this step.
+    std::vector< std::vector<Plane> > bodyPlanes;   ///< collision planes for each body this step, starting with the scene planes.
+    std::vector<Plane> bodyScenePlanes;             ///< the scene planes at the front of each of bodyPlanes, see findStaticPlanes.
+    std::vector< std::vector<int> > bodySurfaces;   ///< world surface of each collision plane after the scene planes.
+
+    /// A pair of cubes in contact, with the contact plane of each.
+
+    struct Touching
+    {
+        int a;
+        int b;
+        Plane planeA;
+        Plane planeB;
+    };
+
+    std::vector<Touching> touching;                 ///< touching pairs this step.
+    Islands islands;                                ///< islands of touching bodies this step.
+    std::vector<Solver::Body> bodies;               ///< solver bodies indexed like the broadphase (solver mode).
+    std::vector<int> nearby;                        ///< bodies of another scene near a replay, see prepareReplay.
+    std::vector<int> replayMap;                     ///< index in one scene of each body of the other, see prepareReplay and acceptReplay.
+};
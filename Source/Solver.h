@@ -0,0 +1,535 @@
+/// Sequential impulse contact solver.
+///
+/// The penalty contacts in the cube force pipeline give each corner contact
+/// its own spring, so a cube resting on another cube is pushed around by every
+/// spring under it and stacks need small timesteps to stay stable. The solver
+/// instead treats each contact as a constraint that the two bodies must not
+/// approach each other at the contact point, and satisfies all the constraints
+/// together by applying an impulse at each contact in turn, iterating over the
+/// whole set a number of times. Friction is solved the same way with its
+/// impulse clamped to the coulomb cone of the normal impulse.
+///
+/// Contact points are kept in manifolds between steps, one manifold for each
+/// cube touching a world plane or another cube, and each point is identified
+/// by the cube corner that generated it. The impulses accumulated for a point
+/// are remembered and applied again at the start of the next step (warm
+/// starting), so a resting stack starts each step close to the solution and
+/// only a few iterations are needed to converge.
+///
+/// Penetration is corrected by biasing the target normal velocity (baumgarte
+/// stabilization), allowing a small slop so resting contacts stay in contact.
+
+class Solver
+{
+public:
+
+    /// A body being solved.
+    /// Bodies with zero inverse mass and inertia are static: contacts push
+    /// other bodies away from them but their velocity is never changed.
+
+    struct Body
+    {
+        Vector position;                ///< position of the center of mass.
+        Vector velocity;                ///< linear velocity, updated by solve.
+        Vector angularVelocity;         ///< angular velocity, updated by solve.
+        float inverseMass;              ///< inverse mass, zero for static bodies.
+        float inverseInertia;           ///< inverse of the (scalar) inertia tensor, zero for static bodies.
+        int contacts;                   ///< number of contact points touching the body this step, set by solve.
+    };
+
+    /// Solver statistics for the most recent step.
+
+    struct Statistics
+    {
+        int manifolds;                  ///< number of active manifolds.
+        int points;                     ///< number of contact points.
+        int warmStarted;                ///< number of contact points that kept their impulses from the previous step.
+        float penetration;              ///< deepest penetration of any contact point.
+
+        void clear()
+        {
+            manifolds = 0;
+            points = 0;
+            warmStarted = 0;
+            penetration = 0;
+        }
+    };
+
+    int iterations;                     ///< number of velocity iterations per step.
+    bool warmStarting;                  ///< if false every step starts from zero impulses.
+    float friction;                     ///< coulomb friction coefficient.
+    float baumgarte;                    ///< fraction of the penetration beyond the slop corrected each step.
+    float slop;                         ///< penetration allowed before it is corrected.
+
+    Statistics statistics;              ///< statistics for the most recent step.
+
+    Solver()
+    {
+        iterations = 8;
+        warmStarting = true;
+        friction = 0.5f;
+        baumgarte = 0.1f;
+        slop = 0.02f;
+        statistics.clear();
+    }
+
+    /// Identifier of world plane i for use as the other body in add.
+
+    static int world(int plane)
+    {
+        return -1 - plane;
+    }
+
+    /// Forget the manifolds of a removed body.
+    /// The last body takes the index of the removed body, so its manifolds are
+    /// renumbered and keep warm starting.
+    /// @param body the index of the removed body.
+    /// @param last the index of the last body before the removal.
+
+    void remove(int body, int last)
+    {
+        Manifolds moved;
+
+        for (Manifolds::iterator i = manifolds.begin(); i!=manifolds.end();)
+        {
+            Manifold &manifold = i->second;
+
+            if (manifold.body==body || manifold.other==body)
+                manifolds.erase(i++);
+            else if (manifold.body==last || manifold.other==last)
+            {
+                if (manifold.body==last)
+                    manifold.body = body;
+                else
+                    manifold.other = body;
+
+                moved[std::make_pair(manifold.body, manifold.other)] = manifold;
+                manifolds.erase(i++);
+            }
+            else
+                ++i;
+        }
+
+        manifolds.insert(moved.begin(), moved.end());
+    }
+
+    /// Take the settings and manifolds of another solver, with its bodies renumbered.
+    /// Used to warm start a scene that holds a subset of the bodies of another scene.
+    /// The manifolds of this solver are forgotten.
+    /// @param other the solver to copy.
+    /// @param map the index in this solver of each body of the other solver, or -1 to leave out the manifolds of the body.
+
+    void assign(const Solver &other, const std::vector<int> &map)
+    {
+        iterations = other.iterations;
+        warmStarting = other.warmStarting;
+        friction = other.friction;
+        baumgarte = other.baumgarte;
+        slop = other.slop;
+
+        manifolds.clear();
+
+        copy(other, map);
+    }
+
+    /// Take the manifolds of another solver for the bodies it shares with this one.
+    /// The manifolds of this solver that touch a body in the map are replaced by those
+    /// of the other solver, the manifolds between the other bodies are kept.
+    /// @param other the solver holding a subset of the bodies of this one.
+    /// @param map the index in this solver of each body of the other solver, or -1 to leave out the manifolds of the body.
+
+    void merge(const Solver &other, const std::vector<int> &map)
+    {
+        std::vector<bool> mapped;
+
+        for (unsigned int i=0; i<map.size(); i++)
+        {
+            if (map[i]<0)
+                continue;
+            if (map[i]>=(int)mapped.size())
+                mapped.resize(map[i]+1, false);
+            mapped[map[i]] = true;
+        }
+
+        for (Manifolds::iterator i = manifolds.begin(); i!=manifolds.end();)
+        {
+            const Manifold &manifold = i->second;
+
+            const bool body = manifold.body<(int)mapped.size() && mapped[manifold.body];
+            const bool with = manifold.other>=0 && manifold.other<(int)mapped.size() && mapped[manifold.other];
+
+            if (body || with)
+                manifolds.erase(i++);
+            else
+                ++i;
+        }
+
+        copy(other, map);
+    }
+
+    /// Start collecting contacts for a new step.
+
+    void begin()
+    {
+        statistics.clear();
+
+        for (Manifolds::iterator i = manifolds.begin(); i!=manifolds.end(); ++i)
+            i->second.active = false;
+    }
+
+    /// Add contact points between the corners of a body and a plane.
+    /// Corners keep the impulses they had in this manifold last step.
+    /// @param body the index of the body the corners belong to.
+    /// @param other the index of the body the plane belongs to, or Solver::world(i) for world plane i.
+    /// @param normal the plane normal, pointing from the other body towards this body.
+    /// @param surface the velocity of the plane surface, used for world planes.
+    /// @param corners the corners of the body in world space.
+    /// @param penetration the penetration depth of each corner.
+    /// @param mask bit i set if corner i is in contact, see CubeBase::penetrations.
+
+    void add(int body, int other, const Vector &normal, const Vector &surface, const CubeBase::Corners &corners, const float penetration[8], int mask)
+    {
+        Manifold &manifold = manifolds[std::make_pair(body, other)];
+
+        Point previous[8];
+        const int previousCount = manifold.active ? 0 : manifold.count;
+        for (int i=0; i<previousCount; i++)
+            previous[i] = manifold.points[i];
+
+        manifold.body = body;
+        manifold.other = other;
+        manifold.normal = normal;
+        manifold.surface = surface;
+        manifold.count = 0;
+        manifold.active = true;
+
+        const Vector axis = Mathematics::abs(normal.x)<0.9f ? Vector(1,0,0) : Vector(0,1,0);
+        const Vector tangent0 = normal.cross(axis).unit();
+        const Vector tangent1 = normal.cross(tangent0);
+
+        for (int j=0; j<8; j++)
+        {
+            if (!(mask & (1<<j)))
+                continue;
+
+            Point &point = manifold.points[manifold.count++];
+            point.feature = j;
+            point.position = corners.point(j);
+            point.penetration = penetration[j];
+            point.tangent[0] = tangent0;
+            point.tangent[1] = tangent1;
+            point.normalImpulse = 0;
+            point.tangentImpulse[0] = 0;
+            point.tangentImpulse[1] = 0;
+
+            if (!warmStarting)
+                continue;
+
+            for (int i=0; i<previousCount; i++)
+            {
+                if (previous[i].feature!=j)
+                    continue;
+
+                // carry the friction impulse over in world space, the tangents follow the normal
+
+                const Vector frictionImpulse = previous[i].tangent[0] * previous[i].tangentImpulse[0] + previous[i].tangent[1] * previous[i].tangentImpulse[1];
+
+                point.normalImpulse = previous[i].normalImpulse;
+                point.tangentImpulse[0] = frictionImpulse.dot(tangent0);
+                point.tangentImpulse[1] = frictionImpulse.dot(tangent1);
+
+                statistics.warmStarted++;
+                break;
+            }
+        }
+    }
+
+    /// Solve all contacts added since begin.
+    /// Manifolds that were not added this step are discarded.
+    /// @param bodies the bodies indexed by the body indices passed to add. velocities are updated in place.
+    /// @param dt the timestep in seconds.
+
+    void solve(std::vector<Body> &bodies, float dt)
+    {
+        prepare(bodies, dt, 0);
+        solve(0);
+    }
+
+    /// Prepare the contacts added since begin for solving island by island.
+    /// Manifolds that were not added this step are discarded. Contacts are grouped
+    /// by the island of their bodies, then each island is solved with solve(island).
+    /// @param bodies the bodies indexed by the body indices passed to add. must stay in place until solved.
+    /// @param dt the timestep in seconds.
+    /// @param islands the islands of the bodies, or 0 to solve all contacts as a single island.
+
+    void prepare(std::vector<Body> &bodies, float dt, const Islands *islands)
+    {
+        for (unsigned int i=0; i<bodies.size(); i++)
+            bodies[i].contacts = 0;
+
+        // flatten the active manifolds into constraints
+
+        unsorted.clear();
+        islandOf.clear();
+
+        int manifoldCount = 0;
+
+        Manifolds::iterator i = manifolds.begin();
+        while (i!=manifolds.end())
+        {
+            Manifold &manifold = i->second;
+
+            if (!manifold.active)
+            {
+                manifolds.erase(i++);
+                continue;
+            }
+
+            manifoldCount++;
+
+            Body *a = &bodies[manifold.body];
+            Body *b = manifold.other>=0 ? &bodies[manifold.other] : &ground;
+
+            for (int j=0; j<manifold.count; j++)
+            {
+                Point &point = manifold.points[j];
+
+                Constraint constraint;
+                constraint.a = a;
+                constraint.b = b;
+                constraint.point = &point;
+                constraint.normal = manifold.normal;
+                constraint.surface = manifold.surface;
+                constraint.ra = point.position - a->position;
+                constraint.rb = manifold.other>=0 ? point.position - b->position : Vector(0,0,0);
+
+                const Vector ran = constraint.ra.cross(constraint.normal);
+                const Vector rbn = constraint.rb.cross(constraint.normal);
+                const float normalMass = a->inverseMass + ran.dot(ran) * a->inverseInertia + b->inverseMass + rbn.dot(rbn) * b->inverseInertia;
+
+                if (normalMass<=0)
+                    continue;               // both bodies are static
+
+                constraint.normalMass = 1.0f / normalMass;
+
+                for (int t=0; t<2; t++)
+                {
+                    const Vector rat = constraint.ra.cross(point.tangent[t]);
+                    const Vector rbt = constraint.rb.cross(point.tangent[t]);
+                    constraint.tangentMass[t] = 1.0f / (a->inverseMass + rat.dot(rat) * a->inverseInertia + b->inverseMass + rbt.dot(rbt) * b->inverseInertia);
+                }
+
+                const float error = point.penetration - slop;
+                constraint.bias = error>0 ? baumgarte / dt * error : 0;
+
+                a->contacts++;
+                b->contacts++;
+
+                if (point.penetration>statistics.penetration)
+                    statistics.penetration = point.penetration;
+
+                unsorted.push_back(constraint);
+                islandOf.push_back(islands ? islands->island(manifold.body) : 0);
+            }
+
+            ++i;
+        }
+
+        statistics.manifolds = manifoldCount;
+        statistics.points = (int) unsorted.size();
+
+        // counting sort of the constraints by island, keeping their order within each island
+
+        const int count = islands ? islands->count() : 1;
+
+        start.assign(count + 1, 0);
+        for (unsigned int j=0; j<unsorted.size(); j++)
+            start[islandOf[j] + 1]++;
+        for (int j=0; j<count; j++)
+            start[j+1] += start[j];
+
+        std::vector<int> fill(start.begin(), start.end() - 1);
+        constraints.resize(unsorted.size());
+        for (unsigned int j=0; j<unsorted.size(); j++)
+            constraints[fill[islandOf[j]]++] = unsorted[j];
+    }
+
+    /// Solve the contacts of one island prepared by prepare.
+    /// Islands share no moving bodies, so different islands may be solved at the same time on different threads.
+
+    void solve(int island)
+    {
+        const int first = start[island];
+        const int last = start[island+1];
+
+        // warm start
+
+        for (int j=first; j<last; j++)
+        {
+            const Constraint &constraint = constraints[j];
+            const Point &point = *constraint.point;
+            apply(constraint, constraint.normal * point.normalImpulse + point.tangent[0] * point.tangentImpulse[0] + point.tangent[1] * point.tangentImpulse[1]);
+        }
+
+        // iterate
+
+        for (int iteration=0; iteration<iterations; iteration++)
+        {
+            for (int j=first; j<last; j++)
+            {
+                Constraint &constraint = constraints[j];
+                Point &point = *constraint.point;
+
+                // friction first so the normal impulse, which matters more, is solved last
+
+                const float limit = friction * point.normalImpulse;
+
+                for (int t=0; t<2; t++)
+                {
+                    const float speed = point.tangent[t].dot(velocity(constraint));
+                    float accumulated = point.tangentImpulse[t] - speed * constraint.tangentMass[t];
+                    if (accumulated>limit)
+                        accumulated = limit;
+                    else if (accumulated<-limit)
+                        accumulated = -limit;
+                    const float delta = accumulated - point.tangentImpulse[t];
+                    point.tangentImpulse[t] = accumulated;
+                    apply(constraint, point.tangent[t] * delta);
+                }
+
+                // normal
+
+                const float speed = constraint.normal.dot(velocity(constraint));
+                float accumulated = point.normalImpulse + (constraint.bias - speed) * constraint.normalMass;
+                if (accumulated<0)
+                    accumulated = 0;
+                const float delta = accumulated - point.normalImpulse;
+                point.normalImpulse = accumulated;
+                apply(constraint, constraint.normal * delta);
+            }
+        }
+    }
+
+private:
+
+    /// A contact point in a manifold.
+
+    struct Point
+    {
+        int feature;                    ///< index of the corner that generated the point.
+        Vector position;                ///< contact point in world space.
+        float penetration;              ///< penetration depth.
+        Vector tangent[2];              ///< friction directions.
+        float normalImpulse;            ///< accumulated normal impulse.
+        float tangentImpulse[2];        ///< accumulated friction impulse along each tangent.
+    };
+
+    /// Contact points between a body and a world plane or another body.
+
+    struct Manifold
+    {
+        int body;                       ///< body the contact points belong to.
+        int other;                      ///< other body, or Solver::world(i) for world plane i.
+        Vector normal;                  ///< contact normal from the other body towards this body.
+        Vector surface;                 ///< velocity of the world plane surface.
+        int count;                      ///< number of contact points.
+        Point points[8];                ///< contact points, at most one for each corner.
+        bool active;                    ///< true if the manifold was added this step.
+
+        Manifold()
+        {
+            count = 0;
+            active = false;
+        }
+    };
+
+    /// A contact point prepared for solving.
+
+    struct Constraint
+    {
+        Body *a;
+        Body *b;
+        Point *point;
+        Vector normal;
+        Vector surface;
+        Vector ra;                      ///< contact point relative to body a.
+        Vector rb;                      ///< contact point relative to body b.
+        float normalMass;               ///< effective mass along the normal.
+        float tangentMass[2];           ///< effective mass along each tangent.
+        float bias;                     ///< target normal velocity for penetration correction.
+    };
+
+    /// Add the manifolds of another solver, with its bodies renumbered, see assign and merge.
+
+    void copy(const Solver &other, const std::vector<int> &map)
+    {
+        for (Manifolds::const_iterator i = other.manifolds.begin(); i!=other.manifolds.end(); ++i)
+        {
+            const Manifold &manifold = i->second;
+
+            const int body = manifold.body<(int)map.size() ? map[manifold.body] : -1;
+            const int with = manifold.other<0 ? manifold.other : manifold.other<(int)map.size() ? map[manifold.other] : -1;
+
+            if (body<0 || (manifold.other>=0 && with<0))
+                continue;
+
+            Manifold &copy = manifolds[std::make_pair(body, with)];
+            copy = manifold;
+            copy.body = body;
+            copy.other = with;
+        }
+    }
+
+    /// Relative velocity of body a with respect to body b at the contact point.
+
+    static Vector velocity(const Constraint &constraint)
+    {
+        const Body &a = *constraint.a;
+        const Body &b = *constraint.b;
+        return a.velocity + a.angularVelocity.cross(constraint.ra) - b.velocity - b.angularVelocity.cross(constraint.rb) - constraint.surface;
+    }
+
+    /// Apply an impulse to body a at the contact point and the opposite impulse to body b.
+    /// Static bodies are never written to, they may be shared by islands solving at the same time.
+
+    static void apply(const Constraint &constraint, const Vector &impulse)
+    {
+        Body &a = *constraint.a;
+        Body &b = *constraint.b;
+
+        if (a.inverseMass>0)
+        {
+            a.velocity += impulse * a.inverseMass;
+            a.angularVelocity += constraint.ra.cross(impulse) * a.inverseInertia;
+        }
+
+        if (b.inverseMass>0)
+        {
+            b.velocity -= impulse * b.inverseMass;
+            b.angularVelocity -= constraint.rb.cross(impulse) * b.inverseInertia;
+        }
+    }
+
+    typedef std::map<std::pair<int,int>, Manifold> Manifolds;
+
+    Manifolds manifolds;                        ///< persistent manifolds keyed by body and other body.
+    std::vector<Constraint> constraints;        ///< contact points being solved this step, sorted by island.
+    std::vector<int> start;                     ///< index of the first constraint of each island, plus one past the end.
+    std::vector<Constraint> unsorted;           ///< constraints in manifold order while preparing.
+    std::vector<int> islandOf;                  ///< island of each unsorted constraint.
+
+    struct Ground : public Body
+    {
+        Ground()
+        {
+            position = Vector(0,0,0);
+            velocity = Vector(0,0,0);
+            angularVelocity = Vector(0,0,0);
+            inverseMass = 0;
+            inverseInertia = 0;
+            contacts = 0;
+        }
+    };
+
+    Ground ground;                              ///< static body standing in for the world planes.
+};
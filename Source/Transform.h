@@ -0,0 +1,182 @@
+namespace Mathematics
+{
+    /// Rigid body transform.
+    ///
+    /// A rotation followed by a translation, stored as a 3x3 rotation matrix
+    /// and a translation vector. Uses the same conventions as Matrix (post
+    /// multiplication by a column vector, entries named by row and column),
+    /// so a Transform can stand in for a 4x4 Matrix whose bottom row is 0,0,0,1.
+    ///
+    /// Because the rotation part is orthonormal, the inverse is simply
+    /// the transpose of the rotation with the translation rotated back,
+    /// which is far cheaper than a general matrix inverse.
+
+    class Transform
+    {
+    public:
+
+        /// default constructor.
+        /// does nothing for speed.
+
+        Transform() {}
+
+        /// construct transform from an orientation quaternion and a translation.
+        /// the quaternion must be unit length.
+
+        Transform(const Quaternion &orientation, const Vector &translation)
+        {
+            // from david eberly's sources used with permission (see Quaternion::matrix).
+
+            const float fTx  = 2.0f*orientation.x;
+            const float fTy  = 2.0f*orientation.y;
+            const float fTz  = 2.0f*orientation.z;
+            const float fTwx = fTx*orientation.w;
+            const float fTwy = fTy*orientation.w;
+            const float fTwz = fTz*orientation.w;
+            const float fTxx = fTx*orientation.x;
+            const float fTxy = fTy*orientation.x;
+            const float fTxz = fTz*orientation.x;
+            const float fTyy = fTy*orientation.y;
+            const float fTyz = fTz*orientation.y;
+            const float fTzz = fTz*orientation.z;
+
+            m11 = 1.0f-(fTyy+fTzz);
+            m12 = fTxy-fTwz;
+            m13 = fTxz+fTwy;
+            m21 = fTxy+fTwz;
+            m22 = 1.0f-(fTxx+fTzz);
+            m23 = fTyz-fTwx;
+            m31 = fTxz-fTwy;
+            m32 = fTyz+fTwx;
+            m33 = 1.0f-(fTxx+fTyy);
+
+            this->translation = translation;
+        }
+
+        /// set transform to identity.
+
+        void identity()
+        {
+            m11 = 1;
+            m12 = 0;
+            m13 = 0;
+            m21 = 0;
+            m22 = 1;
+            m23 = 0;
+            m31 = 0;
+            m32 = 0;
+            m33 = 1;
+            translation.zero();
+        }
+
+        /// calculate inverse of transform.
+
+        Transform inverse() const
+        {
+            Transform transform;
+            inverse(transform);
+            return transform;
+        }
+
+        /// calculate inverse of transform and write result to parameter transform.
+        /// the inverse rotation is the transpose, the inverse translation is the
+        /// negated translation rotated by the inverse rotation.
+
+        void inverse(Transform &inverse) const
+        {
+            inverse.m11 = m11;
+            inverse.m12 = m21;
+            inverse.m13 = m31;
+            inverse.m21 = m12;
+            inverse.m22 = m22;
+            inverse.m23 = m32;
+            inverse.m31 = m13;
+            inverse.m32 = m23;
+            inverse.m33 = m33;
+
+            inverse.translation.x = -(inverse.m11*translation.x + inverse.m12*translation.y + inverse.m13*translation.z);
+            inverse.translation.y = -(inverse.m21*translation.x + inverse.m22*translation.y + inverse.m23*translation.z);
+            inverse.translation.z = -(inverse.m31*translation.x + inverse.m32*translation.y + inverse.m33*translation.z);
+        }
+
+        /// transform a point by this transform.
+
+        void transform(Vector &vector) const
+        {
+            float x = vector.x * m11 + vector.y * m12 + vector.z * m13 + translation.x;
+            float y = vector.x * m21 + vector.y * m22 + vector.z * m23 + translation.y;
+            float z = vector.x * m31 + vector.y * m32 + vector.z * m33 + translation.z;
+            vector.x = x;
+            vector.y = y;
+            vector.z = z;
+        }
+
+        /// transform a point by this transform, store result in parameter.
+
+        void transform(const Vector &vector, Vector &result) const
+        {
+            result.x = vector.x * m11 + vector.y * m12 + vector.z * m13 + translation.x;
+            result.y = vector.x * m21 + vector.y * m22 + vector.z * m23 + translation.y;
+            result.z = vector.x * m31 + vector.y * m32 + vector.z * m33 + translation.z;
+        }
+
+        /// rotate a direction vector by this transform (no translation).
+
+        void rotate(Vector &vector) const
+        {
+            float x = vector.x * m11 + vector.y * m12 + vector.z * m13;
+            float y = vector.x * m21 + vector.y * m22 + vector.z * m23;
+            float z = vector.x * m31 + vector.y * m32 + vector.z * m33;
+            vector.x = x;
+            vector.y = y;
+            vector.z = z;
+        }
+
+        /// convert to a 4x4 matrix.
+
+        Matrix matrix() const
+        {
+            return Matrix(m11, m12, m13, translation.x,
+                          m21, m22, m23, translation.y,
+                          m31, m32, m33, translation.z,
+                          0, 0, 0, 1);
+        }
+
+        friend inline Vector operator*(const Transform &transform, const Vector &vector);
+        friend inline Transform operator*(const Transform &a, const Transform &b);
+
+        // 3x3 rotation matrix, index m[row][column], convention: pre-multiply column vector, Ax = b
+
+        float m11,m12,m13;
+        float m21,m22,m23;
+        float m31,m32,m33;
+
+        Vector translation;         ///< translation applied after rotation.
+    };
+
+    inline Vector operator*(const Transform &transform, const Vector &vector)
+    {
+        return Vector(vector.x * transform.m11 + vector.y * transform.m12 + vector.z * transform.m13 + transform.translation.x,
+                      vector.x * transform.m21 + vector.y * transform.m22 + vector.z * transform.m23 + transform.translation.y,
+                      vector.x * transform.m31 + vector.y * transform.m32 + vector.z * transform.m33 + transform.translation.z);
+    }
+
+    inline Transform operator*(const Transform &a, const Transform &b)
+    {
+        Transform result;
+
+        result.m11 = a.m11*b.m11 + a.m12*b.m21 + a.m13*b.m31;
+        result.m12 = a.m11*b.m12 + a.m12*b.m22 + a.m13*b.m32;
+        result.m13 = a.m11*b.m13 + a.m12*b.m23 + a.m13*b.m33;
+        result.m21 = a.m21*b.m11 + a.m22*b.m21 + a.m23*b.m31;
+        result.m22 = a.m21*b.m12 + a.m22*b.m22 + a.m23*b.m32;
+        result.m23 = a.m21*b.m13 + a.m22*b.m23 + a.m23*b.m33;
+        result.m31 = a.m31*b.m11 + a.m32*b.m21 + a.m33*b.m31;
+        result.m32 = a.m31*b.m12 + a.m32*b.m22 + a.m33*b.m32;
+        result.m33 = a.m31*b.m13 + a.m32*b.m23 + a.m33*b.m33;
+
+        result.translation = a * b.translation;
+
+        return result;
+    }
+}
@@ -0,0 +1,456 @@
+/// Worker threads.
+///
+/// A fixed pool of threads for running independent jobs in parallel. run
+/// hands out job indices one at a time to the worker threads and to the
+/// calling thread, and returns once every job is finished, so the caller
+/// sees all of the results. With no worker threads started the jobs run on
+/// the calling thread in order, which is the default.
+///
+/// Background is a single thread for one long job at a time that the calling
+/// thread does not wait for: it starts the job, carries on with its own work
+/// and polls for the job to finish.
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/// Counting semaphore.
+
+class Semaphore
+{
+public:
+
+    Semaphore()
+    {
+        #ifdef _WIN32
+        handle = CreateSemaphore(0, 0, 0x7FFFFFFF, 0);
+        #else
+        value = 0;
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&condition, 0);
+        #endif
+    }
+
+    ~Semaphore()
+    {
+        #ifdef _WIN32
+        CloseHandle(handle);
+        #else
+        pthread_cond_destroy(&condition);
+        pthread_mutex_destroy(&mutex);
+        #endif
+    }
+
+    /// Increase the count, releasing up to n waiting threads.
+
+    void signal(int n)
+    {
+        #ifdef _WIN32
+        ReleaseSemaphore(handle, n, 0);
+        #else
+        pthread_mutex_lock(&mutex);
+        value += n;
+        pthread_cond_broadcast(&condition);
+        pthread_mutex_unlock(&mutex);
+        #endif
+    }
+
+    /// Wait until the count is positive then decrease it.
+
+    void wait()
+    {
+        #ifdef _WIN32
+        WaitForSingleObject(handle, INFINITE);
+        #else
+        pthread_mutex_lock(&mutex);
+        while (value==0)
+            pthread_cond_wait(&condition, &mutex);
+        value--;
+        pthread_mutex_unlock(&mutex);
+        #endif
+    }
+
+private:
+
+    #ifdef _WIN32
+    HANDLE handle;
+    #else
+    int value;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    #endif
+};
+
+class Workers
+{
+public:
+
+    /// A job function. Called once for each job index.
+
+    typedef void (*Function)(void *data, int job);
+
+    Workers()
+    {
+        count = 0;
+        quit = false;
+        function = 0;
+        data = 0;
+        jobs = 0;
+        next = 0;
+    }
+
+    ~Workers()
+    {
+        stop();
+    }
+
+    /// Start a number of worker threads, stopping any already running.
+    /// The calling thread also runs jobs, so for n cores start n-1 threads.
+
+    void start(int threads)
+    {
+        stop();
+
+        quit = false;
+
+        for (int i=0; i<threads; i++)
+        {
+            #ifdef _WIN32
+            HANDLE thread = CreateThread(0, 0, entry, this, 0, 0);
+            #else
+            pthread_t thread;
+            pthread_create(&thread, 0, entry, this);
+            #endif
+            handles.push_back(thread);
+        }
+
+        count = threads;
+    }
+
+    /// Stop all worker threads.
+
+    void stop()
+    {
+        if (!count)
+            return;
+
+        quit = true;
+        begin.signal(count);
+
+        for (int i=0; i<count; i++)
+        {
+            #ifdef _WIN32
+            WaitForSingleObject(handles[i], INFINITE);
+            CloseHandle(handles[i]);
+            #else
+            pthread_join(handles[i], 0);
+            #endif
+        }
+
+        handles.clear();
+        count = 0;
+    }
+
+    /// Number of worker threads running.
+
+    int threads() const
+    {
+        return count;
+    }
+
+    /// Run jobs 0 to jobs-1 and wait for them all to finish.
+    /// Jobs may run in any order and on any thread, so they must not depend on each other.
+
+    void run(Function function, void *data, int jobs)
+    {
+        if (count==0 || jobs<=1)
+        {
+            for (int i=0; i<jobs; i++)
+                function(data, i);
+            return;
+        }
+
+        this->function = function;
+        this->data = data;
+        this->jobs = jobs;
+        next = 0;
+
+        begin.signal(count);
+
+        work();
+
+        for (int i=0; i<count; i++)
+            end.wait();
+    }
+
+    /// Number of processors available.
+
+    static int processors()
+    {
+        #ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int) info.dwNumberOfProcessors;
+        #else
+        const long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n>0 ? (int) n : 1;
+        #endif
+    }
+
+private:
+
+    Workers(const Workers &other);
+    Workers& operator=(const Workers &other);
+
+    /// Take the next job index.
+
+    int take()
+    {
+        #ifdef _WIN32
+        return (int) InterlockedIncrement(&next) - 1;
+        #else
+        return (int) __sync_fetch_and_add(&next, 1);
+        #endif
+    }
+
+    /// Run jobs until there are none left.
+
+    void work()
+    {
+        while (true)
+        {
+            const int job = take();
+            if (job>=jobs)
+                break;
+            function(data, job);
+        }
+    }
+
+    /// Worker thread loop: wait for a batch of jobs, work on it, report back.
+
+    #ifdef _WIN32
+    static DWORD WINAPI entry(LPVOID parameter)
+    #else
+    static void* entry(void *parameter)
+    #endif
+    {
+        Workers &workers = *(Workers*) parameter;
+
+        while (true)
+        {
+            workers.begin.wait();
+
+            if (workers.quit)
+                break;
+
+            workers.work();
+            workers.end.signal(1);
+        }
+
+        return 0;
+    }
+
+    #ifdef _WIN32
+    std::vector<HANDLE> handles;        ///< worker thread handles.
+    #else
+    std::vector<pthread_t> handles;     ///< worker thread handles.
+    #endif
+
+    int count;                          ///< number of worker threads.
+    volatile bool quit;                 ///< set to tell the worker threads to exit.
+
+    Semaphore begin;                    ///< signalled once for each worker thread when a batch of jobs starts.
+    Semaphore end;                      ///< signalled by each worker thread when it runs out of jobs.
+
+    Function function;                  ///< job function for the current batch.
+    void *data;                         ///< job data for the current batch.
+    int jobs;                           ///< number of jobs in the current batch.
+    volatile long next;                 ///< next job index to hand out.
+};
+
+/// Background thread.
+///
+/// Runs one job at a time on its own thread while the calling thread carries on.
+/// begin hands the job over and returns straight away, then the calling thread
+/// polls finished, which never blocks. The job state is only changed with
+/// interlocked compare and exchange, which is a full memory barrier, so once
+/// finished returns true every write the job made is visible. The job data
+/// belongs to the thread from begin until finished returns true and must not be
+/// touched by anything else meanwhile. With the thread not started begin runs
+/// the job on the calling thread.
+
+class Background
+{
+public:
+
+    Background()
+    {
+        started = false;
+        quit = false;
+        state = Idle;
+        function = 0;
+        data = 0;
+    }
+
+    ~Background()
+    {
+        stop();
+    }
+
+    /// Start the thread if it is not running already.
+
+    void start()
+    {
+        if (started)
+            return;
+
+        quit = false;
+
+        #ifdef _WIN32
+        handle = CreateThread(0, 0, entry, this, 0, 0);
+        #else
+        pthread_create(&handle, 0, entry, this);
+        #endif
+
+        started = true;
+    }
+
+    /// Stop the thread, waiting for the job in progress to finish first.
+    /// A job finished but not yet collected with finished stays finished.
+
+    void stop()
+    {
+        if (!started)
+            return;
+
+        quit = true;
+        wake.signal(1);
+
+        #ifdef _WIN32
+        WaitForSingleObject(handle, INFINITE);
+        CloseHandle(handle);
+        #else
+        pthread_join(handle, 0);
+        #endif
+
+        started = false;
+    }
+
+    /// Returns true if the thread is running.
+
+    bool running() const
+    {
+        return started;
+    }
+
+    /// Returns true from begin until finished has returned true for the job.
+
+    bool busy() const
+    {
+        return !exchange(Idle, Idle);
+    }
+
+    /// Start a job, job is always passed zero.
+    /// @returns false if the previous job has not been collected with finished yet.
+
+    bool begin(Workers::Function function, void *data)
+    {
+        if (busy())
+            return false;
+
+        this->function = function;
+        this->data = data;
+
+        state = Running;
+
+        if (!started)
+        {
+            function(data, 0);
+            exchange(Running, Done);
+            return true;
+        }
+
+        wake.signal(1);
+
+        return true;
+    }
+
+    /// Check if the job has finished, without waiting for it.
+    /// @returns true once for each job, when its results can be read.
+
+    bool finished()
+    {
+        return exchange(Done, Idle);
+    }
+
+private:
+
+    Background(const Background &other);
+    Background& operator=(const Background &other);
+
+    enum State
+    {
+        Idle,                           ///< no job, or the last job has been collected.
+        Running,                        ///< the thread owns the job.
+        Done                            ///< the job has finished and waits to be collected.
+    };
+
+    /// Change the job state from one value to another if it has the first value.
+    /// Exchanging a value for itself reads the state.
+    /// @returns true if the state had the first value.
+
+    bool exchange(State from, State to) const
+    {
+        #ifdef _WIN32
+        return InterlockedCompareExchange(&state, to, from)==from;
+        #else
+        return __sync_bool_compare_and_swap(&state, (long) from, (long) to);
+        #endif
+    }
+
+    /// Thread loop: wait for a job, run it and publish that it is done.
+
+    #ifdef _WIN32
+    static DWORD WINAPI entry(LPVOID parameter)
+    #else
+    static void* entry(void *parameter)
+    #endif
+    {
+        Background &background = *(Background*) parameter;
+
+        while (true)
+        {
+            background.wake.wait();
+
+            // each wake is either for a job or, once the jobs are done, to exit
+
+            if (background.exchange(Running, Running))
+            {
+                background.function(background.data, 0);
+                background.exchange(Running, Done);
+                continue;
+            }
+
+            if (background.quit)
+                break;
+        }
+
+        return 0;
+    }
+
+    #ifdef _WIN32
+    HANDLE handle;                      ///< thread handle.
+    #else
+    pthread_t handle;                   ///< thread handle.
+    #endif
+
+    bool started;                       ///< true if the thread is running.
+    volatile bool quit;                 ///< set to tell the thread to exit.
+    mutable volatile long state;        ///< job state, the thread only changes it from Running to Done.
+
+    Semaphore wake;                     ///< signalled when a job starts and when the thread should exit.
+
+    Workers::Function function;         ///< function of the current job.
+    void *data;                         ///< data of the current job.
+};
@@ -0,0 +1,851 @@
+/// Static collision world.
+///
+/// Level geometry made of triangle meshes and convex boxes, stored in a bounding
+/// volume hierarchy so that a cube only looks at the surfaces near it instead of
+/// scanning every surface in the level. Scene queries the world around each cube
+/// once per step and adds the planes of the surfaces it is touching to the planes
+/// that cube collides against, so the world works unchanged with both the penalty
+/// forces and the contact solver.
+///
+/// The hierarchy is flattened into an array of nodes in depth first order. Each
+/// node stores its bounds and the index of the first node after its subtree, so a
+/// query walks the array from front to back without a stack: if the query misses
+/// a node it jumps past the subtree, otherwise it steps to the next node, which is
+/// the first child. Nodes are 32 bytes so two fit in a cache line, and triangles
+/// and boxes are stored in the order the leaves reach them.
+///
+/// These arrays are also the file format: a header followed by the nodes, the
+/// triangles and the boxes. save writes them out as they are, and load memory maps
+/// the file and uses the arrays in place, so loading a level costs nothing no
+/// matter how many surfaces it has. Files are in native byte order.
+
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+class World
+{
+public:
+
+    World()
+    {
+        mapping = 0;
+        mappingSize = 0;
+        #ifdef _WIN32
+        file = INVALID_HANDLE_VALUE;
+        map = 0;
+        #endif
+        clear();
+    }
+
+    ~World()
+    {
+        unmap();
+    }
+
+    /// Remove all surfaces.
+
+    void clear()
+    {
+        unmap();
+
+        nodeArray.clear();
+        triangleArray.clear();
+        boxArray.clear();
+
+        nodes = 0;
+        triangles = 0;
+        boxes = 0;
+        nodeCount = 0;
+        triangleCount = 0;
+        boxCount = 0;
+    }
+
+    /// Add a triangle. The front of the triangle is the side its vertices appear counterclockwise from.
+    /// Cubes only collide with the front of a triangle. Call build once all surfaces are added.
+
+    void addTriangle(const Vector &a, const Vector &b, const Vector &c)
+    {
+        Vector normal = (b - a).cross(c - a);
+        const float length = normal.length();
+        if (length<epsilon)
+            return;
+        normal /= length;
+
+        Triangle triangle;
+        store(normal, triangle.normal);
+        triangle.constant = normal.dot(a);
+        store(a, triangle.a);
+        store(b, triangle.b);
+        store(c, triangle.c);
+        triangleArray.push_back(triangle);
+    }
+
+    /// Add an indexed triangle mesh.
+    /// @param vertices the mesh vertices.
+    /// @param indices three vertex indices for each triangle.
+    /// @param count the number of triangles.
+
+    void addMesh(const Vector vertices[], const int indices[], int count)
+    {
+        for (int i=0; i<count; i++)
+            addTriangle(vertices[indices[i*3]], vertices[indices[i*3+1]], vertices[indices[i*3+2]]);
+    }
+
+    /// Add a solid box.
+    /// @param center the center of the box.
+    /// @param extents half the size of the box along each of its axes.
+    /// @param orientation the orientation of the box.
+
+    void addBox(const Vector &center, const Vector &extents, const Quaternion &orientation = Quaternion(1,0,0,0))
+    {
+        const Matrix rotation = orientation.matrix();
+
+        Box box;
+        store(center, box.center);
+        for (int i=0; i<3; i++)
+        {
+            Vector axis;
+            rotation.transform3x3(Vector(i==0 ? 1.0f : 0.0f, i==1 ? 1.0f : 0.0f, i==2 ? 1.0f : 0.0f), axis);
+            store(axis, box.axis[i]);
+        }
+        store(extents, box.extents);
+        box.pad = 0;
+        boxArray.push_back(box);
+    }
+
+    /// Build the hierarchy over the surfaces added since the last build.
+    /// Surfaces of a loaded world are kept, so a loaded level can be extended.
+
+    void build()
+    {
+        if (mapping)
+        {
+            triangleArray.insert(triangleArray.begin(), triangles, triangles + triangleCount);
+            boxArray.insert(boxArray.begin(), boxes, boxes + boxCount);
+            unmap();
+        }
+
+        const int count = (int) (triangleArray.size() + boxArray.size());
+
+        std::vector<Bounds> bounds(count);
+        std::vector<int> order(count);
+
+        for (int i=0; i<count; i++)
+        {
+            bounds[i] = i<(int)triangleArray.size() ? triangleBounds(triangleArray[i]) : boxBounds(boxArray[i-triangleArray.size()]);
+            order[i] = i;
+        }
+
+        nodeArray.clear();
+        nodeArray.reserve(count ? count*2-1 : 0);
+
+        if (count)
+            subdivide(bounds, order, 0, count);
+
+        // store surfaces in the order the leaves reach them
+
+        std::vector<Triangle> sortedTriangles;
+        std::vector<Box> sortedBoxes;
+        sortedTriangles.reserve(triangleArray.size());
+        sortedBoxes.reserve(boxArray.size());
+
+        for (unsigned int i=0; i<nodeArray.size(); i++)
+        {
+            Node &node = nodeArray[i];
+
+            if (node.surface<0)
+                continue;
+
+            if (node.surface<(int)triangleArray.size())
+            {
+                sortedTriangles.push_back(triangleArray[node.surface]);
+                node.surface = (int) sortedTriangles.size() - 1;
+            }
+            else
+            {
+                sortedBoxes.push_back(boxArray[node.surface-triangleArray.size()]);
+                node.surface = -2 - ((int) sortedBoxes.size() - 1);
+            }
+        }
+
+        // triangles come first, then boxes
+
+        for (unsigned int i=0; i<nodeArray.size(); i++)
+        {
+            if (nodeArray[i].surface<-1)
+                nodeArray[i].surface = (int) sortedTriangles.size() + (-2 - nodeArray[i].surface);
+        }
+
+        triangleArray.swap(sortedTriangles);
+        boxArray.swap(sortedBoxes);
+
+        point();
+    }
+
+    /// Returns true if the world has no surfaces.
+
+    bool empty() const
+    {
+        return nodeCount==0;
+    }
+
+    /// Number of surfaces in the world.
+
+    int surfaces() const
+    {
+        return triangleCount + boxCount;
+    }
+
+    /// Number of nodes in the hierarchy.
+
+    int size() const
+    {
+        return nodeCount;
+    }
+
+    /// Find the surfaces within a radius of a point.
+    /// For each surface found, a plane through the surface facing the point is appended.
+    /// Coplanar surfaces, such as the triangles of a flat floor, only add a plane once.
+    /// @param center the point to query around, normally the center of a cube.
+    /// @param radius the distance to query within, normally the bounding radius of the cube plus a margin.
+    /// @param planes the planes of the surfaces found are appended to this array.
+    /// @param ids the index of the surface of each plane is appended to this array.
+
+    void query(const Vector &center, float radius, std::vector<Plane> &planes, std::vector<int> &ids) const
+    {
+        const float min[3] = { center.x - radius, center.y - radius, center.z - radius };
+        const float max[3] = { center.x + radius, center.y + radius, center.z + radius };
+
+        const unsigned int first = planes.size();
+
+        int i = 0;
+        while (i<nodeCount)
+        {
+            const Node &node = nodes[i];
+
+            if (node.min[0]>max[0] || node.max[0]<min[0] ||
+                node.min[1]>max[1] || node.max[1]<min[1] ||
+                node.min[2]>max[2] || node.max[2]<min[2])
+            {
+                i = node.escape;
+                continue;
+            }
+
+            if (node.surface>=0)
+            {
+                Plane plane;
+
+                const bool touching = node.surface<triangleCount ?
+                                      touchTriangle(triangles[node.surface], center, radius, plane) :
+                                      touchBox(boxes[node.surface-triangleCount], center, radius, plane);
+
+                if (touching && !contains(planes, first, plane))
+                {
+                    planes.push_back(plane);
+                    ids.push_back(node.surface);
+                }
+            }
+
+            i++;
+        }
+    }
+
+    /// Sweep points along a line and find the first surface any of them moves into.
+    /// A point moving from the front of a triangle to behind it, or from outside a box to inside it, hits that surface.
+    /// Points already behind a triangle or inside a box are in contact already and ignored.
+    /// @param points the points to sweep, normally the corners of a cube.
+    /// @param count the number of points.
+    /// @param displacement how far the points move.
+    /// @param fraction on entry only hits before this fraction of the displacement are found, set to the fraction of the first hit.
+    /// @param normal set to the unit normal of the surface hit first.
+    /// @returns true if a hit was found.
+
+    bool sweep(const Vector points[], int count, const Vector &displacement, float &fraction, Vector &normal) const
+    {
+        float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        for (int i=0; i<count; i++)
+        {
+            const Vector start = points[i];
+            const Vector end = points[i] + displacement;
+
+            min[0] = Mathematics::minimum(min[0], Mathematics::minimum(start.x, end.x));
+            min[1] = Mathematics::minimum(min[1], Mathematics::minimum(start.y, end.y));
+            min[2] = Mathematics::minimum(min[2], Mathematics::minimum(start.z, end.z));
+            max[0] = Mathematics::maximum(max[0], Mathematics::maximum(start.x, end.x));
+            max[1] = Mathematics::maximum(max[1], Mathematics::maximum(start.y, end.y));
+            max[2] = Mathematics::maximum(max[2], Mathematics::maximum(start.z, end.z));
+        }
+
+        bool hit = false;
+
+        int i = 0;
+        while (i<nodeCount)
+        {
+            const Node &node = nodes[i];
+
+            if (node.min[0]>max[0] || node.max[0]<min[0] ||
+                node.min[1]>max[1] || node.max[1]<min[1] ||
+                node.min[2]>max[2] || node.max[2]<min[2])
+            {
+                i = node.escape;
+                continue;
+            }
+
+            if (node.surface>=0)
+            {
+                for (int j=0; j<count; j++)
+                {
+                    const bool found = node.surface<triangleCount ?
+                                       sweepTriangle(triangles[node.surface], points[j], displacement, fraction, normal) :
+                                       sweepBox(boxes[node.surface-triangleCount], points[j], displacement, fraction, normal);
+                    hit = hit || found;
+                }
+            }
+
+            i++;
+        }
+
+        return hit;
+    }
+
+    /// Save the world to a file in the format load maps.
+    /// @returns true if the file was written.
+
+    bool save(const char filename[]) const
+    {
+        FILE *file = fopen(filename, "wb");
+        if (!file)
+            return false;
+
+        Header header;
+        memcpy(header.magic, "NPWL", 4);
+        header.version = version;
+        header.nodes = nodeCount;
+        header.triangles = triangleCount;
+        header.boxes = boxCount;
+        header.pad[0] = header.pad[1] = header.pad[2] = 0;
+
+        bool ok = fwrite(&header, sizeof(Header), 1, file)==1;
+        ok = ok && (!nodeCount || fwrite(nodes, sizeof(Node), nodeCount, file)==(size_t)nodeCount);
+        ok = ok && (!triangleCount || fwrite(triangles, sizeof(Triangle), triangleCount, file)==(size_t)triangleCount);
+        ok = ok && (!boxCount || fwrite(boxes, sizeof(Box), boxCount, file)==(size_t)boxCount);
+
+        return fclose(file)==0 && ok;
+    }
+
+    /// Load a world saved with save by memory mapping the file.
+    /// The file stays mapped until the world is cleared, built or loaded again.
+    /// @returns true if the world was loaded, otherwise the world is left empty.
+
+    bool load(const char filename[])
+    {
+        clear();
+
+        #ifdef _WIN32
+
+        file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (file==INVALID_HANDLE_VALUE)
+            return false;
+
+        mappingSize = GetFileSize(file, 0);
+        map = mappingSize ? CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0) : 0;
+        mapping = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : 0;
+
+        #else
+
+        const int file = open(filename, O_RDONLY);
+        if (file<0)
+            return false;
+
+        struct stat status;
+        if (fstat(file, &status)==0 && status.st_size>0)
+        {
+            mappingSize = (size_t) status.st_size;
+            mapping = mmap(0, mappingSize, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping==MAP_FAILED)
+                mapping = 0;
+        }
+
+        close(file);
+
+        #endif
+
+        if (!mapping || mappingSize<sizeof(Header))
+        {
+            unmap();
+            return false;
+        }
+
+        const Header &header = *(const Header*) mapping;
+
+        if (memcmp(header.magic, "NPWL", 4)!=0 || header.version!=version || header.nodes<0 || header.triangles<0 || header.boxes<0 ||
+            mappingSize != sizeof(Header) + header.nodes * sizeof(Node) + header.triangles * sizeof(Triangle) + header.boxes * sizeof(Box))
+        {
+            unmap();
+            return false;
+        }
+
+        const char *data = (const char*) mapping + sizeof(Header);
+
+        nodes = (const Node*) data;
+        triangles = (const Triangle*) (data + header.nodes * sizeof(Node));
+        boxes = (const Box*) (data + header.nodes * sizeof(Node) + header.triangles * sizeof(Triangle));
+        nodeCount = header.nodes;
+        triangleCount = header.triangles;
+        boxCount = header.boxes;
+
+        return true;
+    }
+
+    /// Query the surfaces of another world in place instead of copying them,
+    /// so that a scene replaying on another thread collides with the same level.
+    /// Queries only read the world, so both worlds can be queried at once from
+    /// different threads. The other world must not be changed or destroyed while
+    /// it is shared, and this world stops sharing it when cleared, built or loaded.
+
+    void share(const World &other)
+    {
+        clear();
+
+        nodes = other.nodes;
+        triangles = other.triangles;
+        boxes = other.boxes;
+        nodeCount = other.nodeCount;
+        triangleCount = other.triangleCount;
+        boxCount = other.boxCount;
+    }
+
+private:
+
+    World(const World &other);
+    World& operator=(const World &other);
+
+    static const int version = 1;
+
+    /// File header.
+
+    struct Header
+    {
+        char magic[4];                  ///< "NPWL".
+        int version;                    ///< file format version.
+        int nodes;                      ///< number of nodes.
+        int triangles;                  ///< number of triangles.
+        int boxes;                      ///< number of boxes.
+        int pad[3];                     ///< padding to 32 bytes.
+    };
+
+    /// Hierarchy node.
+    /// Leaves hold a single surface: triangles are numbered first, then boxes.
+
+    struct Node
+    {
+        float min[3];                   ///< minimum corner of the bounds.
+        int escape;                     ///< index of the first node after this subtree.
+        float max[3];                   ///< maximum corner of the bounds.
+        int surface;                    ///< surface index for a leaf, -1 for an interior node.
+    };
+
+    /// Triangle with its plane.
+
+    struct Triangle
+    {
+        float normal[3];                ///< unit normal of the front face.
+        float constant;                 ///< plane constant.
+        float a[3];                     ///< first vertex.
+        float b[3];                     ///< second vertex.
+        float c[3];                     ///< third vertex.
+    };
+
+    /// Oriented box.
+
+    struct Box
+    {
+        float center[3];                ///< center of the box.
+        float axis[3][3];               ///< unit axes of the box.
+        float extents[3];               ///< half size of the box along each axis.
+        float pad;                      ///< padding to 64 bytes.
+    };
+
+    /// Bounds of a surface while building.
+
+    struct Bounds
+    {
+        float min[3];
+        float max[3];
+        float center[3];
+    };
+
+    /// Orders surfaces by the center of their bounds along an axis, then by index
+    /// so the hierarchy does not depend on how the standard library breaks ties.
+
+    struct CompareCenters
+    {
+        CompareCenters(const std::vector<Bounds> &bounds, int axis) : bounds(bounds), axis(axis) {}
+
+        bool operator()(int a, int b) const
+        {
+            const float ca = bounds[a].center[axis];
+            const float cb = bounds[b].center[axis];
+            return ca<cb || (ca==cb && a<b);
+        }
+
+        const std::vector<Bounds> &bounds;
+        int axis;
+    };
+
+    /// Add the subtree for surfaces order[first] to order[last-1], splitting at the median along the longest axis.
+
+    void subdivide(const std::vector<Bounds> &bounds, std::vector<int> &order, int first, int last)
+    {
+        const int index = (int) nodeArray.size();
+        nodeArray.push_back(Node());
+
+        Bounds total = bounds[order[first]];
+        float centerMin[3] = { total.center[0], total.center[1], total.center[2] };
+        float centerMax[3] = { total.center[0], total.center[1], total.center[2] };
+
+        for (int i=first+1; i<last; i++)
+        {
+            const Bounds &b = bounds[order[i]];
+            for (int k=0; k<3; k++)
+            {
+                total.min[k] = Mathematics::minimum(total.min[k], b.min[k]);
+                total.max[k] = Mathematics::maximum(total.max[k], b.max[k]);
+                centerMin[k] = Mathematics::minimum(centerMin[k], b.center[k]);
+                centerMax[k] = Mathematics::maximum(centerMax[k], b.center[k]);
+            }
+        }
+
+        if (last-first==1)
+            nodeArray[index].surface = order[first];
+        else
+        {
+            const float spread[3] = { centerMax[0] - centerMin[0], centerMax[1] - centerMin[1], centerMax[2] - centerMin[2] };
+            const int axis = spread[0]>=spread[1] && spread[0]>=spread[2] ? 0 : spread[1]>=spread[2] ? 1 : 2;
+
+            const int middle = (first + last) / 2;
+            std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + last, CompareCenters(bounds, axis));
+
+            subdivide(bounds, order, first, middle);
+            subdivide(bounds, order, middle, last);
+
+            nodeArray[index].surface = -1;
+        }
+
+        Node &node = nodeArray[index];
+        for (int k=0; k<3; k++)
+        {
+            node.min[k] = total.min[k];
+            node.max[k] = total.max[k];
+        }
+        node.escape = (int) nodeArray.size();
+    }
+
+    static Bounds triangleBounds(const Triangle &triangle)
+    {
+        Bounds bounds;
+        for (int k=0; k<3; k++)
+        {
+            bounds.min[k] = Mathematics::minimum(triangle.a[k], Mathematics::minimum(triangle.b[k], triangle.c[k]));
+            bounds.max[k] = Mathematics::maximum(triangle.a[k], Mathematics::maximum(triangle.b[k], triangle.c[k]));
+            bounds.center[k] = (triangle.a[k] + triangle.b[k] + triangle.c[k]) / 3.0f;
+        }
+        return bounds;
+    }
+
+    static Bounds boxBounds(const Box &box)
+    {
+        Bounds bounds;
+        for (int k=0; k<3; k++)
+        {
+            const float radius = Mathematics::abs(box.axis[0][k]) * box.extents[0] + Mathematics::abs(box.axis[1][k]) * box.extents[1] + Mathematics::abs(box.axis[2][k]) * box.extents[2];
+            bounds.min[k] = box.center[k] - radius;
+            bounds.max[k] = box.center[k] + radius;
+            bounds.center[k] = box.center[k];
+        }
+        return bounds;
+    }
+
+    /// Test if a point is within a radius of the front of a triangle.
+    /// @param plane set to the plane of the triangle if it is.
+
+    static bool touchTriangle(const Triangle &triangle, const Vector &point, float radius, Plane &plane)
+    {
+        const Vector normal = load(triangle.normal);
+
+        const float distance = point.dot(normal) - triangle.constant;
+        if (distance<0 || distance>radius)
+            return false;
+
+        const Vector closest = closestPointOnTriangle(point, load(triangle.a), load(triangle.b), load(triangle.c));
+        if ((point - closest).lengthSquared()>radius*radius)
+            return false;
+
+        plane = Plane(normal, triangle.constant);
+        return true;
+    }
+
+    /// Test if a point is within a radius of a box.
+    /// @param plane set to the plane of the box face the point is furthest in front of if it is.
+
+    static bool touchBox(const Box &box, const Vector &point, float radius, Plane &plane)
+    {
+        const Vector offset = point - load(box.center);
+
+        float local[3];
+        float distanceSquared = 0;
+
+        int face = 0;
+        float faceDistance = -FLT_MAX;
+
+        for (int k=0; k<3; k++)
+        {
+            local[k] = offset.dot(load(box.axis[k]));
+
+            const float outside = Mathematics::abs(local[k]) - box.extents[k];
+            if (outside>0)
+                distanceSquared += outside * outside;
+
+            if (outside>faceDistance)
+            {
+                faceDistance = outside;
+                face = k;
+            }
+        }
+
+        if (distanceSquared>radius*radius)
+            return false;
+
+        const Vector normal = load(box.axis[face]) * (local[face]<0 ? -1.0f : 1.0f);
+        plane = Plane(normal, normal.dot(load(box.center)) + box.extents[face]);
+        return true;
+    }
+
+    /// Test if a point moving along a line crosses into the front of a triangle before a fraction of the line.
+    /// @param fraction set to the fraction of the line at the crossing if it does.
+    /// @param normal set to the normal of the triangle if it does.
+
+    static bool sweepTriangle(const Triangle &triangle, const Vector &start, const Vector &displacement, float &fraction, Vector &normal)
+    {
+        const Vector n = load(triangle.normal);
+
+        const float before = start.dot(n) - triangle.constant;
+        const float after = before + displacement.dot(n);
+        if (before<0 || after>=0)
+            return false;
+
+        const float t = before / (before - after);
+        if (t>=fraction)
+            return false;
+
+        const Vector point = start + displacement * t;
+        const Vector a = load(triangle.a);
+        const Vector b = load(triangle.b);
+        const Vector c = load(triangle.c);
+
+        if ((b - a).cross(point - a).dot(n)<0 || (c - b).cross(point - b).dot(n)<0 || (a - c).cross(point - c).dot(n)<0)
+            return false;
+
+        fraction = t;
+        normal = n;
+        return true;
+    }
+
+    /// Test if a point moving along a line enters a box before a fraction of the line.
+    /// Clips the line against the slab between each pair of opposite faces.
+    /// @param fraction set to the fraction of the line where it enters the box if it does.
+    /// @param normal set to the normal of the face it enters through if it does.
+
+    static bool sweepBox(const Box &box, const Vector &start, const Vector &displacement, float &fraction, Vector &normal)
+    {
+        const Vector offset = start - load(box.center);
+
+        float enter = 0;
+        float exit = fraction;
+        int face = -1;
+        float direction = 0;
+
+        for (int k=0; k<3; k++)
+        {
+            const Vector axis = load(box.axis[k]);
+            const float position = offset.dot(axis);
+            const float speed = displacement.dot(axis);
+
+            if (Mathematics::abs(speed)<epsilon)
+            {
+                if (Mathematics::abs(position)>box.extents[k])
+                    return false;
+                continue;
+            }
+
+            float closer = (-box.extents[k] - position) / speed;
+            float further = (box.extents[k] - position) / speed;
+            if (closer>further)
+            {
+                const float swap = closer;
+                closer = further;
+                further = swap;
+            }
+
+            if (closer>enter)
+            {
+                enter = closer;
+                face = k;
+                direction = speed;
+            }
+
+            exit = Mathematics::minimum(exit, further);
+            if (enter>exit)
+                return false;
+        }
+
+        // a point that starts inside the box never enters a slab
+
+        if (face<0 || enter>=fraction)
+            return false;
+
+        fraction = enter;
+        normal = load(box.axis[face]) * (direction>0 ? -1.0f : 1.0f);
+        return true;
+    }
+
+    /// Closest point on a triangle to a point.
+    /// See "Real-Time Collision Detection" by Christer Ericson, section 5.1.5.
+
+    static Vector closestPointOnTriangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
+    {
+        const Vector ab = b - a;
+        const Vector ac = c - a;
+
+        const Vector ap = p - a;
+        const float d1 = ab.dot(ap);
+        const float d2 = ac.dot(ap);
+        if (d1<=0 && d2<=0)
+            return a;
+
+        const Vector bp = p - b;
+        const float d3 = ab.dot(bp);
+        const float d4 = ac.dot(bp);
+        if (d3>=0 && d4<=d3)
+            return b;
+
+        const float vc = d1*d4 - d3*d2;
+        if (vc<=0 && d1>=0 && d3<=0)
+            return a + ab * (d1 / (d1 - d3));
+
+        const Vector cp = p - c;
+        const float d5 = ab.dot(cp);
+        const float d6 = ac.dot(cp);
+        if (d6>=0 && d5<=d6)
+            return c;
+
+        const float vb = d5*d2 - d1*d6;
+        if (vb<=0 && d2>=0 && d6<=0)
+            return a + ac * (d2 / (d2 - d6));
+
+        const float va = d3*d6 - d5*d4;
+        if (va<=0 && (d4-d3)>=0 && (d5-d6)>=0)
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        const float denominator = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    /// Returns true if the planes from index first on already include a plane.
+
+    static bool contains(const std::vector<Plane> &planes, unsigned int first, const Plane &plane)
+    {
+        const float tolerance = 0.001f;
+
+        for (unsigned int i=first; i<planes.size(); i++)
+        {
+            if (Mathematics::abs(planes[i].constant - plane.constant)<tolerance && (planes[i].normal - plane.normal).lengthSquared()<tolerance*tolerance)
+                return true;
+        }
+
+        return false;
+    }
+
+    static void store(const Vector &vector, float output[3])
+    {
+        output[0] = vector.x;
+        output[1] = vector.y;
+        output[2] = vector.z;
+    }
+
+    static Vector load(const float input[3])
+    {
+        return Vector(input[0], input[1], input[2]);
+    }
+
+    /// Point the arrays used by queries at the built arrays.
+
+    void point()
+    {
+        nodes = nodeArray.empty() ? 0 : &nodeArray[0];
+        triangles = triangleArray.empty() ? 0 : &triangleArray[0];
+        boxes = boxArray.empty() ? 0 : &boxArray[0];
+        nodeCount = (int) nodeArray.size();
+        triangleCount = (int) triangleArray.size();
+        boxCount = (int) boxArray.size();
+    }
+
+    /// Release the file mapping if there is one.
+
+    void unmap()
+    {
+        #ifdef _WIN32
+        if (mapping)
+            UnmapViewOfFile(mapping);
+        if (map)
+            CloseHandle(map);
+        if (file!=INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        map = 0;
+        file = INVALID_HANDLE_VALUE;
+        #else
+        if (mapping)
+            munmap(mapping, mappingSize);
+        #endif
+
+        if (mapping)
+        {
+            nodes = 0;
+            triangles = 0;
+            boxes = 0;
+            nodeCount = 0;
+            triangleCount = 0;
+            boxCount = 0;
+        }
+
+        mapping = 0;
+        mappingSize = 0;
+    }
+
+    std::vector<Node> nodeArray;            ///< nodes of a built world.
+    std::vector<Triangle> triangleArray;    ///< triangles of a built world, or triangles added since the last build.
+    std::vector<Box> boxArray;              ///< boxes of a built world, or boxes added since the last build.
+
+    const Node *nodes;                      ///< nodes being queried, either built or mapped from a file.
+    const Triangle *triangles;              ///< triangles being queried.
+    const Box *boxes;                       ///< boxes being queried.
+    int nodeCount;                          ///< number of nodes being queried.
+    int triangleCount;                      ///< number of triangles being queried.
+    int boxCount;                           ///< number of boxes being queried.
+
+    void *mapping;                          ///< mapped file data, or null.
+    size_t mappingSize;                     ///< size of the mapped file data in bytes.
+
+    #ifdef _WIN32
+    HANDLE file;                            ///< mapped file handle.
+    HANDLE map;                             ///< file mapping handle.
+    #endif
+};